@@ -1,4 +1,5 @@
 #include <arch/cpu.h>
+#include <arch/uaccess.h>
 #include <arch/paging.h>
 #include <arch/ucontext.h>
 #include <fs/inode.h>
@@ -18,48 +19,89 @@
           fault->err_code, type, fault->user ? "user" : "kernel");                                    \
 })
 
+/**
+ * @brief map frame 'paddr' at the faulting page, unless a racing fault
+ * of this address space got there first.
+ * This is the only step that holds pgt_lock, the frame is allocated and
+ * filled beforehand, so faults only serialize on the page-table update.
+ * @return int 0 if mapped, -EEXIST if the page is already present.
+ */
+static int fault_install(vm_fault_t *fault, uintptr_t paddr, int vflags) {
+    int err = -EEXIST;
+
+    spin_lock(&fault->mmap->pgt_lock);
+    if (arch_getmapping(fault->addr, NULL))
+        err = arch_map_i(PGROUND(fault->addr), paddr, PGSZ, vflags);
+    spin_unlock(&fault->mmap->pgt_lock);
+    return err;
+}
+
+// same, for a frame allocated for this fault, freed if it is not mapped.
+static int fault_install_frame(vm_fault_t *fault, uintptr_t paddr, int vflags) {
+    int err = 0;
+
+    if ((err = fault_install(fault, paddr, vflags | PTE_ALLOC))) {
+        pmman.free(paddr);
+        return err == -EEXIST ? 0 : err;
+    }
+    return 0;
+}
+
 int map_anonymous_page(vmr_t *vmr, vm_fault_t *fault) {
-    int vflags = vmr->vflags | (__vmr_zero(vmr) ? PTE_ZERO : 0);
+    int         err     = 0;
+    uintptr_t   paddr   = 0;
+
     /// Map an anonymous page (not backed by a file) into memory
     /// Map the anonymous page into the process's address space
-    return arch_map_n(fault->addr, PGSZ, vflags);
+    if ((err = pmman.get_page(GFP_NORMAL | (__vmr_zero(vmr) ? GFP_ZERO : 0), (void **)&paddr)))
+        return err;
+    return fault_install_frame(fault, paddr, vmr->vflags);
 }
 
 int copy_page_on_write(vmr_t *vmr, vm_fault_t *fault, uintptr_t srcpaddr) {
-    int err = 0;
+    int         err     = 0;
+    uintptr_t   paddr   = 0;
+    pte_t       *pte    = NULL;
     // virtual flags for vmr, maskout PTE_ALLOC??
-    int vflags = vmr->vflags | (PGOFF(fault->COW->raw) & ~PTE_ALLOC);
+    int vflags = vmr->vflags | (PGOFF(srcpaddr) & ~PTE_ALLOC);
 
-    /// remap the page to a new location for COW
-    /// vflags OR'ed with PTE_REMAPPG to force page remap.
-    if ((err = arch_map_n(fault->addr, PGSZ, (PTE_REMAP | vflags)))) {
+    // copy the page before taking pgt_lock, it is only held to swap the copy in.
+    if ((err = pmman.get_page(GFP_NORMAL, (void **)&paddr)))
+        return err;
+
+    if ((err = arch_memcpypp(paddr, PGROUND(srcpaddr), PGSZ))) {
+        pmman.free(paddr);
         return err;
     }
 
-    // Perform the actual memory copy from the source to the destination
-    if ((err = arch_memcpypv(PGROUND(fault->addr), PGROUND(srcpaddr), PGSZ))) {
-        // If the copy fails, unmap the destination and restore the original COW mapping
-        arch_unmap_n(fault->addr, PGSZ);
-#if defined(__x86_64__)
-        fault->COW->raw = srcpaddr; // Restore COW mapping
-        invlpg(fault->addr);
-        arch_tlbshootdown(rdcr3(), fault->addr);
+    spin_lock(&fault->mmap->pgt_lock);
+    // another thread resolved this fault while we copied.
+    if (arch_getmapping(fault->addr, &pte) || pte->raw != srcpaddr) {
+        spin_unlock(&fault->mmap->pgt_lock);
+        pmman.free(paddr);
+        return 0;
+    }
+
+    /// remap the page to a new location for COW
+    /// vflags OR'ed with PTE_REMAPPG to force page remap.
+    if ((err = arch_map_i(PGROUND(fault->addr), paddr, PGSZ, PTE_REMAP | PTE_ALLOC | vflags))) {
+        spin_unlock(&fault->mmap->pgt_lock);
+        pmman.free(paddr);
         return err;
-#endif
     }
 
     // Decrease reference count on the source page
     if ((err = __page_putref(PGROUND(srcpaddr)))) {
-        // If the drop the ref on page fials, unmap the destination and restore the original COW mapping
-        arch_unmap_n(fault->addr, PGSZ);
+        // If the drop the ref on page fials, restore the original COW mapping
 #if defined(__x86_64__)
-        fault->COW->raw = srcpaddr; // Restore COW mapping
+        pte->raw = srcpaddr; // Restore COW mapping
         invlpg(fault->addr);
         arch_tlbshootdown(rdcr3(), fault->addr);
-        return err;
 #endif
+        pmman.free(paddr);
     }
-    return 0;
+    spin_unlock(&fault->mmap->pgt_lock);
+    return err;
 }
 
 int enable_write_access(vm_fault_t *fault) {
@@ -72,12 +114,65 @@ int enable_write_access(vm_fault_t *fault) {
     return 0;
 }
 
-int load_page_from_file(vmr_t *vmr, vm_fault_t *fault, size_t offset, usize size) {
+/**
+ * @brief map the page of vmr->file at 'offset'.
+ * Called with vmr->file locked, returns with it unlocked.
+ * The page is looked up or read in before pgt_lock is taken to map it.
+ */
+static int map_file_page(vmr_t *vmr, vm_fault_t *fault, size_t offset, usize size) {
     int         err       = 0;
     uintptr_t   paddr     = 0;
     uint8_t     buf[PGSZ] = {0};
     page_t      *page     = NULL;
 
+    /**
+     * @brief get the minimum size to read from the file on-disk.
+     * Take into account the size between the start of the memory region and
+     * the faulting address. this TODO: must be subtracted from the __vmr_filesz(vmr),
+     * but setting size to '0' if size is greater than __vmr_filesz(vmr) appears to work.
+     */
+    size = (size < __vmr_filesz(vmr)) ? 
+            (size_t)__min(PGSZ, (size_t)__min(__vmr_filesz(vmr) - size,
+            igetsize(vmr->file) - offset)) : 0;
+
+    if (__vmr_shared(vmr)) { // shared vmr?
+        if ((err = icache_getpage(vmr->file->i_cache, offset / PGSZ, &page))) {
+            iunlock(vmr->file);
+            return err;
+        }
+
+        if ((err = page_getref(page))) {
+            iunlock(vmr->file);
+            return err;
+        }
+        iunlock(vmr->file);
+
+        if ((err = page_get_address(page, (void **)&paddr)) ||
+            (err = fault_install(fault, paddr, vmr->vflags))) {
+            page_putref(page);
+            return err == -EEXIST ? 0 : err;
+        }
+        return 0;
+    }
+
+    // vmr is not shared.
+    if ((err = iread(vmr->file, offset, buf, size)) < 0) {
+        iunlock(vmr->file);
+        return err;
+    }
+    iunlock(vmr->file);
+
+    if ((err = pmman.get_page(GFP_NORMAL, (void **)&paddr)))
+        return err;
+
+    if ((err = arch_memcpyvp(paddr, (uintptr_t)buf, PGSZ))) {
+        pmman.free(paddr);
+        return err;
+    }
+    return fault_install_frame(fault, paddr, vmr->vflags);
+}
+
+int load_page_from_file(vmr_t *vmr, vm_fault_t *fault, size_t offset, usize size) {
     // Load a page from a file into memory
     if (vmr->file) {
         ilock(vmr->file);
@@ -85,56 +180,7 @@ int load_page_from_file(vmr_t *vmr, vm_fault_t *fault, size_t offset, usize size
             iunlock(vmr->file);
             return -EFAULT;
         }
-
-        /**
-         * @brief get the minimum size to read from the file on-disk.
-         * Take into account the size between the start of the memory region and
-         * the faulting address. this TODO: must be subtracted from the __vmr_filesz(vmr),
-         * but setting size to '0' if size is greater than __vmr_filesz(vmr) appears to work.
-         */
-        size = (size < __vmr_filesz(vmr)) ? 
-                (size_t)__min(PGSZ, (size_t)__min(__vmr_filesz(vmr) - size,
-                igetsize(vmr->file) - offset)) : 0;
-
-        if (__vmr_shared(vmr)) { // shared vmr?
-            if ((err = icache_getpage(vmr->file->i_cache, offset / PGSZ, &page))) {
-                iunlock(vmr->file);
-                return err;
-            }
-
-            if ((err = page_getref(page))) {
-                iunlock(vmr->file);
-                return err;
-            }
-
-            if ((err = page_get_address(page, (void **)&paddr))) {
-                iunlock(vmr->file);
-                return err;
-            }
-
-            if ((err = arch_map_i(fault->addr, paddr, PGSZ, vmr->vflags))) {
-                iunlock(vmr->file);
-                return err;
-            }
-        } else { // vmr is not shared.
-            if ((err = arch_map_n(fault->addr, PGSZ, 
-                vmr->vflags | (((__vmr_filesz(vmr) < __vmr_size(vmr)) ||
-                    __vmr_zero(vmr)) ? PTE_ZERO : 0)))) {
-                iunlock(vmr->file);
-                return err;
-            }
-            
-            if ((err = iread(vmr->file, offset, buf, size)) < 0) {
-                arch_unmap_n(fault->addr, PGSZ);
-                iunlock(vmr->file);
-                return err;
-            }
-
-            memcpy((void *)PGROUND(fault->addr), buf, PGSZ);
-        }
-
-        iunlock(vmr->file);
-        return 0;
+        return map_file_page(vmr, fault, offset, size);
     }
 
     return map_anonymous_page(vmr, fault);
@@ -144,17 +190,32 @@ int load_page_from_file(vmr_t *vmr, vm_fault_t *fault, size_t offset, usize size
 int handle_cow_fault(vmr_t *vmr, vm_fault_t *fault) {
     int         err         = 0;
     usize       pgref       = 0;
-    uintptr_t   srcpaddr    = fault->COW->raw;
-    
-    if ((err = __page_getcount(PGROUND(srcpaddr), &pgref)))
+    uintptr_t   srcpaddr    = 0;
+
+    spin_lock(&fault->mmap->pgt_lock);
+    // Another thread may have changed the mapping since the fault.
+    if (arch_getmapping(fault->addr, &fault->COW)) {
+        spin_unlock(&fault->mmap->pgt_lock);
+        return 0;
+    }
+
+    srcpaddr = fault->COW->raw;
+    if ((err = __page_getcount(PGROUND(srcpaddr), &pgref))) {
+        spin_unlock(&fault->mmap->pgt_lock);
+        return err;
+    }
+
+    if (pgref == 1) {
+        // If the page is not shared, just mark it writable
+        err = enable_write_access(fault);
+        spin_unlock(&fault->mmap->pgt_lock);
         return err;
+    }
+    spin_unlock(&fault->mmap->pgt_lock);
 
     if (pgref > 1) {
         // If the page is shared, copy it before writing
         return copy_page_on_write(vmr, fault, srcpaddr);
-    } else if (pgref == 1) {
-        // If the page is not shared, just mark it writable
-        return enable_write_access(fault);
     } else {
         // Invalid page reference count
         return -EFAULT;
@@ -162,11 +223,6 @@ int handle_cow_fault(vmr_t *vmr, vm_fault_t *fault) {
 }
 
 int handle_writable_page_fault(vmr_t *vmr, vm_fault_t *fault, size_t offset, usize size) {
-    int         err         = 0;
-    uintptr_t   paddr       = 0;
-    uint8_t     buf[PGSZ]   = {0};
-    page_t      *page       = NULL;
-
     // Handle writable page faults for non-COW pages
     if (fault->err_code & PTE_P) {
         printk("%s:%d: page fault: faulting page is already present at addr %p, access: %x\n",
@@ -177,54 +233,7 @@ int handle_writable_page_fault(vmr_t *vmr, vm_fault_t *fault, size_t offset, usi
     if (vmr->file) {
         // Load the page from a file if it's backed by one
         ilock(vmr->file);
-        /**
-         * @brief get the minimum size to read from the file on-disk.
-         * Take into account the size between the start of the memory region and
-         * the faulting address. this TODO: must be subtracted from the __vmr_filesz(vmr),
-         * but setting size to '0' if size is greater than __vmr_filesz(vmr) appears to work.
-         */
-        size = (size < __vmr_filesz(vmr)) ? 
-                (size_t)__min(PGSZ, (size_t)__min(__vmr_filesz(vmr) - size,
-                igetsize(vmr->file) - offset)) : 0;
-
-        if (__vmr_shared(vmr)) { // shared vmr?
-            if ((err = icache_getpage(vmr->file->i_cache, offset / PGSZ, &page))) {
-                iunlock(vmr->file);
-                return err;
-            }
-            
-            if ((err = page_getref(page))) {
-                iunlock(vmr->file);
-                return err;
-            }
-
-            if ((err = page_get_address(page, (void **)&paddr))) {
-                iunlock(vmr->file);
-                return err;
-            }
-
-            if ((err = arch_map_i(fault->addr, paddr, PGSZ, vmr->vflags))) {
-                iunlock(vmr->file);
-                return err;
-            }
-        } else { // vmr is not shared.
-            if ((err = arch_map_n(fault->addr, PGSZ, 
-                vmr->vflags | (((__vmr_filesz(vmr) < __vmr_size(vmr)) ||
-                    __vmr_zero(vmr)) ? PTE_ZERO : 0)))) {
-                iunlock(vmr->file);
-                return err;
-            }
-            
-            if ((err = iread(vmr->file, offset, buf, size)) < 0) {
-                arch_unmap_n(fault->addr, PGSZ);
-                iunlock(vmr->file);
-                return err;
-            }
-
-            memcpy((void *)PGROUND(fault->addr), buf, PGSZ);
-        }
-        iunlock(vmr->file);
-        return 0;
+        return map_file_page(vmr, fault, offset, size);
     }
 
     // If the page is not backed by a file, map an anonymous page
@@ -314,7 +323,17 @@ void send_sigbus(mcontext_t *trapframe, vm_fault_t *fault) {
     panic_page_fault(trapframe, fault, "SIGBUS");
 }
 
+// resume a kernel access to user memory at its fixup, see arch/uaccess.h.
+static int fixup_user_access(mcontext_t *trapframe, vm_fault_t *fault) {
+#if defined(__x86_64__)
+    return !fault->user && extable_fixup((uintptr_t *)&trapframe->rip);
+#endif
+}
+
 void handle_kernel_fault(mcontext_t *trapframe, vm_fault_t *fault) {
+    if (fixup_user_access(trapframe, fault))
+        return;
+
     // Handle page faults occurring in kernel mode
     if (fault->user) {
         // If the fault occurred in user space, send a SIGSEGV signal
@@ -331,7 +350,10 @@ int handle_vmr_fault(vmr_t *vmr, vm_fault_t *fault) {
 
     // If the VMR has a custom page fault handler, invoke it
     if (vmr->vmops && vmr->vmops->fault) {
+        // these only map frames they already own, so they run under pgt_lock.
+        spin_lock(&fault->mmap->pgt_lock);
         err = vmr->vmops->fault(vmr, fault);
+        spin_unlock(&fault->mmap->pgt_lock);
     } else {
         // Otherwise, use the default page fault handler
         err = default_pgf_handler(vmr, fault);
@@ -378,22 +400,34 @@ void arch_do_page_fault(mcontext_t *trapframe) {
     // printk("PF: %p, cpu[%d, ncli: %d] tid[%d:%d], rip: %p\n",
         // fault.addr, getcpuid(), cpu->ncli, getpid(), gettid(), trapframe->rip);
 
-    // Lock the memory map and find the corresponding virtual memory region (VMR)
-    mmap_lock(mmap);
+    // Find the corresponding virtual memory region (VMR),
+    // threads of this address space faulting at the same time look it up concurrently.
+    mmap_read_lock(mmap);
     if (NULL == (vmr = mmap_find(mmap, fault.addr))) {
-        mmap_unlock(mmap);
+        mmap_read_unlock(mmap);
+        if (fixup_user_access(trapframe, &fault))
+            return;
         // If no VMR is found, send a SIGSEGV signal to the process
         send_sigsegv(trapframe, &fault);
         return;
     }
 
+    /**
+     * The x86_64 paging code does no locking of its own, so the handlers
+     * take pgt_lock only around the PTE check and update, see fault_install().
+     * Everything else, page allocation and file reads included, runs concurrently.
+     */
+    fault.mmap = mmap;
+
     // Handle the page fault within the found VMR
-    if ((err = handle_vmr_fault(vmr, &fault)) == -EFAULT) {
+    if ((err = handle_vmr_fault(vmr, &fault)) && fixup_user_access(trapframe, &fault)) {
+        // a bad user pointer passed to the kernel, the copy returns short.
+    } else if (err == -EFAULT) {
         // Handle errors specific to SIGBUS or SIGSEGV signals
         send_sigbus(trapframe, &fault);
     } else if (err) {
         send_sigsegv(trapframe, &fault);
     }
 
-    mmap_unlock(mmap);
+    mmap_read_unlock(mmap);
 }
\ No newline at end of file
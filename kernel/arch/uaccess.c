@@ -0,0 +1,85 @@
+#include <arch/uaccess.h>
+#include <bits/errno.h>
+#include <lib/string.h>
+#include <mm/kalloc.h>
+#if defined (__x86_64__)
+#include <arch/x86_64/uaccess.h>
+#endif
+
+// bounds of the exception table, see kernel.ld.
+extern extable_t __extable[];
+extern extable_t __extable_end[];
+
+int extable_fixup(uintptr_t *pip) {
+    for (extable_t *ex = __extable; ex < __extable_end; ++ex) {
+        if (ex->ex_insn == *pip) {
+            *pip = ex->ex_fixup;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static usize arch_copy_user(void *dst, const void *src, usize size) {
+#if defined (__x86_64__)
+    return x86_64_copy_user(dst, src, size);
+#endif
+}
+
+static isize arch_strncpy_user(char *dst, const char *src, usize size) {
+#if defined (__x86_64__)
+    return x86_64_strncpy_user(dst, src, size);
+#endif
+}
+
+usize copy_to_user(void *udst, const void *ksrc, usize size) {
+    if (!access_ok(udst, size))
+        return size;
+    return arch_copy_user(udst, ksrc, size);
+}
+
+usize copy_from_user(void *kdst, const void *usrc, usize size) {
+    usize left = size;
+
+    if (access_ok(usrc, size))
+        left = arch_copy_user(kdst, usrc, size);
+
+    // never hand back stale kernel memory.
+    if (left)
+        memset(kdst + size - left, 0, left);
+    return left;
+}
+
+isize strncpy_from_user(char *kdst, const char *usrc, usize size) {
+    isize len = 0;
+
+    if (!access_ok(usrc, 1))
+        return -EFAULT;
+
+    size = MIN(size, USTACK - (uintptr_t)usrc);
+    if ((len = arch_strncpy_user(kdst, usrc, size)) < 0)
+        return len;
+
+    if (len == 0 || kdst[len - 1] != '\0')
+        return -ENAMETOOLONG;
+    return len - 1;
+}
+
+int strndup_user(const char *usrc, usize size, char **pstr) {
+    isize   err = 0;
+    char    *str= NULL;
+
+    if (pstr == NULL)
+        return -EINVAL;
+
+    if ((str = kmalloc(size)) == NULL)
+        return -ENOMEM;
+
+    if ((err = strncpy_from_user(str, usrc, size)) < 0) {
+        kfree(str);
+        return err;
+    }
+
+    *pstr = str;
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include <arch/cpu.h>
+#include <arch/x86_64/isr.h>
 #include <arch/x86_64/msr.h>
 #include <arch/x86_64/mmu.h>
 #include <arch/x86_64/system.h>
@@ -9,6 +10,7 @@
 #include <sys/thread.h>
 #include <lib/string.h>
 #include <arch/lapic.h>
+#include <arch/tsc.h>
 #include <mm/kalloc.h>
 #include <dev/cga.h>
 #include <arch/paging.h>
@@ -114,6 +116,25 @@ void cpu_get_features(void) {
     */
 }
 
+// SYSRET loads CS from STAR[63:48] + 16 and SS from STAR[63:48] + 8.
+#define STAR_SYSRET     ((u64)((SEG_UDATA64 - 1) << 3) << 48)
+#define STAR_SYSCALL    ((u64)(SEG_KCODE64 << 3) << 32)
+
+// IF, TF, DF, AC and NT are cleared on SYSCALL.
+#define FMASK_SYSCALL   (BS(9) | BS(8) | BS(10) | BS(18) | BS(14))
+
+#define EFER_SCE        BS(0)
+
+static void syscall_init(void) {
+    if (!cpu_has(CPU_SYSCALL))
+        return;
+
+    wrmsr(IA32_STAR, STAR_SYSRET | STAR_SYSCALL);
+    wrmsr(IA32_LSTAR, (uintptr_t)syscall_entry);
+    wrmsr(IA32_FMASK, FMASK_SYSCALL);
+    wrmsr(IA32_EFER, rdmsr(IA32_EFER) | EFER_SCE);
+}
+
 void cpu_init(void) {
     cpu_incr_online();
     memset(cpu, 0, sizeof *cpu);
@@ -122,12 +143,15 @@ void cpu_init(void) {
     gdt_init();
     cpu_get_features();
     sse_init();
+    syscall_init();
 
     cpu->flags |= CPU_ONLINE | CPU_64BIT | CPU_ENABLED;
     cpu->flags |= rdmsr(IA32_EFER) & BS(8) ? CPU_64BIT : 0;
     cpu->flags |= BTEST(rdmsr(IA32_APIC_BASE), 8) ? CPU_ISBSP : 0;
     cpu->flags |= (rdmsr(IA32_APIC_BASE) & ~BS(8)) ? CPU_USE_LAPIC : 0;
-    
+    cpu->apicID = getcpuid();
+
+    tsc_init();
     lapic_init();
 }
 
@@ -235,6 +259,7 @@ int bootothers(void) {
         *((uintptr_t *)VMA2HI(&ap_trampoline[4040])) = (uintptr_t)ap_init;
         lapic_startup(cpus[i]->apicID, (u16)((uintptr_t)ap_trampoline));
         while (!(atomic_read(&cpus[i]->flags) & CPU_ONLINE));
+        tsc_sync_source();
     }
 
     arch_unmap_full(); // unmap lower half of virtual memory address.
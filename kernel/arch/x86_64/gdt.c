@@ -12,6 +12,7 @@ void tss_set(uintptr_t kstack, uint16_t desc __unused) {
     cpu->gdt.tss    = TSS(((uintptr_t)&cpu->tss), (sizeof(cpu->tss) - 1), TSS_SEG, 0x8E);
     memset(&cpu->tss, 0, sizeof cpu->tss);
     cpu->tss.rsp0   = kstack;
+    cpu->kstack     = kstack;
 }
 
 void gdt_init(void) {
@@ -26,8 +27,8 @@ void gdt_init(void) {
     cpu->gdt.null       = SEG(0, 0, 0, 0);
     cpu->gdt.kcode64    = SEG(0, -1, SEG_CODE, KCODE_SEG);
     cpu->gdt.kdata64    = SEG(0, -1, SEG_DATA, KDATA_SEG);
-    cpu->gdt.ucode64    = SEG(0, -1, SEG_CODE, UCODE_SEG64);
     cpu->gdt.udata64    = SEG(0, -1, SEG_DATA, UDATA_SEG);
+    cpu->gdt.ucode64    = SEG(0, -1, SEG_CODE, UCODE_SEG64);
     cpu->gdt.tss        = TSS(((uintptr_t)&cpu->tss), (sizeof (cpu->tss) - 1), TSS_SEG, 0x8E);
 
     descptr_t ptr = (descptr_t) {
@@ -158,4 +158,55 @@ trapret:
     restore_context
     swapgs
     add     rsp, 16
-    iretq
\ No newline at end of file
+    iretq
+
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+; SYSCALL/SYSRET fast system call entry.
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+
+global syscall_entry
+extern syscall_trap
+
+; cpu_t fields, see arch/cpu.h.
+%define CPU_KSTACK      0
+%define CPU_USTACK      8
+
+%define USER_CS         0x23    ; (SEG_UCODE64 << 3) | DPL_USR
+%define USER_SS         0x1b    ; (SEG_UDATA64 << 3) | DPL_USR
+%define T_SYSCALL       129
+
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+; SYSCALL lands here(IA32_LSTAR) with
+; rcx = user rip, r11 = user rflags and
+; interrupts off(IA32_FMASK), still on the user stack.
+; The frame built is the one 'int 0x80' would have left.
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+syscall_entry:
+    swapgs
+    mov     [gs:CPU_USTACK], rsp
+    mov     rsp, [gs:CPU_KSTACK]
+
+    push    qword USER_SS
+    push    qword [gs:CPU_USTACK]
+    push    r11                 ; rflags
+    push    qword USER_CS
+    push    rcx                 ; rip
+    push    qword 0             ; errno
+    push    qword T_SYSCALL     ; trapno
+    save_context
+
+    sub     rsp, 48 ; for uc_link, us_sigmask and us_stack.
+    mov     rdi, rsp
+    call    syscall_trap
+    add     rsp, 48
+
+    ; syscall_trap() returns with interrupts off,
+    ; and zero if the frame can't be resumed with SYSRET.
+    test    eax, eax
+    jz      trapret
+
+    restore_context
+    ; rcx and r11 hold rip and rflags again.
+    mov     rsp, [rsp + 40]
+    swapgs
+    o64 sysret
@@ -9,6 +9,11 @@
 #include <ginger/jiffies.h>
 #include <dev/hpet.h>
 #include <dev/clocks.h>
+#include <ginger/ktimer.h>
+#include <ginger/hrtimer.h>
+#include <arch/cpu.h>
+#include <arch/tsc.h>
+#include <ginger/tick.h>
 
 #define LAPIC_BASE    ((volatile uint32_t *)VMA2HI(PGROUND(rdmsr(IA32_APIC_BASE))))
 
@@ -43,6 +48,7 @@
 
 #define ONESHOT         SHL(0b0, 17)
 #define PERIODIC        SHL(0b1, 17)
+#define TSCDEADLINE     SHL(0b10, 17)
 
 #define MASKED          BS(16)
 #define LEVEL           BS(15)
@@ -110,6 +116,7 @@ int lapic_init(void) {
 
     TPR = 0;
     lapic_recalibrate(SYS_HZ);
+    tick_init();
     lapic_eoi();
     return 0;
 }
@@ -128,10 +135,50 @@ void lapic_recalibrate(long hz) {
     LVT_TMR = MASKED;
     ticks = ((uint32_t)-1) - CCR;
 
+    cpu->timer_freq = (u64)ticks * hz;
+
     ICR = ticks;
     LVT_TMR = timer;
 }
 
+void lapic_timer_stop(void) {
+    if (cpu_has(CPU_TSC_DL))
+        wrmsr(IA32_TSC_DEADLINE, 0);
+    LVT_TMR = MASKED | LAPIC_TIMER;
+    ICR = 0;
+}
+
+void lapic_timer_oneshot(u64 deadline) {
+    u64 now   = rdtsc();
+    u64 count = 0;
+
+    // 'deadline' is on the BSP's TSC, a saturated one stays in the far future.
+    if (deadline != (u64)-1)
+        deadline = tsc_to_local(deadline);
+
+    if (cpu_has(CPU_TSC_DL)) {
+        // changing the timer mode disarms the deadline, so only do it when needed.
+        if (LVT_TMR != (TSCDEADLINE | LAPIC_TIMER))
+            LVT_TMR = TSCDEADLINE | LAPIC_TIMER;
+        // a deadline already in the past fires immediately.
+        wrmsr(IA32_TSC_DEADLINE, deadline);
+        return;
+    }
+
+    // an early interrupt just reprograms the timer,
+    // so waiting at most a second at a time is fine.
+    if (deadline > now)
+        count = MIN(deadline - now, tsc_freq());
+
+    // convert the TSC delta into local APIC timer ticks(32.32 fixed point ratio).
+    count = (count * ((cpu->timer_freq << 32) / tsc_freq())) >> 32;
+    count = count ? count : 1;
+    count = count > (uint32_t)-1 ? (uint32_t)-1 : count;
+
+    LVT_TMR = ONESHOT | LAPIC_TIMER;
+    ICR = (uint32_t)count;
+}
+
 void lapic_startup(int dst, uint16_t addr) {
     ICR1 = (dst << 24);
     ICR0 = INIT | ASSERT;
@@ -157,6 +204,15 @@ void lapic_startup(int dst, uint16_t addr) {
 
 void lapic_timerintr(void) {
     atomic_inc(&cpu->timer_ticks);
+
+    if (tick_nohz_active()) {
+        tick_handler();
+        return;
+    }
+
+    ktimer_run();
+    hrtimer_run();
+
     if (current) {
         current_lock();
         current->t_sched.ts_timeslice--;
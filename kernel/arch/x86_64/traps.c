@@ -15,6 +15,8 @@
 #include <arch/paging.h>
 #include <sys/syscall.h>
 #include <sys/proc.h>
+#include <ginger/tick.h>
+#include <sync/rcu.h>
 
 void dump_tf(mcontext_t *mctx, int halt) {
     void *stack_sp = NULL;
@@ -161,6 +163,10 @@ void trap(ucontext_t *uctx) {
         tlb_shootdown_handler();
         lapic_eoi();
         break;
+    case SCHED_IPI:
+        tick_program();
+        lapic_eoi();
+        break;
     case LAPIC_ERROR:
         lapic_eoi();
         break;
@@ -190,10 +196,49 @@ void trap(ucontext_t *uctx) {
 
     // sched_remove_zombies();
 
+    // RCU read-side sections run with interrupts disabled, so they can't have been interrupted.
+    if (mctx->rflags & 0x200)
+        rcu_quiescent();
+
     if (!current)
         return;
 
     thread_handle_event(uctx);
 
     arch->t_uctx = uctx->uc_link;
-}
\ No newline at end of file
+}
+
+// SYSRET faults in kernel mode on a non-canonical rip, leave those to iretq.
+static int syscall_sysret_ok(mcontext_t *mctx) {
+    return  mctx->rcx == mctx->rip              &&
+            mctx->r11 == mctx->rflags           &&
+            mctx->cs  == ((SEG_UCODE64 << 3) | DPL_USR) &&
+            mctx->ss  == ((SEG_UDATA64 << 3) | DPL_USR) &&
+            (mctx->rip >> 47) == 0;
+}
+
+/**
+ * @brief SYSCALL entry, called by syscall_entry(see isrs.asm) with interrupts off.
+ * Unlike T_LEG_SYSCALL in trap(), pending events are only handled on the way out.
+ * @return int non-zero if the frame can be resumed with SYSRET.
+ */
+int syscall_trap(ucontext_t *uctx) {
+    arch_thread_t   *arch   = &current->t_arch;
+    mcontext_t      *mctx   = &uctx->uc_mcontext;
+
+    uctx->uc_stack  = arch->t_kstack;
+    uctx->uc_link   = arch->t_uctx;
+    arch->t_uctx    = uctx;
+    uctx->uc_flags  = 0;
+    sigemptyset(&uctx->uc_sigmask);
+    sti();
+
+    do_syscall(uctx);
+
+    rcu_quiescent();
+    thread_handle_event(uctx);
+
+    cli();
+    arch->t_uctx = uctx->uc_link;
+    return syscall_sysret_ok(mctx);
+}
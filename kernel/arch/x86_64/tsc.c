@@ -0,0 +1,209 @@
+#include <arch/cpu.h>
+#include <arch/tsc.h>
+#include <arch/x86_64/msr.h>
+#include <dev/clocks.h>
+#include <dev/hpet.h>
+#include <ginger/clocksource.h>
+#include <ginger/jiffies.h>
+#include <ginger/vdso.h>
+#include <lib/printk.h>
+#include <sync/atomic.h>
+#include <sync/preempt.h>
+
+// calibration runs, the shortest one is kept.
+#define TSC_CALIBRATE_RUNS  3
+#define TSC_CALIBRATE_MS    10
+
+// samples of the BSP's TSC taken by an AP to find its offset.
+#define TSC_SYNC_LOOPS      1000
+
+#define TSC_SYNC_IDLE       0
+#define TSC_SYNC_READY      1   // target waits for samples.
+#define TSC_SYNC_DONE       2   // target has its offset.
+
+static u64 tsc_hz       = 0;    // TSC ticks per second.
+static u64 tsc_epoch    = 0;    // TSC value at jiffy 0.
+static int tsc_invariant= 0;    // ticks at a constant rate in all P-, C- and T-states.
+static int tsc_has_aux  = 0;    // RDTSCP is supported, IA32_TSC_AUX holds the APIC ID.
+
+// added to the local TSC to get the BSP's.
+static u64 tsc_offsets[MAXNCPU];
+
+static atomic_t tsc_sync_state  = TSC_SYNC_IDLE;
+static u64      tsc_sync_val    = 0;
+
+static clocksource_t tsc_clocksource;
+
+void tsc_setfreq(u64 hz) {
+    if (hz == 0 || atomic_read(&tsc_hz))
+        return;
+    tsc_epoch = tsc_read();
+    atomic_write(&tsc_hz, hz);
+}
+
+u64 tsc_freq(void) {
+    return atomic_read(&tsc_hz);
+}
+
+u64 tsc_read(void) {
+    u32 aux = 0;
+    u64 tsc = 0;
+
+    if (tsc_has_aux) {
+        tsc = rdtscp(&aux);
+        return tsc + tsc_offsets[aux % MAXNCPU];
+    }
+
+    pushcli();
+    tsc = rdtsc() + tsc_offsets[cpu->apicID];
+    popcli();
+    return tsc;
+}
+
+u64 tsc_to_local(u64 tsc) {
+    return tsc - tsc_offsets[cpu->apicID];
+}
+
+u64 tsc_from_jiffies(u64 jiffies) {
+    u64 per = tsc_freq() / SYS_HZ;
+
+    // saturate rather than wrap to a deadline in the past.
+    if (per && jiffies > ((u64)-1 - tsc_epoch) / per)
+        return (u64)-1;
+    return tsc_epoch + jiffies * per;
+}
+
+u64 tsc_jiffies(void) {
+    u64 hz = tsc_freq();
+    if (hz == 0)
+        return 0;
+    return (tsc_read() - tsc_epoch) / (hz / SYS_HZ);
+}
+
+u64 tsc_to_ns(u64 ticks) {
+    u64 hz = tsc_freq();
+    if (hz == 0)
+        return 0;
+    // split to avoid overflowing 'ticks * NSEC_PER_SEC'.
+    return (ticks / hz) * NSEC_PER_SEC + ((ticks % hz) * NSEC_PER_SEC) / hz;
+}
+
+u64 tsc_ns(void) {
+    if (tsc_freq() == 0)
+        return 0;
+    return tsc_to_ns(tsc_read() - tsc_epoch);
+}
+
+u64 tsc_from_ns(u64 ns) {
+    u64 hz = tsc_freq();
+    // split to avoid overflowing 'ns * hz'.
+    return tsc_epoch + (ns / NSEC_PER_SEC) * hz + ((ns % NSEC_PER_SEC) * hz) / NSEC_PER_SEC;
+}
+
+int tsc_has_rdtscp(void) {
+    return tsc_has_aux;
+}
+
+/**
+ * @brief measure the TSC frequency against the HPET, or the PIT if there is none.
+ * Anything delaying us only makes a run longer, so the shortest run is kept.
+ */
+static void tsc_calibrate(void) {
+    u64 tsc     = 0;
+    u64 best    = (u64)-1;
+    int clock   = hpet_freq() ? CLK_HPET : CLK_PIT;
+
+    for (int i = 0; i < TSC_CALIBRATE_RUNS; ++i) {
+        tsc = rdtsc();
+        timer_wait(clock, ms_TO_s(TSC_CALIBRATE_MS));
+        tsc = rdtsc() - tsc;
+        best = MIN(best, tsc);
+    }
+
+    tsc_setfreq(best * (1000 / TSC_CALIBRATE_MS));
+
+    // with RDTSCP, user mode can find and apply the offset of its CPU on its own.
+    tsc_clocksource = CLOCKSOURCE_INIT("tsc", tsc_invariant ? 300 : 100, tsc_freq(), tsc_read, tsc_has_aux);
+    clocksource_register(&tsc_clocksource);
+
+    printk("TSC: %lu kHz(%s, %s), calibrated against the %s.\n",
+        tsc_freq() / 1000, tsc_invariant ? "invariant" : "variant",
+        tsc_has_aux ? "rdtscp" : "rdtsc", clock == CLK_HPET ? "HPET" : "PIT");
+}
+
+/**
+ * @brief called by the BSP right after starting an AP,
+ * feeds it TSC samples until it has found its offset.
+ */
+void tsc_sync_source(void) {
+    if (tsc_freq() == 0)
+        return;
+
+    while (atomic_read(&tsc_sync_state) != TSC_SYNC_READY)
+        cpu_pause();
+
+    while (atomic_read(&tsc_sync_state) != TSC_SYNC_DONE)
+        atomic_write(&tsc_sync_val, tsc_read());
+
+    atomic_write(&tsc_sync_state, TSC_SYNC_IDLE);
+}
+
+/**
+ * @brief find how far the local TSC lags the BSP's.
+ * A sample is at least as old as the BSP's TSC when it was read, so the
+ * largest difference seen is the closest to the real offset.
+ * A TSC ahead of the BSP's can't be moved back and is left alone.
+ */
+static void tsc_sync_target(void) {
+    u64 val     = 0;
+    u64 tsc     = 0;
+    u64 offset  = 0;
+
+    atomic_write(&tsc_sync_val, 0);
+    atomic_write(&tsc_sync_state, TSC_SYNC_READY);
+
+    while (atomic_read(&tsc_sync_val) == 0)
+        cpu_pause();
+
+    for (int i = 0; i < TSC_SYNC_LOOPS; ++i) {
+        val = atomic_read(&tsc_sync_val);
+        // don't let the TSC be read before the sample is.
+        asm __volatile__ ("lfence" ::: "memory");
+        tsc = rdtsc();
+        if ((i64)(val - tsc) > (i64)offset)
+            offset = val - tsc;
+    }
+
+    tsc_offsets[cpu->apicID] = offset;
+    vdso_update_tsc_offset(cpu->apicID, offset);
+    atomic_write(&tsc_sync_state, TSC_SYNC_DONE);
+}
+
+void tsc_init(void) {
+    u32 a = 0, b = 0, c = 0, d = 0;
+
+    if (!cpu_has(CPU_TSC))
+        return;
+
+    cpuid(0x80000000, 0, &a, &b, &c, &d);
+    if (a >= 0x80000001) {
+        cpuid(0x80000001, 0, &a, &b, &c, &d);
+        // only what the BSP supports is relied on.
+        if (isbsp())
+            tsc_has_aux = BTEST(d, 27);
+    }
+
+    cpuid(0x80000000, 0, &a, &b, &c, &d);
+    if (isbsp() && a >= 0x80000007) {
+        cpuid(0x80000007, 0, &a, &b, &c, &d);
+        tsc_invariant = BTEST(d, 8);
+    }
+
+    if (tsc_has_aux)
+        wrmsr(IA32_TSC_AUX, cpu->apicID);
+
+    if (isbsp())
+        tsc_calibrate();
+    else if (tsc_freq())
+        tsc_sync_target();
+}
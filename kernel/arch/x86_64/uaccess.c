@@ -0,0 +1,50 @@
+#include <arch/x86_64/uaccess.h>
+#include <bits/errno.h>
+
+usize x86_64_copy_user(void *dst, const void *src, usize size) {
+    usize   tail    = size & 7;
+    usize   n       = size >> 3;
+
+    // a fault in movsq leaves 'n' quad words and the tail to copy, in movsb 'n' bytes.
+    asm __volatile__ (
+        "1: rep movsq\n"
+        "   movq %[tail], %%rcx\n"
+        "2: rep movsb\n"
+        "   jmp 4f\n"
+        "3: leaq (%[tail], %%rcx, 8), %%rcx\n"
+        "4:\n"
+        EXTABLE("1b", "3b")
+        EXTABLE("2b", "4b")
+        : "+c"(n), "+D"(dst), "+S"(src)
+        : [tail]"r"(tail)
+        : "memory"
+    );
+
+    return n;
+}
+
+isize x86_64_strncpy_user(char *dst, const char *src, usize size) {
+    usize   i   = 0;
+    isize   err = 0;
+
+    asm __volatile__ (
+        "   testq %[size], %[size]\n"
+        "   jz 3f\n"
+        "1: movb (%[src], %[i]), %%al\n"
+        "   movb %%al, (%[dst], %[i])\n"
+        "   incq %[i]\n"
+        "   testb %%al, %%al\n"
+        "   jz 3f\n"
+        "   cmpq %[size], %[i]\n"
+        "   jb 1b\n"
+        "   jmp 3f\n"
+        "2: movq %[efault], %[err]\n"
+        "3:\n"
+        EXTABLE("1b", "2b")
+        : [i]"+r"(i), [err]"+r"(err)
+        : [src]"r"(src), [dst]"r"(dst), [size]"r"(size), [efault]"i"(-EFAULT)
+        : "rax", "memory", "cc"
+    );
+
+    return err ? err : (isize)i;
+}
@@ -0,0 +1,177 @@
+; vDSO text page, see ginger/vdso.h.
+; Copied as is to a page mapped right above the data page,
+; so everything here must be position independent.
+bits 64
+default rel
+
+section .rodata
+
+%define VD_SEQ          0
+%define VD_FLAGS        4
+%define VD_CYCLES       8
+%define VD_BASE         16
+%define VD_MULT         24
+%define VD_REALTIME     32
+%define VD_TSC_OFFSET   40
+%define VD_CPU          192
+
+%define VC_SEQ          0
+%define VC_PID          4
+%define VC_TID          8
+
+%define VDSO_CLOCK      1
+%define VDSO_GETCPU     2
+
+%define VDSO_NCPU       16      ; MAXNCPU
+
+%define CLOCK_REALTIME  0
+%define CLOCK_MONOTONIC 1
+
+%define NSEC_PER_SEC    1000000000
+%define NSEC_PER_USEC   1000
+
+; the data page.
+%define vdso_data       (vdso_start - 0x1000)
+
+global vdso_start
+vdso_start:
+    ; entry points, VDSO_ENTRY_SIZE bytes apart.
+    jmp     near vdso_clock_gettime
+    align   8, db 0xcc
+    jmp     near vdso_gettimeofday
+    align   8, db 0xcc
+    jmp     near vdso_getpid
+    align   8, db 0xcc
+    jmp     near vdso_gettid
+    align   8, db 0xcc
+
+; int vdso_clock_gettime(clockid_t clock_id, struct timespec *tp)
+vdso_clock_gettime:
+    cmp     rdi, CLOCK_MONOTONIC
+    je      .ok
+    cmp     rdi, CLOCK_REALTIME
+    jne     .fallback
+.ok:
+    test    rsi, rsi
+    jz      .fallback
+    lea     r8, [vdso_data]
+.retry:
+    mov     r9d, [r8 + VD_SEQ]
+    test    r9d, 1
+    jnz     .busy
+    test    dword [r8 + VD_FLAGS], VDSO_CLOCK
+    jz      .fallback
+
+    ; rax = TSC + offset of this CPU, rdtscp returns both at once.
+    rdtscp
+    shl     rdx, 32
+    or      rax, rdx
+    and     ecx, VDSO_NCPU - 1
+    add     rax, [r8 + VD_TSC_OFFSET + rcx * 8]
+
+    ; rax = base + ((TSC - cycles) * mult) >> 32, a TSC behind 'cycles' counts as 0.
+    sub     rax, [r8 + VD_CYCLES]
+    jns     .delta
+    xor     eax, eax
+.delta:
+    mul     qword [r8 + VD_MULT]
+    shrd    rax, rdx, 32
+    add     rax, [r8 + VD_BASE]
+
+    cmp     edi, CLOCK_REALTIME
+    jne     .check
+    mov     r10, [r8 + VD_REALTIME]
+    test    r10, r10
+    jz      .fallback
+    add     rax, r10
+.check:
+    cmp     r9d, [r8 + VD_SEQ]
+    jne     .retry
+
+    xor     edx, edx
+    mov     r10, NSEC_PER_SEC
+    div     r10
+    mov     [rsi], rax              ; tv_sec
+    mov     [rsi + 8], rdx          ; tv_nsec
+    xor     eax, eax
+    ret
+.busy:
+    pause
+    jmp     .retry
+.fallback:
+    mov     eax, -1
+    ret
+
+; int vdso_gettimeofday(struct timeval *tp, void *tzp)
+vdso_gettimeofday:
+    test    rdi, rdi
+    jz      .fallback
+    push    rdi
+    sub     rsp, 16                 ; struct timespec, keeps the stack 16 byte aligned.
+    mov     edi, CLOCK_REALTIME
+    mov     rsi, rsp
+    call    vdso_clock_gettime
+    test    eax, eax
+    jnz     .out
+    mov     rax, [rsp + 8]          ; tv_nsec
+    xor     edx, edx
+    mov     rcx, NSEC_PER_USEC
+    div     rcx
+    mov     rdi, [rsp + 16]
+    mov     [rdi + 8], rax          ; tv_usec
+    mov     rax, [rsp]
+    mov     [rdi], rax              ; tv_sec
+    xor     eax, eax
+.out:
+    add     rsp, 16
+    pop     rdi
+    ret
+.fallback:
+    mov     eax, -1
+    ret
+
+; pid_t vdso_getpid(void)
+vdso_getpid:
+    mov     r11d, VC_PID
+    jmp     vdso_cpu_read
+
+; tid_t vdso_gettid(void)
+vdso_gettid:
+    mov     r11d, VC_TID
+
+; read the field at offset r11 of the slot of the CPU we run on.
+; The slot is ours if we are on the same CPU before and after reading it,
+; and no thread was switched in on that CPU meanwhile.
+vdso_cpu_read:
+    lea     r8, [vdso_data]
+    test    dword [r8 + VD_FLAGS], VDSO_GETCPU
+    jz      .fallback
+.retry:
+    rdtscp
+    and     ecx, VDSO_NCPU - 1
+    shl     ecx, 6                  ; sizeof (vdso_cpu_t)
+    lea     r9, [r8 + VD_CPU + rcx]
+    mov     r10d, [r9 + VC_SEQ]
+    test    r10d, 1
+    jnz     .busy
+    mov     esi, [r9 + r11]
+    ; rdtscp waits for the loads above.
+    rdtscp
+    and     ecx, VDSO_NCPU - 1
+    shl     ecx, 6
+    lea     rdx, [r8 + VD_CPU + rcx]
+    cmp     rdx, r9
+    jne     .retry
+    cmp     r10d, [r9 + VC_SEQ]
+    jne     .retry
+    mov     eax, esi
+    ret
+.busy:
+    pause
+    jmp     .retry
+.fallback:
+    mov     eax, -1
+    ret
+
+global vdso_end
+vdso_end:
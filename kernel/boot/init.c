@@ -18,6 +18,8 @@
 #include <dev/fb.h>
 #include <dev/console.h>
 #include <mm/kalloc.h>
+#include <ginger/vdso.h>
+#include <sys/systrace.h>
 #include <arch/x86_64/ipi.h>
 
 extern __noreturn void kthread_main(void);
@@ -36,6 +38,10 @@ int early_init(void) {
     if ((err = pmman.init()))
         panic("Physical memory initialization failed, error: %d\n", err);
 
+    // before the APs come up and publish their TSC offsets.
+    if ((err = vdso_init()))
+        panic("Failed to set up the vDSO, error: %d\n", err);
+
     earlycons_usefb();
 
     if ((err = acpi_init()))
@@ -43,6 +49,9 @@ int early_init(void) {
 
     bootothers();
 
+    if ((err = systrace_init()))
+        panic("Failed to set up system call accounting, error: %d\n", err);
+
     pic_init();
     ioapic_init();
 
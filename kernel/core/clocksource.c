@@ -0,0 +1,119 @@
+#include <bits/errno.h>
+#include <dev/rtc.h>
+#include <ginger/clocksource.h>
+#include <ginger/jiffies.h>
+#include <ginger/vdso.h>
+#include <sync/atomic.h>
+#include <sync/preempt.h>
+#include <sync/seqlock.h>
+#include <sync/spinlock.h>
+
+static u64 clocksource_jiffies_read(void) {
+    return jiffies_get();
+}
+
+static clocksource_t clocksource_jiffies = {
+    .cs_name    = "jiffies",
+    .cs_rating  = 1,
+    .cs_freq    = SYS_HZ,
+    .cs_read    = clocksource_jiffies_read,
+    .cs_mult    = ((u64)NSEC_PER_SEC / SYS_HZ) << 32,
+};
+
+static SPINLOCK(clocksource_lock);                  // serializes writers of the below.
+static clocksource_t    *clocksource_list   = &clocksource_jiffies;
+
+// the clocksource in use, and where it took over.
+static seqcount_t       clocksource_seq     = {0};
+static clocksource_t    *clocksource_curr   = &clocksource_jiffies;
+static u64              clocksource_cycles  = 0;    // counter value when it took over.
+static u64              clocksource_base    = 0;    // CLOCK_MONOTONIC ns when it took over.
+
+// CLOCK_REALTIME - CLOCK_MONOTONIC, 0 until first read.
+static u64              clocksource_realtime= 0;
+
+static inline u64 clocksource_cyc2ns(const clocksource_t *cs, u64 cycles) {
+    return ((unsigned __int128)cycles * cs->cs_mult) >> 32;
+}
+
+// read the clock, with clocksource_seq held.
+static u64 clocksource_read(void) {
+    clocksource_t *cs = clocksource_curr;
+    return clocksource_base + clocksource_cyc2ns(cs, cs->cs_read() - clocksource_cycles);
+}
+
+u64 clocksource_ns(void) {
+    u32 seq = 0;
+    u64 ns  = 0;
+
+    do {
+        seq = read_seqcount_begin(&clocksource_seq);
+        ns  = clocksource_read();
+    } while (read_seqcount_retry(&clocksource_seq, seq));
+    return ns;
+}
+
+int clocksource_register(clocksource_t *cs) {
+    if (cs == NULL || cs->cs_freq == 0 || cs->cs_read == NULL)
+        return -EINVAL;
+
+    cs->cs_mult = ((u64)NSEC_PER_SEC << 32) / cs->cs_freq;
+
+    // readers spin while the count is odd, keep interrupts off meanwhile.
+    pushcli();
+    spin_lock(clocksource_lock);
+    cs->cs_next      = clocksource_list;
+    clocksource_list = cs;
+
+    if (cs->cs_rating > clocksource_curr->cs_rating) {
+        write_seqcount_begin(&clocksource_seq);
+        clocksource_base   = clocksource_read();
+        clocksource_cycles = cs->cs_read();
+        clocksource_curr   = cs;
+        write_seqcount_end(&clocksource_seq);
+        vdso_update_clock(cs->cs_user, clocksource_cycles, clocksource_base, cs->cs_mult);
+    }
+    spin_unlock(clocksource_lock);
+    popcli();
+    return 0;
+}
+
+const char *clocksource_name(void) {
+    return atomic_read(&clocksource_curr)->cs_name;
+}
+
+u64 clocksource_res(void) {
+    u64 freq = atomic_read(&clocksource_curr)->cs_freq;
+    return freq >= NSEC_PER_SEC ? 1 : NSEC_PER_SEC / freq;
+}
+
+u64 clocksource_realtime_offset(void) {
+    u64 realtime = 0;
+
+    // the RTC only has second resolution, a racing first read is as good as ours.
+    if ((realtime = atomic_read(&clocksource_realtime)) == 0) {
+        realtime = (u64)rtc_gettime() * NSEC_PER_SEC - clocksource_ns();
+        atomic_write(&clocksource_realtime, realtime);
+        vdso_update_realtime(realtime);
+    }
+    return realtime;
+}
+
+void clocksource_set_realtime(u64 ns) {
+    u64 realtime = ns - clocksource_ns();
+
+    atomic_write(&clocksource_realtime, realtime);
+    vdso_update_realtime(realtime);
+}
+
+void clocksource_vdso_sync(void) {
+    clocksource_t *cs = NULL;
+
+    pushcli();
+    spin_lock(clocksource_lock);
+    cs = clocksource_curr;
+    vdso_update_clock(cs->cs_user, clocksource_cycles, clocksource_base, cs->cs_mult);
+    vdso_update_realtime(atomic_read(&clocksource_realtime));
+    spin_unlock(clocksource_lock);
+    popcli();
+}
@@ -0,0 +1,145 @@
+#include <arch/cpu.h>
+#include <bits/errno.h>
+#include <ginger/clocksource.h>
+#include <ginger/hrtimer.h>
+#include <ginger/tick.h>
+#include <sync/preempt.h>
+#include <sync/spinlock.h>
+#include <sys/_time.h>
+
+typedef struct hrtimer_base {
+    spinlock_t  hb_lock;
+    rb_root_t   hb_root;        // armed timers, earliest expiry first.
+    hrtimer_t   *hb_running;    // timer whose ht_func is running.
+} __aligned(64) hrtimer_base_t;
+
+static hrtimer_base_t   hrtimer_bases[MAXNCPU];
+
+#define hrtimer_base_lock(b)    ({ spin_lock(&(b)->hb_lock); })
+#define hrtimer_base_unlock(b)  ({ spin_unlock(&(b)->hb_lock); })
+
+#define hrtimer_entry(node)     rb_entry(node, hrtimer_t, ht_node)
+
+static int hrtimer_less(const rb_node_t *a, const rb_node_t *b) {
+    return hrtimer_entry(a)->ht_expires < hrtimer_entry(b)->ht_expires;
+}
+
+u64 hrtimer_now(void) {
+    return clocksource_ns();
+}
+
+void hrtimer_run(void) {
+    u64             now     = 0;
+    rb_node_t       *node   = NULL;
+    hrtimer_t       *ht     = NULL;
+    hrtimer_base_t  *base   = NULL;
+
+    pushcli();
+    base = &hrtimer_bases[cpu->apicID];
+    now  = hrtimer_now();
+
+    hrtimer_base_lock(base);
+    while ((node = rb_first(&base->hb_root))) {
+        if ((ht = hrtimer_entry(node))->ht_expires > now)
+            break;
+
+        rb_erase(&base->hb_root, node);
+        atomic_write(&ht->ht_base, NULL);
+        atomic_write(&base->hb_running, ht);
+        hrtimer_base_unlock(base);
+
+        ht->ht_func(ht);
+
+        hrtimer_base_lock(base);
+        atomic_write(&base->hb_running, NULL);
+    }
+    hrtimer_base_unlock(base);
+    popcli();
+}
+
+int hrtimer_del(hrtimer_t *ht) {
+    hrtimer_base_t *base = NULL;
+
+    /**
+     * a timer moves between bases only while disarmed, recheck once locked.
+     * The interrupt programmed for it is left alone, it finds nothing due
+     * and programs the next expiry.
+     */
+    while ((base = atomic_read(&ht->ht_base))) {
+        hrtimer_base_lock(base);
+        if (ht->ht_base == base) {
+            rb_erase(&base->hb_root, &ht->ht_node);
+            atomic_write(&ht->ht_base, NULL);
+            hrtimer_base_unlock(base);
+            return 1;
+        }
+        hrtimer_base_unlock(base);
+    }
+    return 0;
+}
+
+int hrtimer_del_sync(hrtimer_t *ht) {
+    int pending = 0;
+
+    do {
+        pending |= hrtimer_del(ht);
+        for (int i = 0; i < MAXNCPU; ++i) {
+            while (atomic_read(&hrtimer_bases[i].hb_running) == ht)
+                cpu_pause();
+        }
+    } while (hrtimer_pending(ht));
+    return pending;
+}
+
+int hrtimer_add(hrtimer_t *ht, u64 expires) {
+    int             first   = 0;
+    int             pending = 0;
+    hrtimer_base_t  *base   = NULL;
+
+    pending = hrtimer_del(ht);
+
+    pushcli();
+    base = &hrtimer_bases[cpu->apicID];
+    hrtimer_base_lock(base);
+
+    ht->ht_expires = expires;
+    rb_insert(&base->hb_root, &ht->ht_node, hrtimer_less);
+    atomic_write(&ht->ht_base, base);
+    first = rb_first(&base->hb_root) == &ht->ht_node;
+    hrtimer_base_unlock(base);
+
+    // the new timer is the earliest, bring the timer interrupt forward.
+    if (first)
+        tick_program();
+    popcli();
+    return pending;
+}
+
+int hrtimer_cpu_next(u64 *expires) {
+    int             armed   = 0;
+    rb_node_t       *node   = NULL;
+    hrtimer_base_t  *base   = NULL;
+
+    pushcli();
+    base = &hrtimer_bases[cpu->apicID];
+    hrtimer_base_lock(base);
+    if ((node = rb_first(&base->hb_root))) {
+        *expires = hrtimer_entry(node)->ht_expires;
+        armed    = 1;
+    }
+    hrtimer_base_unlock(base);
+    popcli();
+    return armed;
+}
+
+int hrtimer_clock_offset(clockid_t clock_id, u64 *offset) {
+    switch (clock_id) {
+    case CLOCK_MONOTONIC:
+        *offset = 0;
+        return 0;
+    case CLOCK_REALTIME:
+        *offset = clocksource_realtime_offset();
+        return 0;
+    }
+    return -EINVAL;
+}
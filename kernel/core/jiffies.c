@@ -1,27 +1,34 @@
 #include <bits/errno.h>
-#include <ds/btree.h>
 #include <ds/queue.h>
 #include <ginger/jiffies.h>
+#include <ginger/ktimer.h>
 #include <lib/printk.h>
-#include <sync/cond.h>
 #include <sync/spinlock.h>
 #include <sys/sched.h>
 #include <sys/thread.h>
 #include <sys/_time.h>
-#include <dev/clocks.h>
+#include <arch/tsc.h>
+#include <ginger/tick.h>
 
-static SPINLOCK(res_lock);
-static jiffies_t        jiffies     = 0;
-static struct timespec  jiffies_res = {0};
-static queue_t          *sleep_queue= QUEUE_NEW();
+// a thread in jiffies_sleep(), woken by its own timer.
+typedef struct jiffies_sleeper {
+    ktimer_t    js_timer;
+    spinlock_t  js_lock;
+    int         js_expired;
+    queue_t     js_queue;   // sleep queue holding only the sleeping thread.
+} jiffies_sleeper_t;
+
+static jiffies_t        jiffies     = 0;    // periodic tick count.
 
 void jiffies_update(void) {
-    atomic_inc(&jiffies);
-    clock_trigger();
-    sched_wakeall(sleep_queue);
+    // in NOHZ mode jiffies are read from the TSC.
+    if (!tick_nohz_active())
+        atomic_inc(&jiffies);
 }
 
 jiffies_t jiffies_get(void) {
+    if (tick_nohz_active())
+        return (jiffies_t)tsc_jiffies();
     return (jiffies_t)atomic_read(&jiffies);
 }
 
@@ -30,33 +37,43 @@ void jiffies_timed_wait(double s) {
     while (time_before(jiffies_get(), jiffy));
 }
 
+static void jiffies_sleep_expired(ktimer_t *tm) {
+    jiffies_sleeper_t *js = tm->tm_arg;
+
+    spin_lock(&js->js_lock);
+    js->js_expired = 1;
+    sched_wake1(&js->js_queue);
+    spin_unlock(&js->js_lock);
+}
+
 jiffies_t jiffies_sleep(jiffies_t jiffy) {
-    jiffies_t now = 0;
-    jiffy += jiffies_get();
-    while (time_before((now = jiffies_get()), jiffy)) {
+    int                 err = 0;
+    jiffies_t           now = 0;
+    jiffies_sleeper_t   js  = {0};
+
+    now    = jiffies_get();
+    jiffy += now;
+    if (!time_before(now, jiffy))
+        return 0;
+
+    js.js_lock  = SPINLOCK_INIT();
+    js.js_queue = QUEUE_INIT();
+    js.js_timer = KTIMER_INIT(jiffies_sleep_expired, &js);
+    ktimer_add(&js.js_timer, jiffy);
+
+    spin_lock(&js.js_lock);
+    while (!js.js_expired) {
         current_lock();
-        if ((sched_sleep(sleep_queue, T_ISLEEP, NULL))) {
-            current_unlock();
-            break;
-        }
+        err = sched_sleep(&js.js_queue, T_ISLEEP, &js.js_lock);
         current_unlock();
+        if (err)
+            break;
     }
-    return jiffy - now;
-}
+    spin_unlock(&js.js_lock);
 
-int jiffies_getres(struct timespec *res) {
-    if (!res)
-        return -EINVAL;
-    spin_lock(res_lock);
-    *res = jiffies_res;
-    spin_unlock(res_lock);
-    return 0;
-}
+    // 'js' lives on our stack, the timer must be done with it.
+    ktimer_del_sync(&js.js_timer);
 
-int jiffies_gettime(struct timespec *tp __unused) {
-    return -ENOSYS;
+    now = jiffies_get();
+    return time_before(now, jiffy) ? jiffy - now : 0;
 }
-
-int jiffies_settime(const struct timespec *tp __unused) {
-    return -ENOSYS;
-}
\ No newline at end of file
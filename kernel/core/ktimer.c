@@ -0,0 +1,192 @@
+#include <arch/cpu.h>
+#include <ginger/ktimer.h>
+#include <ginger/tick.h>
+#include <sync/atomic.h>
+#include <sync/preempt.h>
+
+typedef struct ktimer_base {
+    spinlock_t  tb_lock;
+    jiffies_t   tb_clk;                                     // next jiffy to be run.
+    size_t      tb_npending;                                // timers armed on this base.
+    ktimer_t    *tb_running;                                // timer whose tm_func is running.
+    ktimer_t    *tb_tv1[KTIMER_TVR_SIZE];                   // one slot per jiffy.
+    ktimer_t    *tb_tvn[KTIMER_NLEVELS][KTIMER_TVN_SIZE];   // coarser levels.
+} __aligned(64) ktimer_base_t;
+
+static ktimer_base_t ktimer_bases[MAXNCPU];
+
+#define ktimer_base_lock(b)     ({ spin_lock(&(b)->tb_lock); })
+#define ktimer_base_unlock(b)   ({ spin_unlock(&(b)->tb_lock); })
+
+// index in level 'n' of the coarser levels at which 'j' falls.
+#define ktimer_tvn_index(j, n)  (((j) >> (KTIMER_TVR_BITS + (n) * KTIMER_TVN_BITS)) & KTIMER_TVN_MASK)
+
+static void ktimer_link(ktimer_t **slot, ktimer_t *tm) {
+    if ((tm->tm_next = *slot))
+        tm->tm_next->tm_pprev = &tm->tm_next;
+    tm->tm_pprev = slot;
+    *slot = tm;
+}
+
+static void ktimer_unlink(ktimer_t *tm) {
+    if ((*tm->tm_pprev = tm->tm_next))
+        tm->tm_next->tm_pprev = tm->tm_pprev;
+    tm->tm_next  = NULL;
+    tm->tm_pprev = NULL;
+}
+
+// put 'tm' in the slot covering its expiry. Called with the base locked.
+static void ktimer_enqueue(ktimer_base_t *base, ktimer_t *tm) {
+    jiffies_t   expires = tm->tm_expires;
+    long        delta   = (long)(expires - base->tb_clk);
+
+    if (delta < 0) {
+        ktimer_link(&base->tb_tv1[base->tb_clk & KTIMER_TVR_MASK], tm);
+        return;
+    }
+
+    if (delta < KTIMER_TVR_SIZE) {
+        ktimer_link(&base->tb_tv1[expires & KTIMER_TVR_MASK], tm);
+        return;
+    }
+
+    if ((unsigned long)delta > KTIMER_MAX_DELTA) {
+        delta   = KTIMER_MAX_DELTA;
+        expires = base->tb_clk + delta;
+    }
+
+    for (int n = 0; n < KTIMER_NLEVELS; ++n) {
+        if ((unsigned long)delta < (1ul << (KTIMER_TVR_BITS + (n + 1) * KTIMER_TVN_BITS))) {
+            ktimer_link(&base->tb_tvn[n][ktimer_tvn_index(expires, n)], tm);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief move the timers of slot 'index' in level 'n' down the wheel.
+ * @return int 'index', zero means level 'n' wrapped around too.
+ */
+static int ktimer_cascade(ktimer_base_t *base, int n, int index) {
+    ktimer_t *list = base->tb_tvn[n][index];
+    ktimer_t *next = NULL;
+
+    base->tb_tvn[n][index] = NULL;
+    for (ktimer_t *tm = list; tm; tm = next) {
+        next = tm->tm_next;
+        ktimer_enqueue(base, tm);
+    }
+    return index;
+}
+
+void ktimer_run(void) {
+    int             index   = 0;
+    jiffies_t       now     = 0;
+    ktimer_t        *list   = NULL;
+    ktimer_t        *tm     = NULL;
+    ktimer_base_t   *base   = NULL;
+
+    pushcli();
+    base = &ktimer_bases[cpu->apicID];
+    now  = jiffies_get();
+
+    ktimer_base_lock(base);
+    while (base->tb_npending && time_after_eq(now, base->tb_clk)) {
+        index = base->tb_clk & KTIMER_TVR_MASK;
+
+        if (index == 0) {
+            for (int n = 0; n < KTIMER_NLEVELS; ++n) {
+                if (ktimer_cascade(base, n, ktimer_tvn_index(base->tb_clk, n)))
+                    break;
+            }
+        }
+        base->tb_clk++;
+
+        // ktimer_del() may unlink timers from 'list' while the base is unlocked.
+        if ((list = base->tb_tv1[index]))
+            list->tm_pprev = &list;
+        base->tb_tv1[index] = NULL;
+
+        while ((tm = list)) {
+            ktimer_unlink(tm);
+            atomic_write(&tm->tm_base, NULL);
+            base->tb_npending--;
+            atomic_write(&base->tb_running, tm);
+            ktimer_base_unlock(base);
+
+            tm->tm_func(tm);
+
+            ktimer_base_lock(base);
+            atomic_write(&base->tb_running, NULL);
+        }
+    }
+
+    // nothing armed, the clock catches up on the next ktimer_add().
+    if (base->tb_npending == 0)
+        base->tb_clk = now + 1;
+    ktimer_base_unlock(base);
+    popcli();
+}
+
+int ktimer_del(ktimer_t *tm) {
+    ktimer_base_t *base = NULL;
+
+    // a timer moves between bases only while disarmed, recheck once locked.
+    while ((base = atomic_read(&tm->tm_base))) {
+        ktimer_base_lock(base);
+        if (tm->tm_base == base) {
+            ktimer_unlink(tm);
+            atomic_write(&tm->tm_base, NULL);
+            base->tb_npending--;
+            ktimer_base_unlock(base);
+            return 1;
+        }
+        ktimer_base_unlock(base);
+    }
+    return 0;
+}
+
+int ktimer_del_sync(ktimer_t *tm) {
+    int pending = ktimer_del(tm);
+
+    for (int i = 0; i < MAXNCPU; ++i) {
+        while (atomic_read(&ktimer_bases[i].tb_running) == tm)
+            cpu_pause();
+    }
+    return pending;
+}
+
+int ktimer_add(ktimer_t *tm, jiffies_t expires) {
+    int             pending = 0;
+    ktimer_base_t   *base   = NULL;
+
+    pending = ktimer_del(tm);
+
+    pushcli();
+    base = &ktimer_bases[cpu->apicID];
+    ktimer_base_lock(base);
+
+    // the wheel doesn't turn while empty, bring it to now first.
+    if (base->tb_npending == 0)
+        base->tb_clk = jiffies_get();
+
+    tm->tm_expires = expires;
+    ktimer_enqueue(base, tm);
+    atomic_write(&tm->tm_base, base);
+    base->tb_npending++;
+    ktimer_base_unlock(base);
+
+    // make sure the tick runs on this CPU.
+    tick_program();
+    popcli();
+    return pending;
+}
+
+int ktimer_cpu_pending(void) {
+    int pending = 0;
+
+    pushcli();
+    pending = atomic_read(&ktimer_bases[cpu->apicID].tb_npending) != 0;
+    popcli();
+    return pending;
+}
@@ -5,30 +5,6 @@
 #include <lib/types.h>
 #include <sync/atomic.h>
 
-int copy_to_user(void *udst, void *ksrc, size_t size) {
-    if (udst == NULL || ksrc == NULL)
-        return -EFAULT;
-    if (size == 0)
-        return -ERANGE;
-
-    if (memcpy(udst, ksrc, size) != udst)
-        return -EINVAL;
-    return 0;
-}
-
-int copy_from_user(void *kdst, void * usrc, size_t size) {
-    if (kdst == NULL || usrc == NULL)
-        return -EFAULT;
-
-    if (size == 0)
-        return -ERANGE;
-
-    if (memcpy(kdst, usrc, size) != kdst)
-        return -EINVAL;
-
-    return 0;
-}
-
 void swapi64(i64 *a0, i64 *a1) {
     i64 tmp = 0;
     assert(a0 && a1, "Invalid arguments");
@@ -0,0 +1,136 @@
+#include <arch/cpu.h>
+#include <arch/lapic.h>
+#include <arch/traps.h>
+#include <arch/tsc.h>
+#include <ginger/hrtimer.h>
+#include <ginger/jiffies.h>
+#include <ginger/ktimer.h>
+#include <ginger/tick.h>
+#include <lib/string.h>
+#include <sync/atomic.h>
+#include <sync/preempt.h>
+#include <sync/rcu.h>
+#include <sys/sched.h>
+#include <sys/thread.h>
+
+static atomic_t nohz        = 0;
+
+int tick_nohz_active(void) {
+    return atomic_read(&nohz);
+}
+
+void tick_init(void) {
+    if (isbsp() && cpu_has(CPU_TSC) && tsc_freq())
+        atomic_write(&nohz, 1);
+
+    if (!tick_nohz_active())
+        return;
+
+    memset(&cpu->tick, 0, sizeof cpu->tick);
+    // the tick stays stopped until schedule() has something to time.
+    lapic_timer_stop();
+}
+
+void tick_start_slice(long timeslice) {
+    if (!tick_nohz_active())
+        return;
+    pushcli();
+    atomic_write(&cpu->tick.t_slice_end, jiffies_get() + (timeslice > 0 ? timeslice : 1));
+    atomic_write(&cpu->tick.t_slice_inf, timeslice >= TICK_SLICE_INFINITE);
+    popcli();
+}
+
+void tick_program(void) {
+    int         armed   = 0;
+    u64         hrnext  = 0;
+    u64         deadline= 0;
+    jiffies_t   now     = 0;
+    jiffies_t   next    = 0;
+    tick_t      *tick   = NULL;
+
+    if (!tick_nohz_active())
+        return;
+
+    pushcli();
+    tick    = &cpu->tick;
+    now     = jiffies_get();
+
+    // only time current's slice if someone else is waiting for this CPU,
+    // and it ends at all.
+    if (current && sched_nready(cpu) && !atomic_read(&tick->t_slice_inf)) {
+        next  = atomic_read(&tick->t_slice_end);
+        armed = 1;
+    }
+
+    // keep ticking for this CPU's timers, and while RCU is waiting on it.
+    if ((ktimer_cpu_pending() || rcu_pending()) &&
+        (!armed || time_after(next, now + 1))) {
+        next  = now + 1;
+        armed = 1;
+    }
+
+    if (armed)
+        deadline = tsc_from_jiffies(next);
+
+    // high-resolution timers fire at their own expiry, not on a jiffy.
+    if (hrtimer_cpu_next(&hrnext) && (!armed || tsc_from_ns(hrnext) < deadline)) {
+        deadline = tsc_from_ns(hrnext);
+        armed    = 1;
+    }
+
+    tick->t_next  = next;
+    tick->t_armed = armed;
+    if (armed) // a deadline already in the past fires right away.
+        lapic_timer_oneshot(deadline);
+    else
+        lapic_timer_stop();
+    popcli();
+}
+
+void tick_handler(void) {
+    jiffies_t now = 0;
+
+    jiffies_update();
+    ktimer_run();
+    hrtimer_run();
+
+    if (current) {
+        now = jiffies_get();
+        current_lock();
+        current->t_sched.ts_timeslice = (long)(atomic_read(&cpu->tick.t_slice_end) - now);
+        current_unlock();
+    }
+
+    tick_program();
+}
+
+void tick_kick(cpu_t *processor) {
+    if (!tick_nohz_active())
+        return;
+
+    if (processor == NULL) {
+        lapic_send_ipi(SCHED_IPI, IPI_ALLXSELF);
+        tick_program();
+    } else if (processor == cpu)
+        tick_program();
+    else
+        lapic_send_ipi(SCHED_IPI, processor->apicID);
+}
+
+void tick_preempt(cpu_t *processor) {
+    thread_t *running = NULL;
+
+    if (processor == NULL)
+        return;
+
+    if ((running = atomic_read(&processor->thread)))
+        atomic_write(&running->t_sched.ts_timeslice, 0);
+
+    if (!tick_nohz_active())
+        return;
+
+    // expire the slice so the tick handler doesn't hand out a fresh one.
+    atomic_write(&processor->tick.t_slice_inf, 0);
+    atomic_write(&processor->tick.t_slice_end, 0);
+    tick_kick(processor);
+}
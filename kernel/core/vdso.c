@@ -0,0 +1,169 @@
+#include <arch/cpu.h>
+#include <arch/paging.h>
+#include <arch/tsc.h>
+#include <bits/errno.h>
+#include <ginger/clocksource.h>
+#include <ginger/vdso.h>
+#include <lib/stddef.h>
+#include <lib/string.h>
+#include <mm/mmap.h>
+#include <mm/pmm.h>
+#include <mm/vmm.h>
+#include <sync/atomic.h>
+#include <sys/system.h>
+
+// vdso.asm hardcodes these.
+_Static_assert(offsetof(vdso_data_t, vd_seq)        == 0,   "vdso_data_t layout");
+_Static_assert(offsetof(vdso_data_t, vd_flags)      == 4,   "vdso_data_t layout");
+_Static_assert(offsetof(vdso_data_t, vd_cycles)     == 8,   "vdso_data_t layout");
+_Static_assert(offsetof(vdso_data_t, vd_base)       == 16,  "vdso_data_t layout");
+_Static_assert(offsetof(vdso_data_t, vd_mult)       == 24,  "vdso_data_t layout");
+_Static_assert(offsetof(vdso_data_t, vd_realtime)   == 32,  "vdso_data_t layout");
+_Static_assert(offsetof(vdso_data_t, vd_tsc_offset) == 40,  "vdso_data_t layout");
+_Static_assert(offsetof(vdso_data_t, vd_cpu)        == 192, "vdso_data_t layout");
+_Static_assert(sizeof(vdso_cpu_t) == 64 && MAXNCPU == 16,   "vdso_cpu_t layout");
+_Static_assert(sizeof(vdso_data_t) <= PAGESZ,               "vdso_data_t too large");
+
+// the code of the text page, see vdso.asm.
+extern char vdso_start[];
+extern char vdso_end[];
+
+static vdso_data_t  *vdso_data  = NULL;     // kernel mapping of the data page.
+static uintptr_t    vdso_pdata  = 0;        // physical address of the data page.
+static uintptr_t    vdso_ptext  = 0;        // physical address of the text page.
+
+static int vdso_fault(vmr_t *vmr, vm_fault_t *fault) {
+    // both pages are read-only.
+    if (fault->err_code & PTE_W)
+        return -EACCES;
+    return arch_map_i(PGROUND(fault->addr), vmr->paddr, PGSZ, vmr->vflags);
+}
+
+static vmr_ops_t vdso_vmrops = {
+    .fault = vdso_fault,
+};
+
+// allocate a zeroed page, mapped at *'pv'.
+static int vdso_page(uintptr_t *pp, uintptr_t *pv) {
+    int         err = 0;
+    uintptr_t   v   = 0;
+    uintptr_t   p   = 0;
+
+    if ((p = pmman.alloc()) == 0)
+        return -ENOMEM;
+
+    if ((v = vmman.alloc(PGSZ)) == 0) {
+        err = -ENOMEM;
+        goto error;
+    }
+
+    if ((err = arch_map_i(v, p, PGSZ, PTE_KRW)))
+        goto error;
+
+    memset((void *)v, 0, PGSZ);
+    *pp = p;
+    *pv = v;
+    return 0;
+error:
+    if (v)
+        vmman.free(v);
+    pmman.free(p);
+    return err;
+}
+
+int vdso_init(void) {
+    int         err     = 0;
+    uintptr_t   data    = 0;
+    uintptr_t   text    = 0;
+
+    if ((err = vdso_page(&vdso_ptext, &text)))
+        return err;
+    memcpy((void *)text, vdso_start, vdso_end - vdso_start);
+    // the frame isn't freed along, it wasn't allocated by the mapping.
+    arch_pagefree(text, PGSZ);
+
+    if ((err = vdso_page(&vdso_pdata, &data)))
+        return err;
+
+    if (tsc_has_rdtscp())
+        ((vdso_data_t *)data)->vd_flags = VDSO_GETCPU;
+    atomic_write(&vdso_data, (vdso_data_t *)data);
+
+    // pick up what was published before we had a page for it.
+    clocksource_vdso_sync();
+    return 0;
+}
+
+static int vdso_map_page(mmap_t *mmap, uintptr_t addr, uintptr_t paddr, int prot) {
+    int     err = 0;
+    vmr_t   *vmr= NULL;
+
+    if ((err = mmap_map_region(mmap, addr, PGSZ, prot,
+        MAP_PRIVATE | MAP_DONTEXPAND | MAP_FIXED, &vmr)))
+        return err;
+
+    vmr->paddr = paddr;
+    vmr->vmops = &vdso_vmrops;
+    return 0;
+}
+
+int vdso_map(mmap_t *mmap) {
+    int err = 0;
+
+    mmap_assert_locked(mmap);
+
+    // user mode calls into the text page unconditionally.
+    if (atomic_read(&vdso_data) == NULL)
+        return -ENOENT;
+
+    if ((err = vdso_map_page(mmap, VDSO_DATA, vdso_pdata, PROT_R)))
+        return err;
+    return vdso_map_page(mmap, VDSO_TEXT, vdso_ptext, PROT_R | PROT_X);
+}
+
+void vdso_update_clock(int user, u64 cycles, u64 base, u64 mult) {
+    vdso_data_t *vd = atomic_read(&vdso_data);
+
+    if (vd == NULL)
+        return;
+
+    // a locked RMW is a full barrier, see write_seqcount_begin().
+    atomic_inc(&vd->vd_seq);
+    vd->vd_cycles = cycles;
+    vd->vd_base   = base;
+    vd->vd_mult   = mult;
+    vd->vd_flags  = user ? vd->vd_flags | VDSO_CLOCK : vd->vd_flags & ~VDSO_CLOCK;
+    atomic_inc(&vd->vd_seq);
+}
+
+void vdso_update_realtime(u64 offset) {
+    vdso_data_t *vd = atomic_read(&vdso_data);
+
+    // a single aligned store, readers need no retry for it.
+    if (vd)
+        atomic_write(&vd->vd_realtime, offset);
+}
+
+void vdso_update_tsc_offset(int cpuid, u64 offset) {
+    vdso_data_t *vd = atomic_read(&vdso_data);
+
+    if (vd && cpuid >= 0 && cpuid < MAXNCPU)
+        atomic_write(&vd->vd_tsc_offset[cpuid], offset);
+}
+
+void vdso_switch(pid_t pid, tid_t tid) {
+    vdso_cpu_t  *vc = NULL;
+    vdso_data_t *vd = atomic_read(&vdso_data);
+
+    if (vd == NULL)
+        return;
+
+    // only this CPU writes its slot, ordered stores are enough on x86_64.
+    vc = &vd->vd_cpu[cpu->apicID];
+    vc->vc_seq++;
+    barrier();
+    vc->vc_pid = pid;
+    vc->vc_tid = tid;
+    barrier();
+    vc->vc_seq++;
+}
@@ -189,7 +189,7 @@ static int ramdisk_getinfo(struct devid *dd, void *info) {
 }
 
 static dev_t ramdiskdev = (dev_t) {
-    .devlock = {0},
+    .devlock = {.s_apicid = -1},
     .devname = "ramdisk",
     .devprobe = NULL,
     .devmount = ramdisk_mount,
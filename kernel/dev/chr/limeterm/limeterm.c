@@ -12,7 +12,7 @@
 #include <lib/string.h>
 #include <lib/stdint.h>
 #include <lib/nanojpeg.h>
-#include <dev/clocks.h>
+#include <ginger/ktimer.h>
 #include <boot/boot.h>
 #include <ds/stack.h>
 #include <video/color_code.h>
@@ -45,8 +45,8 @@ typedef struct limeterm_ctx {
 } limeterm_ctx_t;
 
 limeterm_ctx_t      ctx;
-timeval_t           tv                  = {0};
-static   clockid_t  limeterm_clkid      = 0;
+static void limeterm_blink(ktimer_t *tm);
+static   ktimer_t   limeterm_cursor     = KTIMER_INIT(limeterm_blink, NULL);
 static   int        cbufi               = 0;
 static   char       cbuf[PGSZ]          = {0};
 inode_t             *limeterm           = NULL;
@@ -144,17 +144,7 @@ int limeterm_init(void) {
     use_limeterm_cons = 1;
     limeterm_clrscrn();
 
-    tv.tv_sec  = 0;
-    tv.tv_usec = ctx.cursor_timeout;
-
-    err = clock_set(&tv,
-        (void *)limeterm_drawcursor,
-        NULL,
-        CLK_RESET,
-        &limeterm_clkid
-    );
-
-    assert(err == 0, "Failed to set clock\n");
+    ktimer_add(&limeterm_cursor, jiffies_get() + us_TO_jiffies(ctx.cursor_timeout));
 
     printk(cbuf);
     return 0;
@@ -447,6 +437,12 @@ size_t limeterm_puts(const char *s) {
     return S - s;
 }
 
+// cursor blink timer, rearms itself every cursor_timeout.
+static void limeterm_blink(ktimer_t *tm) {
+    limeterm_drawcursor();
+    ktimer_add(tm, jiffies_get() + us_TO_jiffies(ctx.cursor_timeout));
+}
+
 void limeterm_drawcursor(void) {
     static u8 cursor = ' ', next = '\0';
 
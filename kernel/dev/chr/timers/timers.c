@@ -5,15 +5,20 @@
 #include <ginger/jiffies.h>
 #include <sync/atomic.h>
 #include <dev/clocks.h>
+#include <ginger/tick.h>
 
 static atomic_t hpet_avl = {0};
 
 int timer_init(void) {
     int err = 0;
     printk("Initializing timers...\n");
-    if ((err = hpet_init()))
-        pit_init(); // if failed to initalized HPET use PIT.
-    else
+    if ((err = hpet_init())) {
+        // if failed to initalized HPET use PIT.
+        // In NOHZ mode jiffies come from the TSC and timer events
+        // are driven by the one-shot local APIC timer, so no periodic tick.
+        if (!tick_nohz_active())
+            pit_init();
+    } else
         atomic_write(&hpet_avl, 1);
     printk("Timers initalized successfully.\n");
     return 0;
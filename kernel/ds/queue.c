@@ -2,6 +2,7 @@
 #include <lib/string.h>
 #include <mm/kalloc.h>
 #include <ds/queue.h>
+#include <sync/rcu.h>
 
 int queue_alloc(queue_t **pqp) {
     queue_t *q = NULL;
@@ -109,13 +110,13 @@ int enqueue(queue_t *q, void *data, int unique, queue_node_t **pnp) {
     memset(node, 0, sizeof *node);
 
     node->data = data;
+    node->prev = q->tail;
 
+    // publish the initialized node to RCU readers.
     if (q->head == NULL)
-        q->head = node;
-    else {
-        q->tail->next = node;
-        node->prev = q->tail;
-    }
+        rcu_assign_pointer(q->head, node);
+    else
+        rcu_assign_pointer(q->tail->next, node);
 
     q->tail = node;
     node->queue = q;
@@ -153,7 +154,7 @@ int enqueue_head(queue_t *q, int unique, void *data, queue_node_t **pnp) {
         node->next = q->head;
     }
 
-    q->head = node;
+    rcu_assign_pointer(q->head, node);
     node->queue = q;
     q->q_count++;
 
@@ -254,6 +255,41 @@ int queue_remove(queue_t *q, void *data) {
     return -ENOENT;
 }
 
+static void queue_node_free_rcu(rcu_head_t *head) {
+    kfree(container_of(head, queue_node_t, rcu));
+}
+
+int queue_remove_rcu(queue_t *q, void *data) {
+    queue_node_t *next = NULL, *prev = NULL;
+    queue_assert_locked(q);
+
+    if (q == NULL)
+        return -EINVAL;
+
+    forlinked(node, q->head, next) {
+        next = node->next;
+        prev = node->prev;
+        if (node->data == data) {
+            // readers on 'node' still see the rest of the queue through 'node->next'.
+            if (prev)
+                atomic_store_release(&prev->next, next);
+            if (next)
+                next->prev = prev;
+            if (node == q->head)
+                atomic_store_release(&q->head, next);
+            if (node == q->tail)
+                q->tail = prev;
+
+            q->q_count--;
+            node->queue = NULL;
+            call_rcu(&node->rcu, queue_node_free_rcu);
+            return 0;
+        }
+    }
+
+    return -ENOENT;
+}
+
 int dequeue_tail(queue_t *q, void **pdp) {
     queue_node_t *next = NULL, *node = NULL, *prev = NULL;
 
@@ -0,0 +1,236 @@
+#include <ds/rbtree.h>
+
+#define rb_isred(n)     ((n) && (n)->rb_color == RB_RED)
+#define rb_isblack(n)   (!rb_isred(n))
+
+// make 'new' take the place of 'old' under old's parent.
+static void rb_replace_child(rb_root_t *root, rb_node_t *old, rb_node_t *new) {
+    rb_node_t *parent = old->rb_parent;
+
+    if (parent == NULL)
+        root->rb_node = new;
+    else if (parent->rb_left == old)
+        parent->rb_left = new;
+    else
+        parent->rb_right = new;
+
+    if (new)
+        new->rb_parent = parent;
+}
+
+static void rb_rotate_left(rb_root_t *root, rb_node_t *x) {
+    rb_node_t *y = x->rb_right;
+
+    if ((x->rb_right = y->rb_left))
+        y->rb_left->rb_parent = x;
+    rb_replace_child(root, x, y);
+    y->rb_left   = x;
+    x->rb_parent = y;
+}
+
+static void rb_rotate_right(rb_root_t *root, rb_node_t *x) {
+    rb_node_t *y = x->rb_left;
+
+    if ((x->rb_left = y->rb_right))
+        y->rb_right->rb_parent = x;
+    rb_replace_child(root, x, y);
+    y->rb_right  = x;
+    x->rb_parent = y;
+}
+
+static void rb_insert_fixup(rb_root_t *root, rb_node_t *z) {
+    rb_node_t *p = NULL;
+    rb_node_t *g = NULL;
+    rb_node_t *u = NULL;
+
+    while ((p = z->rb_parent) && p->rb_color == RB_RED) {
+        // a red parent is never the root.
+        g = p->rb_parent;
+
+        if (p == g->rb_left) {
+            if (rb_isred((u = g->rb_right))) {
+                p->rb_color = u->rb_color = RB_BLACK;
+                g->rb_color = RB_RED;
+                z = g;
+                continue;
+            }
+
+            if (z == p->rb_right) {
+                rb_rotate_left(root, p);
+                z = p;
+                p = z->rb_parent;
+            }
+            p->rb_color = RB_BLACK;
+            g->rb_color = RB_RED;
+            rb_rotate_right(root, g);
+        } else {
+            if (rb_isred((u = g->rb_left))) {
+                p->rb_color = u->rb_color = RB_BLACK;
+                g->rb_color = RB_RED;
+                z = g;
+                continue;
+            }
+
+            if (z == p->rb_left) {
+                rb_rotate_right(root, p);
+                z = p;
+                p = z->rb_parent;
+            }
+            p->rb_color = RB_BLACK;
+            g->rb_color = RB_RED;
+            rb_rotate_left(root, g);
+        }
+    }
+
+    root->rb_node->rb_color = RB_BLACK;
+}
+
+void rb_insert(rb_root_t *root, rb_node_t *node,
+    int (*less)(const rb_node_t *a, const rb_node_t *b)) {
+    int         leftmost    = 1;
+    rb_node_t   *parent     = NULL;
+    rb_node_t   **link      = &root->rb_node;
+
+    while (*link) {
+        parent = *link;
+        if (less(node, parent))
+            link = &parent->rb_left;
+        else {
+            link     = &parent->rb_right;
+            leftmost = 0;
+        }
+    }
+
+    node->rb_parent = parent;
+    node->rb_left   = NULL;
+    node->rb_right  = NULL;
+    node->rb_color  = RB_RED;
+    *link           = node;
+
+    if (leftmost)
+        root->rb_leftmost = node;
+
+    rb_insert_fixup(root, node);
+}
+
+// restore the black height after removing a black node from above 'x'.
+static void rb_erase_fixup(rb_root_t *root, rb_node_t *x, rb_node_t *parent) {
+    rb_node_t *w = NULL;
+
+    while (x != root->rb_node && rb_isblack(x)) {
+        // 'x' lacks a black node, so its sibling can't be NULL.
+        if (x == parent->rb_left) {
+            w = parent->rb_right;
+            if (rb_isred(w)) {
+                w->rb_color      = RB_BLACK;
+                parent->rb_color = RB_RED;
+                rb_rotate_left(root, parent);
+                w = parent->rb_right;
+            }
+
+            if (rb_isblack(w->rb_left) && rb_isblack(w->rb_right)) {
+                w->rb_color = RB_RED;
+                x           = parent;
+                parent      = x->rb_parent;
+                continue;
+            }
+
+            if (rb_isblack(w->rb_right)) {
+                w->rb_left->rb_color = RB_BLACK;
+                w->rb_color          = RB_RED;
+                rb_rotate_right(root, w);
+                w = parent->rb_right;
+            }
+            w->rb_color             = parent->rb_color;
+            parent->rb_color        = RB_BLACK;
+            w->rb_right->rb_color   = RB_BLACK;
+            rb_rotate_left(root, parent);
+            x = root->rb_node;
+        } else {
+            w = parent->rb_left;
+            if (rb_isred(w)) {
+                w->rb_color      = RB_BLACK;
+                parent->rb_color = RB_RED;
+                rb_rotate_right(root, parent);
+                w = parent->rb_left;
+            }
+
+            if (rb_isblack(w->rb_left) && rb_isblack(w->rb_right)) {
+                w->rb_color = RB_RED;
+                x           = parent;
+                parent      = x->rb_parent;
+                continue;
+            }
+
+            if (rb_isblack(w->rb_left)) {
+                w->rb_right->rb_color = RB_BLACK;
+                w->rb_color           = RB_RED;
+                rb_rotate_left(root, w);
+                w = parent->rb_left;
+            }
+            w->rb_color             = parent->rb_color;
+            parent->rb_color        = RB_BLACK;
+            w->rb_left->rb_color    = RB_BLACK;
+            rb_rotate_right(root, parent);
+            x = root->rb_node;
+        }
+    }
+
+    if (x)
+        x->rb_color = RB_BLACK;
+}
+
+void rb_erase(rb_root_t *root, rb_node_t *z) {
+    int         color   = z->rb_color;
+    rb_node_t   *x      = NULL;
+    rb_node_t   *y      = NULL;
+    rb_node_t   *parent = NULL;
+
+    if (root->rb_leftmost == z)
+        root->rb_leftmost = rb_next(z);
+
+    if (z->rb_left == NULL || z->rb_right == NULL) {
+        x      = z->rb_left ? z->rb_left : z->rb_right;
+        parent = z->rb_parent;
+        rb_replace_child(root, z, x);
+    } else {
+        // 'z' has two children, its successor takes its place.
+        for (y = z->rb_right; y->rb_left; y = y->rb_left);
+        color = y->rb_color;
+        x     = y->rb_right;
+
+        if (y->rb_parent == z)
+            parent = y;
+        else {
+            parent = y->rb_parent;
+            rb_replace_child(root, y, x);
+            y->rb_right            = z->rb_right;
+            y->rb_right->rb_parent = y;
+        }
+
+        rb_replace_child(root, z, y);
+        y->rb_left            = z->rb_left;
+        y->rb_left->rb_parent = y;
+        y->rb_color           = z->rb_color;
+    }
+
+    if (color == RB_BLACK)
+        rb_erase_fixup(root, x, parent);
+
+    z->rb_parent = NULL;
+    z->rb_left   = NULL;
+    z->rb_right  = NULL;
+}
+
+rb_node_t *rb_next(const rb_node_t *node) {
+    rb_node_t *parent = NULL;
+
+    if (node->rb_right) {
+        for (node = node->rb_right; node->rb_left; node = node->rb_left);
+        return (rb_node_t *)node;
+    }
+
+    while ((parent = node->rb_parent) && node == parent->rb_right)
+        node = parent;
+    return parent;
+}
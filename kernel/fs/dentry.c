@@ -4,6 +4,7 @@
 #include <lib/string.h>
 #include <mm/kalloc.h>
 #include <fs/path.h>
+#include <sync/rcu.h>
 
 
 void ddump(dentry_t *dp, int flags) {
@@ -84,6 +85,14 @@ error:
     return err;
 }
 
+static void dfree_rcu(rcu_head_t *head) {
+    dentry_t *dp = container_of(head, dentry_t, d_rcu);
+
+    if (dp->d_name)
+        kfree(dp->d_name);
+    kfree(dp);
+}
+
 void dfree(dentry_t *dp) {
     dassert_locked(dp);
     dunbind(dp);
@@ -94,11 +103,9 @@ void dfree(dentry_t *dp) {
         idel_alias(dp->d_inode, dp);
     }
 
-    if (dp->d_name)
-        kfree(dp->d_name);
-
     dunlock(dp);
-    kfree(dp);
+    // dlookup() may still be comparing against d_name.
+    call_rcu(&dp->d_rcu, dfree_rcu);
 }
 
 void dunbind(dentry_t *dp) {
@@ -111,6 +118,10 @@ void dunbind(dentry_t *dp) {
     prev = dp->d_prev;
     d_parent = dp->d_parent;
 
+    // already unbound, d_next is stale and only kept for dlookup().
+    if (d_parent == NULL)
+        return;
+
     if (prev) {
         dlock(prev);
         prev->d_next = next;
@@ -132,7 +143,7 @@ void dunbind(dentry_t *dp) {
             dunlock(prev);
         }
         dunlock(next);
-        dp->d_next = NULL;
+        // d_next is left as is, for dlookup() walking past us.
     }
 
     if (d_parent) {
@@ -174,8 +185,12 @@ int dbind(dentry_t *d_parent, dentry_t *d_child) {
         dunlock(node);
     }
 
+    // initialize d_child before it is published to dlookup().
+    d_child->d_next = NULL;
+    d_child->d_parent = d_parent;
+
     if (d_parent->d_child == NULL) {
-        d_parent->d_child = d_child;
+        rcu_assign_pointer(d_parent->d_child, d_child);
         goto done;
     }
 
@@ -188,11 +203,9 @@ int dbind(dentry_t *d_parent, dentry_t *d_child) {
     }
 
     d_child->d_prev = d_last;
-    d_last->d_next = d_child;
+    rcu_assign_pointer(d_last->d_next, d_child);
     dunlock(d_last);
 done:
-    d_child->d_next = NULL;
-    d_child->d_parent = d_parent;
     // dsetflags(d_parent, DCACHE_REFERENCED);
     return 0;
 }
@@ -208,7 +221,7 @@ void dclose(dentry_t *dp) {
 }
 
 int dlookup(dentry_t *d_parent, const char *name, dentry_t **pchild) {
-    dentry_t *dp = NULL, *d_next = NULL;
+    dentry_t *dp = NULL;
 
     dassert_locked(d_parent);
 
@@ -227,15 +240,25 @@ int dlookup(dentry_t *d_parent, const char *name, dentry_t **pchild) {
         goto done;
     }
 
-    forlinked(dentry, d_parent->d_child, d_next) {
+    /**
+     * Siblings are walked under rcu_read_lock() and only the match is locked.
+     * Names never change and dentries are freed after a grace period,
+     * a match unbound meanwhile is told apart by its d_parent.
+     */
+    rcu_read_lock();
+    forlinked(dentry, rcu_dereference(d_parent->d_child), rcu_dereference(dentry->d_next)) {
+        if (compare_strings(dentry->d_name, name))
+            continue;
+
         dlock(dentry);
-        d_next = dentry->d_next;
-        if (!compare_strings(dentry->d_name, name)) {
+        if (dentry->d_parent == d_parent) {
             dopen((dp = dentry));
+            rcu_read_unlock();
             goto done;
         }
         dunlock(dentry);
     }
+    rcu_read_unlock();
 
     return -ENOENT;
 done:
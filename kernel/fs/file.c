@@ -565,6 +565,82 @@ ssize_t fwrite(file_t *file, void *buf, size_t size) {
     return retval;
 }
 
+// files with their own ops get the buffers one at a time.
+static ssize_t fops_iov(file_t *file, const struct iovec *iov, int iovcnt,
+    ssize_t (*op)(file_t *file, void *buf, size_t size)) {
+    ssize_t err     = 0;
+    ssize_t total   = 0;
+
+    if ((err = iov_length(iov, iovcnt)) < 0)
+        return err;
+
+    for (int i = 0; i < iovcnt; ++i) {
+        if ((err = op(file, iov[i].iov_base, iov[i].iov_len)) < 0)
+            return total ? total : err;
+        total += err;
+        if ((size_t)err < iov[i].iov_len)
+            break;
+    }
+    return total;
+}
+
+/**
+ * @brief the vector is transferred under one file and inode lock,
+ * at the file offset, which moves past what was transferred.
+ */
+static ssize_t frwv(file_t *file, const struct iovec *iov, int iovcnt, int write) {
+    ssize_t retval = 0;
+    inode_t *inode = NULL;
+
+    fassert_locked(file);
+
+    if (file->fops != NULL) {
+        if (write && file->fops->fwrite)
+            return fops_iov(file, iov, iovcnt, file->fops->fwrite);
+        if (!write && file->fops->fread)
+            return fops_iov(file, iov, iovcnt, file->fops->fread);
+    }
+
+    if (file->f_dentry == NULL)
+        return -ENOENT;
+
+    dlock(file->f_dentry);
+    if ((inode = file->f_dentry->d_inode)) {
+        ilock(inode);
+        idupcnt(inode);
+    }
+    dunlock(file->f_dentry);
+
+    if (inode == NULL)
+        return -ENOENT;
+
+    if (write)
+        retval = iwritev(inode, file->f_off, iov, iovcnt);
+    else
+        retval = ireadv(inode, file->f_off, iov, iovcnt);
+
+    if (retval > 0) {
+        file->f_off += retval;
+        // wake whoever waits on the other end.
+        if (write && inode->i_readers)
+            cond_broadcast(inode->i_readers);
+        else if (!write && inode->i_writers)
+            cond_broadcast(inode->i_writers);
+    }
+
+    iputcnt(inode);
+    iunlock(inode);
+    return retval;
+}
+
+ssize_t freadv(file_t *file, const struct iovec *iov, int iovcnt) {
+    return frwv(file, iov, iovcnt, 0);
+}
+
+ssize_t fwritev(file_t *file, const struct iovec *iov, int iovcnt) {
+    return frwv(file, iov, iovcnt, 1);
+}
+
 int     fcreate(file_t *dir, const char *pathname, mode_t mode) {
     int err = 0;
     inode_t *inode = NULL;
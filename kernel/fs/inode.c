@@ -601,6 +601,83 @@ ssize_t iwrite(inode_t *ip, off_t off, void *buf, size_t sz) {
     return retval;
 }
 
+static ssize_t icache_iread(inode_t *ip, off_t off, void *buf, size_t sz) {
+    return icache_read(ip->i_cache, off, buf, sz);
+}
+
+static ssize_t icache_iwrite(inode_t *ip, off_t off, void *buf, size_t sz) {
+    return icache_write(ip->i_cache, off, buf, sz);
+}
+
+/**
+ * @brief walk 'iov' once, handing each run of buffers that are contiguous
+ * in memory to 'io' as one transfer. Stops at the first short transfer
+ * or bad buffer, like a single transfer to the buffers concatenated would.
+ */
+static ssize_t iov_transfer(inode_t *ip, off_t off, const struct iovec *iov, int iovcnt,
+    ssize_t (*io)(inode_t *ip, off_t off, void *buf, size_t sz)) {
+    ssize_t     err     = 0;
+    size_t      total   = 0;
+    size_t      runlen  = 0;
+    char        *run    = NULL;
+
+    if ((err = iov_length(iov, iovcnt)) < 0)
+        return err;
+
+    for (int i = 0; i <= iovcnt; ++i) {
+        if (i < iovcnt) {
+            if (iov[i].iov_len == 0)
+                continue;
+
+            if (run && run + runlen == iov[i].iov_base) {
+                runlen += iov[i].iov_len;
+                continue;
+            }
+        }
+
+        if (runlen) {
+            if ((err = io(ip, off + total, run, runlen)) < 0)
+                return total ? (ssize_t)total : err;
+            total += err;
+            if ((size_t)err < runlen)
+                break;
+        }
+
+        if (i < iovcnt) {
+            run     = iov[i].iov_base;
+            runlen  = iov[i].iov_len;
+        }
+    }
+
+    return total;
+}
+
+ssize_t ireadv(inode_t *ip, off_t off, const struct iovec *iov, int iovcnt) {
+    ssize_t retval = 0;
+
+    iassert_locked(ip);
+    if (ip->i_cache == NULL)
+        return iov_transfer(ip, off, iov, iovcnt, iread_data);
+
+    icache_lock(ip->i_cache);
+    retval = iov_transfer(ip, off, iov, iovcnt, icache_iread);
+    icache_unlock(ip->i_cache);
+    return retval;
+}
+
+ssize_t iwritev(inode_t *ip, off_t off, const struct iovec *iov, int iovcnt) {
+    ssize_t retval = 0;
+
+    iassert_locked(ip);
+    if (ip->i_cache == NULL)
+        return iov_transfer(ip, off, iov, iovcnt, iwrite_data);
+
+    icache_lock(ip->i_cache);
+    retval = iov_transfer(ip, off, iov, iovcnt, icache_iwrite);
+    icache_unlock(ip->i_cache);
+    return retval;
+}
+
 int istat(inode_t *ip, struct stat *buf) {
     if (ip == NULL || buf == NULL)
         return -EINVAL;
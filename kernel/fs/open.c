@@ -54,12 +54,10 @@ int     open(const char *pathname, int oflags, mode_t mode) {
             goto error;
         }
         
+        // 'dentry' is never set before this point, so there is nothing else to unlock.
         if (path) {
             assert(path->directory, "On error, path has no directory\n");
             dclose(path->directory);
-        } else {
-            printk("%s:%d: [Warning...]: is unlocking dentry here safe?\n", __FILE__, __LINE__);
-            dunlock(dentry);
         }
         goto error;
     }
@@ -141,12 +139,10 @@ int     openat(int fd, const char *pathname, int oflags, mode_t mode) {
             goto error;
         }
         
+        // 'dentry' is never set before this point, so there is nothing else to unlock.
         if (path) {
             assert(path->directory, "On error, path has no directory\n");
             dclose(path->directory);
-        } else {
-            printk("%s:%d: [Warning...]: is unlocking dentry here safe?\n", __FILE__, __LINE__);
-            dunlock(dentry);
         }
         goto error;
     }
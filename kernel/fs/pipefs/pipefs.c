@@ -184,6 +184,44 @@ int pipefs_iclose(inode_t *ip) {
     return 0;
 }
 
+int pipe_poll(inode_t *ip, int events) {
+    int             err     = 0;
+    int             ready   = 0;
+    int             isread  = 0;
+    pipe_t          *pipe   = NULL;
+    waitq_entry_t   we      = {0};
+
+    pipe = (pipe_t *)ip->i_priv;
+    pipe_lock(pipe);
+
+    isread = pipe->p_iread == ip;
+    events &= isread ? PIPE_R : PIPE_W;
+    for (;;) {
+        pipe_lockbuf(pipe);
+        if (events & PIPE_R)
+            ready = ringbuf_isempty(pipe_getbuff(pipe)) ? 0 : PIPE_R;
+        else if (events & PIPE_W)
+            ready = ringbuf_isfull(pipe_getbuff(pipe)) ? 0 : PIPE_W;
+        pipe_unlockbuf(pipe);
+
+        if (ready)
+            break;
+
+        if (!pipe_testflags(pipe, isread ? PIPE_W : PIPE_R)) {
+            err = -EPIPE;
+            break;
+        }
+
+        // not exclusive, readers and writers of the pipe aren't held up by us.
+        we = WAITQ_ENTRY(0, isread ? PIPE_R : PIPE_W);
+        if ((err = waitq_wait(&pipe->p_wait, &we, &pipe->p_lock)))
+            break;
+    }
+
+    pipe_unlock(pipe);
+    return err ? err : ready;
+}
+
 int pipefs_iunlink(inode_t *ip __unused) {
     return -ENOSYS;
 }
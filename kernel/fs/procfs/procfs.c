@@ -1,13 +1,102 @@
+#include <arch/cpu.h>
 #include <bits/errno.h>
 #include <fs/fs.h>
 #include <fs/procfs.h>
+#include <fs/stat.h>
 #include <fs/tmpfs.h>
 #include <lib/printk.h>
 #include <lib/string.h>
 #include <mm/kalloc.h>
+#include <sys/proc.h>
+#include <sys/sched.h>
+#include <sys/thread.h>
+#include <sync/lockstat.h>
+#include <sys/systrace.h>
 
 static filesystem_t *procfs = NULL;
 
+// largest text a procfs file can generate.
+#define PROCFS_BUFSZ            KiB(16)
+
+// procfs inode numbers encode the pid and the entry.
+#define PROCFS_INO(pid, e)      (((uintptr_t)(pid) << 8) | (e))
+#define PROCFS_INO_PID(ino)     ((pid_t)((ino) >> 8))
+
+typedef struct procfs_entry {
+    char    *pe_name;                                               // name in its directory.
+    itype_t pe_type;                                                // FS_DIR or FS_RGL.
+    int     pe_perpid;                                              // lives in /proc/<pid>/.
+    ssize_t (*pe_show)(pid_t pid, char *buf, size_t size);          // generate the contents.
+    ssize_t (*pe_write)(pid_t pid, const char *buf, size_t size);   // writable if set(root only).
+    size_t  pe_size;                                                // largest contents, PROCFS_BUFSZ if 0.
+    ssize_t (*pe_read)(pid_t pid, char *buf, size_t size);          // a stream, read in place of pe_show.
+} procfs_entry_t;
+
+static ssize_t procfs_schedstat_show(pid_t pid, char *buf, size_t size);
+static ssize_t procfs_pid_sched_show(pid_t pid, char *buf, size_t size);
+
+#if defined(LOCKSTAT)
+static ssize_t procfs_lockstat_show(pid_t pid __unused, char *buf, size_t size) {
+    return lockstat_show(buf, size);
+}
+
+static ssize_t procfs_lockstat_write(pid_t pid __unused, const char *buf __unused, size_t size) {
+    // any write resets the counters.
+    lockstat_reset();
+    return size;
+}
+#endif
+
+static ssize_t procfs_systrace_read(pid_t pid __unused, char *buf, size_t size) {
+    return systrace_read(buf, size);
+}
+
+static ssize_t procfs_systrace_write(pid_t pid __unused, const char *buf, size_t size) {
+    return systrace_ctl(buf, size);
+}
+
+static ssize_t procfs_sysstat_show(pid_t pid __unused, char *buf, size_t size) {
+    return sysstat_show(buf, size);
+}
+
+static ssize_t procfs_sysstat_write(pid_t pid __unused, const char *buf __unused, size_t size) {
+    // any write resets the counters.
+    sysstat_reset();
+    return size;
+}
+
+enum {
+    PROCFS_PID,         // /proc/<pid>/
+    PROCFS_SCHEDSTAT,   // /proc/schedstat
+    PROCFS_PID_SCHED,   // /proc/<pid>/sched
+    PROCFS_LOCKSTAT,    // /proc/lockstat(LOCKSTAT builds only)
+    PROCFS_SYSTRACE,    // /proc/systrace
+    PROCFS_SYSSTAT,     // /proc/sysstat
+};
+
+static procfs_entry_t procfs_entries[] = {
+    [PROCFS_PID]        = { NULL,        FS_DIR, 0, NULL,                  NULL, 0 },
+    [PROCFS_SCHEDSTAT]  = { "schedstat", FS_RGL, 0, procfs_schedstat_show, NULL, 0 },
+    [PROCFS_PID_SCHED]  = { "sched",     FS_RGL, 1, procfs_pid_sched_show, NULL, 0 },
+#if defined(LOCKSTAT)
+    [PROCFS_LOCKSTAT]   = { "lockstat",  FS_RGL, 0, procfs_lockstat_show,  procfs_lockstat_write, KiB(256) },
+#endif
+    [PROCFS_SYSTRACE]   = { "systrace",  FS_RGL, 0, NULL,                  procfs_systrace_write, 0, procfs_systrace_read },
+    [PROCFS_SYSSTAT]    = { "sysstat",   FS_RGL, 0, procfs_sysstat_show,   procfs_sysstat_write,  KiB(64) },
+};
+
+/**
+ * @brief entry an inode refers to.
+ * @return procfs_entry_t * NULL for the root directory(a tmpfs inode).
+ */
+static procfs_entry_t *procfs_entry(inode_t *ip) {
+    procfs_entry_t *pe = ip->i_priv;
+
+    if (pe < procfs_entries || pe >= &procfs_entries[NELEM(procfs_entries)])
+        return NULL;
+    return pe;
+}
+
 static iops_t procfs_iops = {
     .iopen      = procfs_iopen,
     .isync      = procfs_isync,
@@ -107,7 +196,8 @@ int procfs_isync(inode_t *ip __unused) {
 }
 
 int procfs_iclose(inode_t *ip __unused) {
-    return -ENOSYS;
+    // entries are static, there is nothing to free.
+    return 0;
 }
 
 int procfs_iunlink(inode_t *ip __unused) {
@@ -134,12 +224,61 @@ int procfs_iioctl(inode_t *ip __unused, int req __unused, void *argp __unused) {
     return -ENOSYS;
 }
 
-ssize_t procfs_iread_data(inode_t *ip __unused, off_t off __unused, void *buf __unused, size_t nb __unused) {
-    return -ENOSYS;
+ssize_t procfs_iread_data(inode_t *ip, off_t off, void *buf, size_t nb) {
+    ssize_t         len     = 0;
+    size_t          size    = 0;
+    char            *text   = NULL;
+    procfs_entry_t  *pe     = NULL;
+
+    iassert_locked(ip);
+
+    if (buf == NULL)
+        return -EINVAL;
+
+    if ((pe = procfs_entry(ip)) == NULL)
+        return -EISDIR;
+
+    if (pe->pe_read)
+        return pe->pe_read(PROCFS_INO_PID(ip->i_ino), buf, nb);
+
+    if (pe->pe_show == NULL)
+        return -EISDIR;
+
+    size = pe->pe_size ? pe->pe_size : PROCFS_BUFSZ;
+    if ((text = kmalloc(size)) == NULL)
+        return -ENOMEM;
+
+    // contents are generated on every read so they are always current.
+    if ((len = pe->pe_show(PROCFS_INO_PID(ip->i_ino), text, size)) < 0)
+        goto done;
+
+    if (off >= (off_t)len) {
+        len = 0;
+        goto done;
+    }
+
+    len = MIN((size_t)(len - off), nb);
+    memcpy(buf, text + off, len);
+done:
+    kfree(text);
+    return len;
 }
 
-ssize_t procfs_iwrite_data(inode_t *ip __unused, off_t off __unused, void *buf __unused, size_t nb __unused) {
-    return -ENOSYS;
+ssize_t procfs_iwrite_data(inode_t *ip, off_t off __unused, void *buf, size_t nb) {
+    procfs_entry_t  *pe     = NULL;
+
+    iassert_locked(ip);
+
+    if (buf == NULL)
+        return -EINVAL;
+
+    if ((pe = procfs_entry(ip)) == NULL || pe->pe_type == FS_DIR)
+        return -EISDIR;
+
+    if (pe->pe_write == NULL)
+        return -EACCES;
+
+    return pe->pe_write(PROCFS_INO_PID(ip->i_ino), buf, nb);
 }
 
 int procfs_imkdir(inode_t *dir __unused, const char *fname __unused, mode_t mode __unused) {
@@ -154,8 +293,85 @@ int procfs_ibind(inode_t *dir __unused, struct dentry *dentry __unused, inode_t
     return -ENOSYS;
 }
 
-int procfs_ilookup(inode_t *dir __unused, const char *fname __unused, inode_t **pipp __unused) {
-    return -ENOSYS;
+/**
+ * @brief parse a decimal pid.
+ * @return pid_t the pid, or -1 if 'name' is not a number.
+ */
+static pid_t procfs_pid(const char *name) {
+    if (name == NULL || *name == '\0')
+        return -1;
+
+    for (const char *c = name; *c; ++c) {
+        if (*c < '0' || *c > '9')
+            return -1;
+    }
+    return atoi(name);
+}
+
+int procfs_ilookup(inode_t *dir, const char *fname, inode_t **pipp) {
+    int             err     = 0;
+    pid_t           pid     = 0;
+    size_t          e       = 0;
+    inode_t         *ip     = NULL;
+    procfs_entry_t  *pdir   = NULL;
+
+    iassert_locked(dir);
+
+    if (fname == NULL || pipp == NULL)
+        return -EINVAL;
+
+    if (IISDIR(dir) == 0)
+        return -ENOTDIR;
+
+    if ((pdir = procfs_entry(dir)) == NULL) { // /proc/
+        for (e = 0; e < NELEM(procfs_entries); ++e) {
+            if (procfs_entries[e].pe_name &&
+                !procfs_entries[e].pe_perpid &&
+                string_eq(procfs_entries[e].pe_name, fname))
+                break;
+        }
+
+        if (e >= NELEM(procfs_entries)) {
+            if ((pid = procfs_pid(fname)) < 0)
+                return -ENOENT;
+
+            if ((err = procQ_search_bypid(pid, NULL)))
+                return -ENOENT;
+            e = PROCFS_PID;
+        }
+    } else { // /proc/<pid>/
+        pid = PROCFS_INO_PID(dir->i_ino);
+        for (e = 0; e < NELEM(procfs_entries); ++e) {
+            if (procfs_entries[e].pe_name &&
+                procfs_entries[e].pe_perpid &&
+                string_eq(procfs_entries[e].pe_name, fname))
+                break;
+        }
+
+        if (e >= NELEM(procfs_entries))
+            return -ENOENT;
+    }
+
+    if ((err = ialloc(procfs_entries[e].pe_type, I_NOCACHE, &ip)))
+        return err;
+
+    ip->i_ops   = dir->i_ops;
+    ip->i_sb    = dir->i_sb;
+    ip->i_priv  = &procfs_entries[e];
+    ip->i_ino   = PROCFS_INO(pid, e);
+    ip->i_type  = procfs_entries[e].pe_type;
+    ip->i_size  = 0;
+    ip->i_uid   = 0;
+    ip->i_gid   = 0;
+    ip->i_hlinks= 1;
+    ip->i_mode  = ip->i_type == FS_DIR ?
+        S_IFDIR | S_IRUSR | S_IXUSR | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH :
+        S_IFREG | S_IRUSR | S_IRGRP | S_IROTH;
+    if (procfs_entries[e].pe_write)
+        ip->i_mode |= S_IWUSR;
+
+    *pipp = ip;
+    return 0;
 }
 
 int procfs_isymlink(inode_t *ip __unused, inode_t *atdir __unused, const char *symname __unused) {
@@ -166,8 +382,155 @@ int procfs_imknod(inode_t *dir __unused, const char *name __unused, mode_t mode
     return -ENOSYS;
 }
 
-ssize_t procfs_ireaddir(inode_t *dir __unused, off_t off __unused, struct dirent *buf __unused, size_t count __unused) {
-    return -ENOSYS;
+static void procfs_dirent(struct dirent *dp, off_t off, pid_t pid, size_t e, const char *name) {
+    *dp = (struct dirent) {
+        .d_ino      = PROCFS_INO(pid, e),
+        .d_off      = off,
+        .d_type     = procfs_entries[e].pe_type,
+        .d_reclen   = sizeof *dp,
+        .d_size     = 0,
+    };
+    strncpy(dp->d_name, name, sizeof dp->d_name - 1);
+}
+
+ssize_t procfs_ireaddir(inode_t *dir, off_t off, struct dirent *buf, size_t count) {
+    off_t           pos     = 0;
+    size_t          ncount  = 0;
+    proc_t          *proc   = NULL;
+    procfs_entry_t  *pdir   = NULL;
+    char            name[16];
+
+    iassert_locked(dir);
+
+    if (buf == NULL || count == 0)
+        return -EINVAL;
+
+    if (IISDIR(dir) == 0)
+        return -ENOTDIR;
+
+    pdir = procfs_entry(dir);
+
+    // fixed entries first.
+    for (size_t e = 0; e < NELEM(procfs_entries) && ncount < count; ++e) {
+        if (procfs_entries[e].pe_name == NULL ||
+            procfs_entries[e].pe_perpid != (pdir != NULL))
+            continue;
+
+        if (pos++ < off)
+            continue;
+
+        procfs_dirent(&buf[ncount], off + ncount,
+            pdir ? PROCFS_INO_PID(dir->i_ino) : 0, e, procfs_entries[e].pe_name);
+        ncount++;
+    }
+
+    // then a directory per process in /proc/.
+    if (pdir == NULL && ncount < count) {
+        queue_lock(procQ);
+        forlinked(node, procQ->head, node->next) {
+            if (ncount >= count)
+                break;
+
+            if (pos++ < off)
+                continue;
+
+            proc = node->data;
+            proc_lock(proc);
+            snprintf(name, sizeof name, "%d", proc->pid);
+            procfs_dirent(&buf[ncount], off + ncount, proc->pid, PROCFS_PID, name);
+            proc_unlock(proc);
+            ncount++;
+        }
+        queue_unlock(procQ);
+    }
+
+    return ncount ? 0 : -1;
+}
+
+static ssize_t procfs_schedstat_show(pid_t pid __unused, char *buf, size_t size) {
+    size_t          len     = 0;
+    sched_stat_t    *ss     = NULL;
+
+    len += snprintf(buf + len, size - len,
+        "version 1\n"
+        "timestamp %lu\n"
+        "# cpu<id> nrun run_ns wait_ns idle_ns nvcsw nivcsw migrations\n"
+        "# lat<id> wakeup-to-run latency, bucket b counts [2^(b-1), 2^b) ns\n",
+        sched_clock()
+    );
+
+    for (int id = 0; id < MAXNCPU && len < size; ++id) {
+        if (cpus[id] == NULL)
+            continue;
+
+        ss = &cpus[id]->sched_stat;
+        len += snprintf(buf + len, size - len,
+            "cpu%d %lu %lu %lu %lu %lu %lu %lu\nlat%d",
+            id, ss->ss_nrun, ss->ss_run_sum, ss->ss_wait_sum,
+            ss->ss_idle_sum, ss->ss_nvcsw, ss->ss_nivcsw,
+            ss->ss_migrations, id
+        );
+
+        for (size_t b = 0; b < SCHED_LAT_NBUCKETS && len < size; ++b)
+            len += snprintf(buf + len, size - len, " %lu", ss->ss_lat[b]);
+
+        if (len < size)
+            len += snprintf(buf + len, size - len, "\n");
+    }
+
+    return MIN(len, size);
+}
+
+static ssize_t procfs_pid_sched_show(pid_t pid, char *buf, size_t size) {
+    int             err     = 0;
+    size_t          len     = 0;
+    size_t          nthread = 0;
+    proc_t          *proc   = NULL;
+    queue_t         *tgroup = NULL;
+    sched_stat_t    ss      = {0};
+
+    if ((err = procQ_search_bypid(pid, &proc)))
+        return err;
+
+    if (proc->main_thread == NULL) {
+        proc_release(proc);
+        return -ESRCH;
+    }
+
+    // sum up the accounting of every thread in the process.
+    tgroup = thread_tgroup(proc->main_thread);
+    tgroup_lock(tgroup);
+    queue_foreach(thread_t *, thread, tgroup) {
+        thread_lock(thread);
+        sched_stat_add(&ss, &thread->t_sched.ts_stat);
+        thread_unlock(thread);
+        nthread++;
+    }
+    tgroup_unlock(tgroup);
+
+    len += snprintf(buf + len, size - len,
+        "%s (%d, #threads: %lu)\n"
+        "nr_switches   : %lu\n"
+        "nr_voluntary  : %lu\n"
+        "nr_involuntary: %lu\n"
+        "nr_migrations : %lu\n"
+        "run_ns        : %lu\n"
+        "wait_ns       : %lu\n"
+        "wakeup-to-run latency:\n",
+        proc->name ? proc->name : "?", pid, nthread,
+        ss.ss_nrun, ss.ss_nvcsw, ss.ss_nivcsw, ss.ss_migrations,
+        ss.ss_run_sum, ss.ss_wait_sum
+    );
+    proc_release(proc);
+
+    for (size_t b = 0; b < SCHED_LAT_NBUCKETS && len < size; ++b) {
+        if (ss.ss_lat[b] == 0)
+            continue;
+        len += snprintf(buf + len, size - len, "  [%10lu, %10lu) ns: %lu\n",
+            b ? 1ul << (b - 1) : 0ul, 1ul << b, ss.ss_lat[b]);
+    }
+
+    return MIN(len, size);
 }
 
 int procfs_ilink(const char *oldname __unused, inode_t *dir __unused, const char *newname __unused) {
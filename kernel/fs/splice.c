@@ -0,0 +1,201 @@
+#include <arch/paging.h>
+#include <bits/errno.h>
+#include <fs/file.h>
+#include <fs/icache.h>
+#include <mm/kalloc.h>
+#include <mm/page.h>
+#include <sys/thread.h>
+
+/**
+ * @brief sendfile() and splice() move data between two open files without
+ * a trip through user memory. A cached source hands its pages to the
+ * destination's write path one at a time, pinned and mapped but not copied;
+ * an uncached one(pipe, device) is read through one kernel page.
+ * Only one inode is locked at a time, so transfers in opposite directions
+ * between the same two files can't deadlock.
+ */
+
+typedef struct splice_end {
+    file_t  *se_file;
+    inode_t *se_inode;
+    off_t   se_off;     // where the next byte comes from(goes to).
+    off_t   *se_uoff;   // the caller's offset(a kernel copy), NULL to use and move f_off.
+} splice_end_t;
+
+static int splice_open(int fd, off_t *uoff, splice_end_t *end) {
+    int     err     = 0;
+    file_t  *file   = NULL;
+    inode_t *inode  = NULL;
+
+    if ((err = file_get(fd, &file)))
+        return err;
+
+    err = -EINVAL;
+    if (file->fops != NULL || file->f_dentry == NULL)
+        goto error;
+
+    dlock(file->f_dentry);
+    if ((inode = file->f_dentry->d_inode))
+        ilock(inode);
+    dunlock(file->f_dentry);
+
+    err = -ENOENT;
+    if (inode == NULL)
+        goto error;
+
+    err = -ESPIPE;
+    if (uoff && IISPIPE(inode)) {
+        iunlock(inode);
+        goto error;
+    }
+
+    idupcnt(inode);
+    iunlock(inode);
+
+    // pin the file, the fd may be closed while the transfer runs unlocked.
+    fdup(file);
+
+    end->se_file    = file;
+    end->se_inode   = inode;
+    end->se_uoff    = uoff;
+    end->se_off     = uoff ? *uoff : file->f_off;
+    funlock(file);
+    return 0;
+error:
+    funlock(file);
+    return err;
+}
+
+static void splice_close(splice_end_t *end) {
+    ilock(end->se_inode);
+    iputcnt(end->se_inode);
+    iunlock(end->se_inode);
+
+    flock(end->se_file);
+    if (end->se_uoff)
+        *end->se_uoff = end->se_off;
+    else
+        end->se_file->f_off = end->se_off;
+
+    if (fclose(end->se_file))
+        funlock(end->se_file);
+}
+
+static ssize_t splice_write(splice_end_t *out, void *buf, size_t size) {
+    ssize_t retval = 0;
+
+    ilock(out->se_inode);
+    if ((retval = iwrite(out->se_inode, out->se_off, buf, size)) > 0) {
+        out->se_off += retval;
+        if (out->se_inode->i_readers)
+            cond_broadcast(out->se_inode->i_readers);
+    }
+    iunlock(out->se_inode);
+    return retval;
+}
+
+// move the page of 'in' at se_off, or what is left of it, to 'out'.
+static ssize_t splice_page(splice_end_t *in, splice_end_t *out, size_t size, void **bounce) {
+    ssize_t     err     = 0;
+    usize       pgoff   = 0;
+    uintptr_t   paddr   = 0;
+    void        *vaddr  = NULL;
+    page_t      *page   = NULL;
+    inode_t     *ip     = in->se_inode;
+
+    ilock(ip);
+    if (ip->i_cache == NULL) {
+        if (*bounce == NULL && (*bounce = kmalloc(PGSZ)) == NULL) {
+            iunlock(ip);
+            return -ENOMEM;
+        }
+
+        err = iread(ip, in->se_off, *bounce, MIN(size, PGSZ));
+        iunlock(ip);
+
+        if (err <= 0)
+            return err;
+
+        in->se_off += err;
+        return splice_write(out, *bounce, err);
+    }
+
+    if (in->se_off >= (off_t)igetsize(ip)) {
+        iunlock(ip);
+        return 0; // EOF.
+    }
+
+    pgoff   = in->se_off % PGSZ;
+    size    = MIN(size, PGSZ - pgoff);
+    size    = MIN(size, igetsize(ip) - in->se_off);
+
+    icache_lock(ip->i_cache);
+    if ((err = icache_getpage(ip->i_cache, in->se_off / PGSZ, &page)) == 0)
+        err = page_getref(page);
+    icache_unlock(ip->i_cache);
+    iunlock(ip);
+
+    if (err)
+        return err;
+
+    if ((err = page_get_address(page, (void **)&paddr)))
+        goto done;
+
+    if ((err = arch_mount(paddr, &vaddr)))
+        goto done;
+
+    if ((err = splice_write(out, vaddr + pgoff, size)) > 0)
+        in->se_off += err;
+
+    arch_unmount((uintptr_t)vaddr);
+done:
+    page_putref(page);
+    return err;
+}
+
+static ssize_t do_splice(int in_fd, off_t *in_off, int out_fd, off_t *out_off, size_t count) {
+    ssize_t         err     = 0;
+    size_t          total   = 0;
+    void            *bounce = NULL;
+    splice_end_t    in      = {0};
+    splice_end_t    out     = {0};
+
+    if (in_fd == out_fd)
+        return -EINVAL;
+
+    count = MIN(count, (size_t)__LONG_MAX__);
+
+    if ((err = splice_open(in_fd, in_off, &in)))
+        return err;
+
+    if ((err = splice_open(out_fd, out_off, &out))) {
+        splice_close(&in);
+        return err;
+    }
+
+    while (total < count) {
+        if ((err = splice_page(&in, &out, count - total, &bounce)) <= 0)
+            break;
+        total += err;
+
+        if (current_iskilled())
+            break;
+    }
+
+    splice_close(&out);
+    splice_close(&in);
+
+    if (bounce)
+        kfree(bounce);
+    return total ? (ssize_t)total : err;
+}
+
+ssize_t sendfile(int out_fd, int in_fd, off_t *offset, size_t count) {
+    return do_splice(in_fd, offset, out_fd, NULL, count);
+}
+
+ssize_t splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, uint flags) {
+    if (flags != 0)
+        return -EINVAL;
+    return do_splice(fd_in, off_in, fd_out, off_out, len);
+}
@@ -360,6 +360,99 @@ ssize_t write(int fd, void *buf, size_t size) {
     return err;
 }
 
+ssize_t readv(int fd, const struct iovec *iov, int iovcnt) {
+    ssize_t err= 0;
+    file_t *file = NULL;
+    if ((err = file_get(fd, &file)))
+        return err;
+    err = freadv(file, iov, iovcnt);
+    funlock(file);
+    return err;
+}
+
+ssize_t writev(int fd, const struct iovec *iov, int iovcnt) {
+    ssize_t err= 0;
+    file_t *file = NULL;
+    if ((err = file_get(fd, &file)))
+        return err;
+    err = fwritev(file, iov, iovcnt);
+    funlock(file);
+    return err;
+}
+
+/**
+ * @brief positional I/O only needs the inode, so the file lock is dropped
+ * before the transfer and users of the file offset aren't held up.
+ * Whether the file is seekable is up to the type of its inode.
+ */
+static ssize_t prwv(int fd, const struct iovec *iov, int iovcnt, off_t off, int write) {
+    ssize_t err     = 0;
+    off_t   saved   = 0;
+    file_t  *file   = NULL;
+    inode_t *inode  = NULL;
+
+    if ((ssize_t)off < 0)
+        return -EINVAL;
+
+    if ((err = file_get(fd, &file)))
+        return err;
+
+    // no inode to tell, e.g a uring, such files are streams.
+    if (file->f_dentry == NULL) {
+        funlock(file);
+        return -ESPIPE;
+    }
+
+    dlock(file->f_dentry);
+    if ((inode = file->f_dentry->d_inode)) {
+        ilock(inode);
+        idupcnt(inode);
+    }
+    dunlock(file->f_dentry);
+
+    if (inode == NULL) {
+        funlock(file);
+        return -ENOENT;
+    }
+
+    if (IISPIPE(inode) || IISFIFO(inode) || IISSOCK(inode)) {
+        funlock(file);
+        err = -ESPIPE;
+    } else if (file->fops != NULL) {
+        // the file's own ops work at f_off, run them at 'off' and put it back.
+        iunlock(inode);
+        saved       = file->f_off;
+        file->f_off = off;
+        err         = write ? fwritev(file, iov, iovcnt) : freadv(file, iov, iovcnt);
+        file->f_off = saved;
+        funlock(file);
+        ilock(inode);
+    } else {
+        funlock(file);
+        err = write ? iwritev(inode, off, iov, iovcnt) : ireadv(inode, off, iov, iovcnt);
+    }
+
+    iputcnt(inode);
+    iunlock(inode);
+    return err;
+}
+
+ssize_t preadv(int fd, const struct iovec *iov, int iovcnt, off_t off) {
+    return prwv(fd, iov, iovcnt, off, 0);
+}
+
+ssize_t pwritev(int fd, const struct iovec *iov, int iovcnt, off_t off) {
+    return prwv(fd, iov, iovcnt, off, 1);
+}
+
+ssize_t pread(int fd, void *buf, size_t size, off_t off) {
+    return preadv(fd, &(struct iovec){ .iov_base = buf, .iov_len = size }, 1, off);
+}
+
+ssize_t pwrite(int fd, void *buf, size_t size, off_t off) {
+    return pwritev(fd, &(struct iovec){ .iov_base = buf, .iov_len = size }, 1, off);
+}
+
 int     create(const char *pathname, mode_t mode) {
     return open(pathname, O_WRONLY | O_CREAT | O_TRUNC, mode);
 }
@@ -8,6 +8,7 @@
 #include <fs/tmpfs.h>
 #include <lib/string.h>
 #include <mm/kalloc.h>
+#include <sync/seqlock.h>
 
 char *itype_strings[] = {
     [FS_INV] = "INV",
@@ -22,6 +23,8 @@ char *itype_strings[] = {
 
 static dentry_t *droot = NULL;
 static queue_t *fs_queue = &QUEUE_INIT();
+// filesystems are never freed, so vfs_getfs() walks fs_queue without locking it.
+static SEQLOCK(fs_seqlock);
 
 dentry_t *vfs_getdroot(void) {
     if (droot) {
@@ -161,11 +164,13 @@ int vfs_register_fs(filesystem_t *fs) {
     if (fs == NULL)
         return -EINVAL;
 
+    write_seqlock(fs_seqlock);
     queue_lock(fs_queue);
 
     err = enqueue(fs_queue, fs, 1, NULL);
 
     queue_unlock(fs_queue);
+    write_sequnlock(fs_seqlock);
     
     
     return err;
@@ -183,29 +188,32 @@ int vfs_unregister_fs(filesystem_t *fs) {
 }
 
 int vfs_getfs(const char *type, filesystem_t **pfs) {
+    u32          seq = 0;
     filesystem_t *fs = NULL;
-    queue_node_t *next = NULL;
 
     if (type == NULL || pfs == NULL)
         return -EINVAL;
 
-    queue_lock(fs_queue);
-
-    forlinked(node, fs_queue->head, next) {
-        fs = node->data;
-        next = node->next;
-
-        fslock(fs);
-        if (!compare_strings(type, fs->fs_name)) {
-            *pfs = fs;
-            queue_unlock(fs_queue);
-            return 0;
+    // fs_name never changes once registered, only the list itself needs the retry.
+    do {
+        seq = read_seqbegin(fs_seqlock);
+        fs  = NULL;
+        forlinked(node, fs_queue->head, node->next) {
+            filesystem_t *entry = node->data;
+            // a node being linked in may be seen before it is filled.
+            if (entry && entry->fs_name && !compare_strings(type, entry->fs_name)) {
+                fs = entry;
+                break;
+            }
         }
-        fsunlock(fs);
-    }
+    } while (read_seqretry(fs_seqlock, seq));
 
-    queue_unlock(fs_queue);
-    return -ENOENT;
+    if (fs == NULL)
+        return -ENOENT;
+
+    fslock(fs);
+    *pfs = fs;
+    return 0;
 }
 
 int vfs_dirlist(const char *path) {
@@ -9,6 +9,7 @@
 #include <sys/sched.h>
 #include <arch/x86_64/context.h>
 #include <arch/x86_64/ipi.h>
+#include <ginger/tick.h>
 
 #define CPU_PBE             BS(63)  // Pend. Brk. EN.
 #define CPU_TM              BS(61)  // Therm. Monitor
@@ -105,6 +106,10 @@
 #define CR4_SMAP            BS(21)   // SMAP-Enable Bit.
 
 typedef struct cpu {
+    // used by syscall_entry(see isrs.asm), keep them first.
+    u64            kstack;      // kernel stack of the running thread, same as tss.rsp0.
+    u64            ustack;      // user stack pointer while entering a system call.
+
     i64            ncli;
     i64            intena;
     u64            version;
@@ -114,6 +119,8 @@ typedef struct cpu {
     u64            flags;
     u64            features;
     u64            timer_ticks;
+    u64            timer_freq;  // local APIC timer ticks per second.
+    tick_t         tick;        // NOHZ tick state.
 
     tss_t           tss;
     gdt_t           gdt;
@@ -124,6 +131,7 @@ typedef struct cpu {
     thread_t        *thread;
     thread_t        *simd_thread;
     sched_queue_t    queueq;
+    sched_stat_t    sched_stat;     // scheduler accounting of this CPU.
 
     u8              phys_addrsz;
     u8              virt_addrsz;
@@ -138,6 +146,7 @@ typedef struct cpu {
 #define CPU_ONLINE          BS(2)   // cpu is online.
 #define CPU_64BIT           BS(3)   // cpu running in 64bit.
 #define CPU_USE_LAPIC       BS(4)   // cpu will use the Local APIC.
+#define CPU_SCHED           BS(5)   // cpu's run-queues are ready, threads may be parked on it.
 
 #define CPU_PANICED         BS(31)  // cpu has paniced.
 
@@ -10,4 +10,6 @@ extern void lapic_timerintr(void);
 // extern void lapic_setaddr(uintptr_t);
 void lapic_send_ipi(int ipi, int dst);
 void lapic_recalibrate(long hz);
+void lapic_timer_stop(void);
+void lapic_timer_oneshot(u64 deadline);
 extern void lapic_startup(int id, u16 addr);
\ No newline at end of file
@@ -16,8 +16,10 @@
 #define LAPIC_ERROR     IRQ(18)
 #define LAPIC_SPURIOUS  IRQ(19)
 #define LAPIC_TIMER     IRQ(20)
+#define SCHED_IPI       IRQ(30)
 #define TLB_SHTDWN      IRQ(31)
 
 #define LAPIC_IPI       IRQ(32)
 
 #define T_LEG_SYSCALL   128
+#define T_SYSCALL       129 // SYSCALL instruction, not an IDT vector.
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <lib/types.h>
+#include <arch/x86_64/system.h>
+
+/**
+ * @brief Time-stamp counter clocksource.
+ * The TSC is calibrated once by the BSP against the HPET, or the PIT
+ * without one(see tsc_init()). Each AP then measures how far its TSC lags
+ * the BSP's while starting up, and tsc_read() adds that offset back, so TSC
+ * values are comparable across CPUs. With RDTSCP, IA32_TSC_AUX holds the
+ * APIC ID and the offset is found without disabling interrupts.
+ */
+
+/**
+ * @brief detect the TSC features of the calling CPU.
+ * The BSP calibrates the TSC and registers it as a clocksource,
+ * an AP synchronizes with the BSP, see tsc_sync_source().
+ * Called once by every CPU while starting up.
+ */
+void tsc_init(void);
+
+/**
+ * @brief feed TSC samples to the AP just started until it is synchronized.
+ * Called by the BSP once the AP is online.
+ */
+void tsc_sync_source(void);
+
+/**
+ * @brief does RDTSCP return the APIC ID in ecx?
+ */
+int tsc_has_rdtscp(void);
+
+/**
+ * @brief read the TSC, adjusted to the BSP's.
+ */
+u64 tsc_read(void);
+
+/**
+ * @brief convert a value of tsc_read() to the calling CPU's own TSC.
+ */
+u64 tsc_to_local(u64 tsc);
+
+/**
+ * @brief set the TSC frequency, this also marks the TSC epoch(jiffy 0).
+ * only the first call has an effect.
+ *
+ * @param hz TSC ticks per second.
+ */
+void tsc_setfreq(u64 hz);
+
+/**
+ * @brief get the calibrated TSC frequency.
+ *
+ * @return u64 TSC ticks per second, 0 if the TSC is not calibrated.
+ */
+u64 tsc_freq(void);
+
+/**
+ * @brief convert jiffies since the TSC epoch to an absolute TSC value.
+ */
+u64 tsc_from_jiffies(u64 jiffies);
+
+/**
+ * @brief number of jiffies elapsed since the TSC epoch.
+ */
+u64 tsc_jiffies(void);
+
+/**
+ * @brief convert a TSC tick count to nanoseconds.
+ */
+u64 tsc_to_ns(u64 ticks);
+
+/**
+ * @brief nanoseconds elapsed since the TSC epoch.
+ */
+u64 tsc_ns(void);
+
+/**
+ * @brief convert nanoseconds since the TSC epoch to an absolute TSC value.
+ */
+u64 tsc_from_ns(u64 ns);
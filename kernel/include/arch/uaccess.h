@@ -0,0 +1,51 @@
+#pragma once
+
+#include <lib/types.h>
+#include <sys/system.h>
+
+/**
+ * @brief Kernel access to user memory.
+ * The copy routines check that the user range lies below USTACK(access_ok),
+ * and each instruction in them that touches user memory has an exception
+ * table entry. A page fault the VM can't resolve at one of them resumes
+ * at its fixup instead of panicking, and the copy returns short.
+ */
+
+// [addr, addr + size) lies in the user half.
+#define access_ok(addr, size) ({                        \
+    uintptr_t   __addr = (uintptr_t)(addr);             \
+    usize       __size = (size);                        \
+    __addr + __size >= __addr && __addr + __size <= USTACK; \
+})
+
+// exception table entry, a fault at 'ex_insn' resumes at 'ex_fixup'.
+typedef struct extable {
+    uintptr_t   ex_insn;
+    uintptr_t   ex_fixup;
+} extable_t;
+
+/**
+ * @brief move the faulting instruction pointer *'pip' to its fixup.
+ * @return int 1 if *'pip' has an exception table entry, 0 otherwise.
+ */
+int     extable_fixup(uintptr_t *pip);
+
+/**
+ * @brief copy 'size' bytes to(from) user memory.
+ * copy_from_user() zeroes what it could not copy.
+ * @return usize number of bytes NOT copied, 0 on success.
+ */
+usize   copy_to_user(void *udst, const void *ksrc, usize size);
+usize   copy_from_user(void *kdst, const void *usrc, usize size);
+
+/**
+ * @brief copy the string at 'usrc', at most 'size' bytes with its NUL.
+ * @return isize its length, -ENAMETOOLONG if it does not fit, or -EFAULT.
+ */
+isize   strncpy_from_user(char *kdst, const char *usrc, usize size);
+
+/**
+ * @brief same, into a new kmalloc()ed buffer of 'size' bytes at *'pstr'.
+ * @return int 0 on success, or a negated errno.
+ */
+int     strndup_user(const char *usrc, usize size, char **pstr);
@@ -65,4 +65,7 @@ extern void irq27(void);
 extern void irq28(void);
 extern void irq29(void);
 extern void irq30(void);
-extern void irq31(void);
\ No newline at end of file
+extern void irq31(void);
+
+// SYSCALL instruction entry(IA32_LSTAR).
+extern void syscall_entry(void);
@@ -12,8 +12,9 @@
 #define SEG_NULL        0
 #define SEG_KCODE64     1
 #define SEG_KDATA64     2
-#define SEG_UCODE64     3
-#define SEG_UDATA64     4
+// SYSRET wants user data right below user code, see IA32_STAR.
+#define SEG_UDATA64     3
+#define SEG_UCODE64     4
 #define SEG_TSS64       5
 //#define SEG_KCPU64      5
 
@@ -100,8 +101,8 @@ typedef struct {
     segdesc_t null;
     segdesc_t kcode64;
     segdesc_t kdata64;
-    segdesc_t ucode64;
     segdesc_t udata64;
+    segdesc_t ucode64;
     tssdesc_t tss;
 } __packed gdt_t;
 
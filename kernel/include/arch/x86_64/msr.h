@@ -50,6 +50,8 @@
 #define IA32_X2APIC_DIV_CONF    0x83E   //x2APIC Divide Configuration Register (R/W)
 #define IA32_X2APIC_SELF_IPI    0x83F   //x2APIC Self IPI Register (W/O)
 
+#define IA32_TSC_DEADLINE       0x6E0       //TSC Target of Local APIC's TSC Deadline Mode (R/W)
+
 #define IA32_EFER               0xC0000080  //Extended Feature Enables
 #define IA32_STAR               0xC0000081  //System Call Target Address (R/W)
 #define IA32_LSTAR              0xC0000082  //IA-32e Mode System Call Target Address (R/W)
@@ -57,6 +59,7 @@
 #define IA32_FS_BASE            0xC0000100  //Map of BASE Address of FS (R/W)
 #define IA32_GS_BASE            0xC0000101  //Map of BASE Address of GS (R/W)
 #define IA32_KERNEL_GS_BASE     0xC0000102  //Swap Target of BASE Address of GS (R/W)
+#define IA32_TSC_AUX            0xC0000103  //Auxiliary TSC, returned in ecx by RDTSCP (R/W)
 
 extern void     wrmsr(uint64_t msr, uint64_t val);
 extern uint64_t rdmsr(uint64_t msr);
\ No newline at end of file
@@ -112,7 +112,8 @@ typedef union viraddr {
 // extract flags used to map a page.
 #define extract_vmflags(flags)  ({ PGOFF(flags); })
 
-#define GETPHYS(entry)          ((uintptr_t)((entry) ? PGROUND((entry)->raw) : 0))
+// frame address of a PTE, without the flag bits above it(e.g NX).
+#define GETPHYS(entry)          ((uintptr_t)((entry) ? (uintptr_t)(entry)->phys << 12 : 0))
 
 /**
  * 
@@ -32,6 +32,36 @@ static inline void cpu_pause(void) {
 #endif
 }
 
+// enable interrupts and halt the current processor core.
+// 'sti' delays interrupt recognition by one instruction, so no
+// interrupt can slip in between the two and be missed by 'hlt'.
+static inline void sti_hlt(void) {
+#if defined __i386__ || __x86_64__
+    asm __volatile__ ("sti; hlt");
+#endif
+}
+
+// read the time-stamp counter of the current processor core.
+static inline u64 rdtsc(void) {
+    u32 lo = 0, hi = 0;
+#if defined __i386__ || __x86_64__
+    asm __volatile__ ("rdtsc" : "=a"(lo), "=d"(hi));
+#endif
+    return ((u64)hi << 32) | lo;
+}
+
+// read the time-stamp counter and IA32_TSC_AUX of the current processor core atomically.
+// unlike 'rdtsc', this waits for all prior instructions to execute.
+static inline u64 rdtscp(u32 *aux) {
+    u32 lo = 0, hi = 0, c = 0;
+#if defined __i386__ || __x86_64__
+    asm __volatile__ ("rdtscp" : "=a"(lo), "=d"(hi), "=c"(c));
+#endif
+    if (aux)
+        *aux = c;
+    return ((u64)hi << 32) | lo;
+}
+
 extern void disable_caching(void);
 
 static inline uintptr_t rdrax(void) {
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <lib/types.h>
+
+// emit an exception table entry from inline assembly, see arch/uaccess.h.
+#define EXTABLE(insn, fixup)                    \
+    ".pushsection .__extable, \"a\"\n"          \
+    ".balign 8\n"                               \
+    ".quad " insn ", " fixup "\n"               \
+    ".popsection\n"
+
+/**
+ * @brief copy 'size' bytes with rep movsq, then rep movsb for the tail.
+ * @return usize number of bytes NOT copied.
+ */
+usize x86_64_copy_user(void *dst, const void *src, usize size);
+
+/**
+ * @brief copy bytes up to and including a NUL, at most 'size' of them.
+ * @return isize number of bytes copied, or -EFAULT.
+ */
+isize x86_64_strncpy_user(char *dst, const char *src, usize size);
@@ -9,6 +9,7 @@ typedef struct queue_node {
     void                *data;
     struct queue_node   *next;
     struct queue        *queue;
+    rcu_head_t          rcu;    // defers the free of a node unlinked by queue_remove_rcu().
 } queue_node_t;
 
 typedef struct queue {
@@ -153,6 +154,19 @@ int queue_remove(queue_t *q, void *data);
  */
 int queue_remove_node(queue_t *q, queue_node_t *__node);
 
+/**
+ * @brief Same as queue_remove(), except the node is freed only once
+ * RCU readers walking the queue may no longer hold it.
+ * The node's 'next' pointer is left intact so such readers can walk past it.
+ * Queues walked by RCU readers must only be changed through
+ * enqueue(), enqueue_head() and this function.
+ *
+ * @param q queue from which the data item is removed.
+ * @param data the data to be removed.
+ * @return int 0 on success, otherwise and error code is returned.
+ */
+int queue_remove_rcu(queue_t *q, void *data);
+
 // rellocation points, used with queue rellocation functions.
 typedef enum {
     QUEUE_RELLOC_TAIL,  // rellocate to the tail-end.
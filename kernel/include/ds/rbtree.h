@@ -0,0 +1,47 @@
+#pragma once
+
+#include <lib/stddef.h>
+#include <lib/types.h>
+#include <sys/system.h>
+
+/**
+ * @brief Intrusive red-black tree.
+ * Nodes are embedded in the objects they order and the caller does the
+ * locking. The leftmost node is cached, so the least node is found in O(1),
+ * insertion and removal take O(log n).
+ */
+
+#define RB_RED      0
+#define RB_BLACK    1
+
+typedef struct rb_node {
+    struct rb_node  *rb_parent;
+    struct rb_node  *rb_left;
+    struct rb_node  *rb_right;
+    int             rb_color;
+} rb_node_t;
+
+typedef struct rb_root {
+    rb_node_t       *rb_node;
+    rb_node_t       *rb_leftmost;   // least node, NULL if the tree is empty.
+} rb_root_t;
+
+#define RB_ROOT_INIT()              ((rb_root_t){0})
+
+#define rb_entry(ptr, type, member) container_of(ptr, type, member)
+#define rb_empty(root)              ({ (root)->rb_node == NULL; })
+#define rb_first(root)              ({ (root)->rb_leftmost; })
+
+/**
+ * @brief insert 'node' into 'root'.
+ * @param less returns non-zero if 'a' orders before 'b',
+ * nodes comparing equal are kept in insertion order.
+ */
+void rb_insert(rb_root_t *root, rb_node_t *node,
+    int (*less)(const rb_node_t *a, const rb_node_t *b));
+
+// remove 'node' from 'root'.
+void rb_erase(rb_root_t *root, rb_node_t *node);
+
+// in-order successor of 'node', NULL if it is the last.
+rb_node_t *rb_next(const rb_node_t *node);
@@ -34,6 +34,7 @@ typedef struct dentry {
     struct dentry   *d_parent;  // dentry's parent.
     struct dentry   *d_child;   // dentry's first child, if dentry is a directory.
     spinlock_t      d_lock;     // dentry's spinlock.
+    rcu_head_t      d_rcu;      // defers the free past lockless dlookup() walks.
 } dentry_t;
 
 #define dassert(dentry) ({                \
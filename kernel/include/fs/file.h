@@ -41,6 +41,7 @@ typedef struct file_t {
     long        f_refcnt;
     dentry_t    *f_dentry;
     fops_t      *fops;
+    void        *f_priv;    // private to 'fops'.
     spinlock_t  f_lock;
 } file_t;
 
@@ -72,6 +73,8 @@ int     fioctl(file_t *file, int req, void *argp);
 off_t   flseek(file_t *file, off_t off, int whence);
 ssize_t fread(file_t *file, void *buf, size_t size);
 ssize_t fwrite(file_t *file, void *buf, size_t size);
+ssize_t freadv(file_t *file, const struct iovec *iov, int iovcnt);
+ssize_t fwritev(file_t *file, const struct iovec *iov, int iovcnt);
 int     fcreate(file_t *dir, const char *filename, mode_t mode);
 int     fmkdirat(file_t *dir, const char *filename, mode_t mode);
 ssize_t freaddir(file_t *dir, off_t off, void *buf, size_t count);
@@ -131,6 +134,30 @@ int     pipe(int fds[2]);
 off_t   lseek(int fd, off_t off, int whence);
 ssize_t read(int fd, void *buf, size_t size);
 ssize_t write(int fd, void *buf, size_t size);
+// 'iov' is a kernel copy of the vector, see iov_length().
+ssize_t readv(int fd, const struct iovec *iov, int iovcnt);
+ssize_t writev(int fd, const struct iovec *iov, int iovcnt);
+
+/**
+ * @brief positional I/O, at 'off' rather than at and past the file offset,
+ * which they neither use nor move. -ESPIPE on pipes, FIFOs, sockets
+ * and files without an inode.
+ */
+ssize_t pread(int fd, void *buf, size_t size, off_t off);
+ssize_t pwrite(int fd, void *buf, size_t size, off_t off);
+ssize_t preadv(int fd, const struct iovec *iov, int iovcnt, off_t off);
+ssize_t pwritev(int fd, const struct iovec *iov, int iovcnt, off_t off);
+
+/**
+ * @brief move up to 'count' bytes from one open file to another in the kernel.
+ * Each end with a NULL offset uses and moves its file offset, otherwise the
+ * offset, in kernel memory, is used and updated instead. Pipes take no offset(-ESPIPE).
+ * splice() takes no 'flags' yet.
+ * @return ssize_t bytes moved, 0 at EOF, or a negated errno.
+ */
+ssize_t sendfile(int out_fd, int in_fd, off_t *offset, size_t count);
+ssize_t splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, uint flags);
+
 int     create(const char *filename, mode_t mode);
 int     mkdirat(int fd, const char *filename, mode_t mode);
 int     mkdir(const char *filename, mode_t mode);
@@ -9,6 +9,7 @@
 #include <fs/icache.h>
 #include <sync/cond.h>
 #include <fs/cred.h>
+#include <sys/_uio.h>
 
 struct  iops;
 struct  dentry;
@@ -187,6 +188,15 @@ ssize_t iread(inode_t *ip, off_t off, void *buf, size_t nb);
 ssize_t iread_data(inode_t *ip, off_t off, void *buf, size_t nb);
 ssize_t iwrite(inode_t *ip, off_t off, void *buf, size_t nb);
 ssize_t iwrite_data(inode_t *ip, off_t off, void *buf, size_t nb);
+
+/**
+ * @brief read(write) the 'iovcnt' buffers in 'iov' at 'off' onwards,
+ * as one transfer to(from) the buffers concatenated. Caller holds ilock(ip).
+ * @return ssize_t bytes transferred, or a negated errno if none were.
+ */
+ssize_t ireadv(inode_t *ip, off_t off, const struct iovec *iov, int iovcnt);
+ssize_t iwritev(inode_t *ip, off_t off, const struct iovec *iov, int iovcnt);
+
 int     ibind(inode_t *dir, struct dentry *dentry, inode_t *ip);
 int     imkdir(inode_t *dir, const char *fname, mode_t mode);
 int     icreate(inode_t *dir, const char *fname, mode_t mode);
@@ -7,7 +7,7 @@
 #include <lib/types.h>
 #include <sync/spinlock.h>
 #include <sys/system.h>
-#include <sync/cond.h>
+#include <sync/waitq.h>
 
 #define PIPE_R      BS(0) //
 #define PIPE_W      BS(1) //
@@ -17,8 +17,7 @@
 
 typedef struct __pipe_t {
     flags32_t   p_flags;
-    cond_t      p_readers;
-    cond_t      p_writers;
+    waitq_t     p_wait;     // readers wait on PIPE_R(data), writers on PIPE_W(space).
     inode_t     *p_iread;
     inode_t     *p_iwrite;
     ringbuf_t   p_ringbuf;
@@ -38,12 +37,20 @@ typedef struct __pipe_t {
 #define pipe_iread(p)                   ({ pipe_assert_locked(p); ((p)->p_iread); })
 #define pipe_iwrite(p)                  ({ pipe_assert_locked(p); ((p)->p_iwrite); })
 
-#define pipe_wake_reader(p)             ({ pipe_assert_locked(p); cond_signal(&(p)->p_readers); })
-#define pipe_wake_all_readers(p)        ({ pipe_assert_locked(p); cond_broadcast(&(p)->p_readers); })
-#define pipe_wake_writer(p)             ({ pipe_assert_locked(p); cond_signal(&(p)->p_writers); })
-#define pipe_wake_all_writers(p)        ({ pipe_assert_locked(p); cond_broadcast(&(p)->p_writers); })
-#define pipe_reader_wait(p)             ({ pipe_assert_locked(p); cond_wait_releasing(&(p)->p_readers, &(p)->p_lock); })
-#define pipe_writer_wait(p)             ({ pipe_assert_locked(p); cond_wait_releasing(&(p)->p_writers, &(p)->p_lock); })
+// waiters queue up under p_lock, so wakers holding it may skip an empty wait queue.
+#define pipe_wake(p, n, key)            ({ pipe_assert_locked(p); if (waitq_active(&(p)->p_wait)) waitq_wake(&(p)->p_wait, (n), (key)); })
+#define pipe_wait(p, key) ({                                        \
+    waitq_entry_t __we = WAITQ_ENTRY(WAITQ_EXCLUSIVE, (key));       \
+    pipe_assert_locked(p);                                          \
+    waitq_wait(&(p)->p_wait, &__we, &(p)->p_lock);                  \
+})
+
+#define pipe_wake_reader(p)             ({ pipe_wake(p, 1, PIPE_R); })
+#define pipe_wake_all_readers(p)        ({ pipe_wake(p, 0, PIPE_R); })
+#define pipe_wake_writer(p)             ({ pipe_wake(p, 1, PIPE_W); })
+#define pipe_wake_all_writers(p)        ({ pipe_wake(p, 0, PIPE_W); })
+#define pipe_reader_wait(p)             ({ pipe_wait(p, PIPE_R); })
+#define pipe_writer_wait(p)             ({ pipe_wait(p, PIPE_W); })
 
 #define pipe_iswritable(p)              ({ pipe_assert_locked(p); pipe_testflags(p, PIPE_W); })
 #define pipe_isreadable(p)              ({ pipe_assert_locked(p); pipe_testflags(p, PIPE_R); })
@@ -55,6 +62,16 @@ typedef struct __pipe_t {
 int     pipefs_init(void);
 int     pipe_mkpipe(pipe_t **pref);
 
+/**
+ * @brief wait until one of the 'events'(PIPE_R, PIPE_W) is ready on the end
+ * 'ip' of a pipe, i.e a read would find data or a write room, without doing it.
+ * A read end is never writable nor a write end readable, asking only for
+ * that waits for the other end to close.
+ * @return int the ready events, -EPIPE if the other end is closed,
+ * -EINTR if current was killed.
+ */
+int     pipe_poll(inode_t *ip, int events);
+
 int     pipefs_iopen(inode_t *idev);
 int     pipefs_isync(inode_t *ip);
 int     pipefs_iclose(inode_t *ip);
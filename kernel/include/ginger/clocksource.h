@@ -0,0 +1,69 @@
+#pragma once
+
+#include <lib/types.h>
+
+/**
+ * @brief Clocksources.
+ * A clocksource is a free-running counter of known frequency. The highest
+ * rated one registered drives CLOCK_MONOTONIC, which counts nanoseconds
+ * since boot. Until something better is registered, the jiffies counter
+ * is used, at SYS_HZ resolution.
+ * Switching to a new clocksource carries the current time over, so the
+ * clock never goes backwards.
+ */
+
+typedef struct clocksource {
+    const char          *cs_name;
+    int                 cs_rating;              // the highest rated clocksource is used.
+    u64                 cs_freq;                // counter ticks per second.
+    u64                 (*cs_read)(void);       // current counter value, must be callable with interrupts disabled.
+    int                 cs_user;                // user mode can read the counter the same way, see vdso.h.
+    u64                 cs_mult;                // ns per tick, 32.32 fixed point(set by clocksource_register()).
+    struct clocksource  *cs_next;
+} clocksource_t;
+
+#define CLOCKSOURCE_INIT(name, rating, freq, read, user) ((clocksource_t){ \
+    .cs_name    = (name),                                                   \
+    .cs_rating  = (rating),                                                 \
+    .cs_freq    = (freq),                                                   \
+    .cs_read    = (read),                                                   \
+    .cs_user    = (user),                                                   \
+})
+
+/**
+ * @brief make 'cs' available, and switch to it if it is the highest rated.
+ * @return int 0 on success, -EINVAL if 'cs' has no frequency or read function.
+ */
+int clocksource_register(clocksource_t *cs);
+
+/**
+ * @brief name of the clocksource in use.
+ */
+const char *clocksource_name(void);
+
+/**
+ * @brief current CLOCK_MONOTONIC time in nanoseconds.
+ */
+u64 clocksource_ns(void);
+
+/**
+ * @brief resolution of clocksource_ns() in nanoseconds.
+ */
+u64 clocksource_res(void);
+
+/**
+ * @brief CLOCK_REALTIME - CLOCK_MONOTONIC in nanoseconds.
+ * Read from the RTC on first use, unless set by clocksource_set_realtime().
+ */
+u64 clocksource_realtime_offset(void);
+
+/**
+ * @brief step CLOCK_REALTIME to 'ns' since the Epoch.
+ */
+void clocksource_set_realtime(u64 ns);
+
+/**
+ * @brief publish the clock to the vDSO data page, once it exists.
+ * Later changes are published as they happen.
+ */
+void clocksource_vdso_sync(void);
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <ds/rbtree.h>
+#include <lib/types.h>
+#include <sync/atomic.h>
+
+/**
+ * @brief High-resolution timers.
+ * Expiries are in nanoseconds of CLOCK_MONOTONIC(see hrtimer_now()).
+ * Each CPU keeps the timers armed on it in a red-black tree ordered by expiry,
+ * and in NOHZ mode programs its local APIC timer one-shot(or in TSC-deadline
+ * mode) for the earliest one, so a timer fires at its own expiry instead of
+ * on the next jiffy. Without a calibrated TSC they are run from the periodic
+ * tick, at jiffy resolution.
+ * Like kernel timers, the function runs on the CPU that armed the timer,
+ * with interrupts disabled.
+ */
+
+struct hrtimer_base;
+
+typedef struct hrtimer {
+    rb_node_t           ht_node;
+    u64                 ht_expires;                 // CLOCK_MONOTONIC ns at which ht_func is due.
+    void                (*ht_func)(struct hrtimer *ht);
+    void                *ht_arg;                    // private to ht_func.
+    struct hrtimer_base *ht_base;                   // base the timer is armed on, NULL if not armed.
+} hrtimer_t;
+
+#define HRTIMER_INIT(func, arg)         ((hrtimer_t){ .ht_func = (func), .ht_arg = (arg) })
+
+// is 'ht' armed? Racy unless the caller serializes with whoever arms it.
+#define hrtimer_pending(ht)             ({ atomic_read(&(ht)->ht_base) != NULL; })
+
+/**
+ * @brief current CLOCK_MONOTONIC time in nanoseconds.
+ */
+u64 hrtimer_now(void);
+
+/**
+ * @brief (re)arm 'ht' to run on the calling CPU at 'expires'.
+ * An 'expires' already past runs on the next timer interrupt.
+ * @return int 1 if 'ht' was armed already, 0 otherwise.
+ */
+int hrtimer_add(hrtimer_t *ht, u64 expires);
+
+/**
+ * @brief disarm 'ht'. Its function may still be running on another CPU.
+ * @return int 1 if 'ht' was armed, 0 otherwise.
+ */
+int hrtimer_del(hrtimer_t *ht);
+
+/**
+ * @brief same as hrtimer_del(), except this also waits for ht_func to return,
+ * disarming 'ht' again if ht_func rearmed it, so 'ht' may be freed after.
+ * Must not be called from ht_func, nor while holding a lock ht_func takes.
+ */
+int hrtimer_del_sync(hrtimer_t *ht);
+
+/**
+ * @brief run the high-resolution timers of the calling CPU that are due.
+ * Called from the timer interrupt.
+ */
+void hrtimer_run(void);
+
+/**
+ * @brief expiry of the earliest timer armed on the calling CPU.
+ * @return int 1 and sets *'expires' if there is one, 0 otherwise.
+ */
+int hrtimer_cpu_next(u64 *expires);
+
+/**
+ * @brief offset to add to CLOCK_MONOTONIC to read 'clock_id'.
+ * @return int 0 on success, -EINVAL if 'clock_id' isn't supported.
+ */
+int hrtimer_clock_offset(clockid_t clock_id, u64 *offset);
@@ -23,7 +23,7 @@
 
 #define NSEC_PER_USEC       (1000)
 #define USEC_PER_SEC        (1000000)
-#define NSEC_PER_SEC        (NSEC_PER_USEC * 1000)
+#define NSEC_PER_SEC        (NSEC_PER_USEC * USEC_PER_SEC)
 
 #define JIFFIES_TO_TIMEVAL(jiffies, tv) ({       \
     do                                           \
@@ -77,8 +77,10 @@ typedef unsigned long jiffies_t;
 void jiffies_update(void);
 void jiffies_timed_wait(double s);
 jiffies_t jiffies_get(void);
-jiffies_t jiffies_sleep(jiffies_t jiffies);
 
-int jiffies_getres(struct timespec *res);
-int jiffies_gettime(struct timespec *tp);
-int jiffies_settime(const struct timespec *tp);
\ No newline at end of file
+/**
+ * @brief sleep for 'jiffies' jiffies.
+ * The sleeper is woken by a kernel timer of its own, not by every tick.
+ * @return jiffies_t jiffies left if current was killed before, 0 otherwise.
+ */
+jiffies_t jiffies_sleep(jiffies_t jiffies);
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <ginger/jiffies.h>
+#include <lib/types.h>
+#include <sync/spinlock.h>
+
+/**
+ * @brief Kernel timers.
+ * Each CPU has a hierarchical timing wheel, timers are armed on the base of the
+ * CPU that arms them and their function runs there, from the tick, with
+ * interrupts disabled. Timers due within KTIMER_TVR_SIZE jiffies go on the first
+ * level, one slot per jiffy. Later ones go on coarser levels whose slots cover
+ * KTIMER_TVN_SIZE times as many jiffies, and are cascaded down a level each
+ * time the level below wraps around.
+ * Arming and cancelling is O(1), a tick only touches the slot that is due,
+ * and a far-future timer is moved at most once per level.
+ */
+
+#define KTIMER_TVN_BITS     6
+#define KTIMER_TVR_BITS     8
+#define KTIMER_TVN_SIZE     (1 << KTIMER_TVN_BITS)
+#define KTIMER_TVR_SIZE     (1 << KTIMER_TVR_BITS)
+#define KTIMER_TVN_MASK     (KTIMER_TVN_SIZE - 1)
+#define KTIMER_TVR_MASK     (KTIMER_TVR_SIZE - 1)
+#define KTIMER_NLEVELS      4   // levels after the first.
+
+// timers further away than this are placed as if due then, and cascaded again.
+#define KTIMER_MAX_DELTA    ((1ul << (KTIMER_TVR_BITS + KTIMER_NLEVELS * KTIMER_TVN_BITS)) - 1)
+
+struct ktimer_base;
+
+typedef struct ktimer {
+    struct ktimer       *tm_next;
+    struct ktimer       **tm_pprev;
+    jiffies_t           tm_expires;                 // jiffy at which tm_func is due.
+    void                (*tm_func)(struct ktimer *tm);
+    void                *tm_arg;                    // private to tm_func.
+    struct ktimer_base  *tm_base;                   // base the timer is armed on, NULL if not armed.
+} ktimer_t;
+
+#define KTIMER_INIT(func, arg)          ((ktimer_t){ .tm_func = (func), .tm_arg = (arg) })
+
+// is 'tm' armed? Racy unless the caller serializes with whoever arms it.
+#define ktimer_pending(tm)              ({ atomic_read(&(tm)->tm_base) != NULL; })
+
+/**
+ * @brief (re)arm 'tm' to run on the calling CPU at jiffy 'expires'.
+ * An 'expires' already past runs on the next tick.
+ * @return int 1 if 'tm' was armed already, 0 otherwise.
+ */
+int ktimer_add(ktimer_t *tm, jiffies_t expires);
+
+/**
+ * @brief disarm 'tm'. Its function may still be running on another CPU.
+ * @return int 1 if 'tm' was armed, 0 otherwise.
+ */
+int ktimer_del(ktimer_t *tm);
+
+/**
+ * @brief same as ktimer_del(), except this also waits for tm_func to return,
+ * so 'tm' may be freed after. Must not be called from tm_func, nor while holding
+ * a lock tm_func takes.
+ */
+int ktimer_del_sync(ktimer_t *tm);
+
+/**
+ * @brief run the timers of the calling CPU that are due.
+ * Called from the tick handler.
+ */
+void ktimer_run(void);
+
+/**
+ * @brief does the calling CPU have timers armed? The tick is kept until it doesn't.
+ */
+int ktimer_cpu_pending(void);
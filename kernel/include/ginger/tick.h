@@ -0,0 +1,73 @@
+#pragma once
+
+#include <lib/limits.h>
+#include <lib/types.h>
+
+/**
+ * @brief Tickless(NOHZ) timer events.
+ * When the TSC is available jiffies are read from it on demand,
+ * and each CPU programs its local APIC timer one-shot(or in TSC-deadline mode)
+ * for its next event only:
+ *  - the expiry of current's timeslice, if other threads are waiting for the CPU.
+ *  - the next jiffy, if this CPU has kernel timers armed(see ktimer_add()),
+ *    sleepers and timed futex waiters included.
+ *  - the next jiffy, if RCU waits for a quiescent state or callbacks on this CPU.
+ *  - the expiry of the earliest high-resolution timer armed on this CPU.
+ * With neither, the tick is stopped altogether.
+ */
+
+// a timeslice that never expires, e.g. SCHED_FIFO's, arms no deadline.
+#define TICK_SLICE_INFINITE (LONG_MAX / 2)
+
+// per-CPU tick state.
+typedef struct tick {
+    u64     t_next;         // jiffy at which the next event is due.
+    int     t_armed;        // is the tick running?
+    u64     t_slice_end;    // jiffy at which current's timeslice expires.
+    int     t_slice_inf;    // current's timeslice never expires.
+} tick_t;
+
+/**
+ * @brief is NOHZ mode active?
+ * @return int non-zero if it is.
+ */
+int tick_nohz_active(void);
+
+/**
+ * @brief initialize the tick on the calling CPU.
+ * Called after the local APIC timer has been calibrated.
+ */
+void tick_init(void);
+
+/**
+ * @brief start a new timeslice for current.
+ *
+ * @param timeslice length of the timeslice in jiffies,
+ * TICK_SLICE_INFINITE or more if it never expires.
+ */
+void tick_start_slice(long timeslice);
+
+/**
+ * @brief (re)program the next timer event on the calling CPU,
+ * or stop the tick if there is none.
+ */
+void tick_program(void);
+
+/**
+ * @brief handle a local APIC timer interrupt in NOHZ mode.
+ */
+void tick_handler(void);
+
+/**
+ * @brief notify 'processor' that it has new work.
+ * Sends a reschedule IPI if 'processor' is not the calling CPU,
+ * otherwise the local tick is reprogrammed.
+ * if 'processor' is NULL all CPUs are notified.
+ */
+void tick_kick(cpu_t *processor);
+
+/**
+ * @brief make the thread running on 'processor' give up the CPU
+ * as soon as possible, e.g. because a more urgent thread was parked there.
+ */
+void tick_preempt(cpu_t *processor);
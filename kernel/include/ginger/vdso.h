@@ -0,0 +1,78 @@
+#pragma once
+
+#include <arch/cpu.h>
+#include <lib/types.h>
+#include <mm/mmap.h>
+
+/**
+ * @brief Virtual dynamic shared object.
+ * Two pages mapped into every process right below the program image:
+ * a read-only data page the kernel keeps up to date, and a text page
+ * holding code(see vdso.asm) that answers clock_gettime(), gettimeofday(),
+ * getpid() and gettid() from it without entering the kernel.
+ *
+ * The text page starts with a table of entry points, VDSO_ENTRY_SIZE bytes
+ * apart. Each returns -1 if it can't answer, the caller then makes the
+ * system call instead.
+ *
+ * The clock parameters are protected by vd_seq. Each CPU has a slot with
+ * the thread it runs, updated on every switch-in; a reader finds its CPU
+ * with RDTSCP(IA32_TSC_AUX holds the APIC ID) and retries if it moved or
+ * the slot changed meanwhile.
+ * NOTE: the layout is shared with vdso.asm and usr/include/ginger/vdso.h.
+ */
+
+#define VDSO_DATA               0x3FFE000ul             // user address of the data page.
+#define VDSO_TEXT               (VDSO_DATA + PAGESZ)    // user address of the text page.
+
+#define VDSO_ENTRY_SIZE         8
+#define VDSO_CLOCK_GETTIME      0   // int (clockid_t clock_id, struct timespec *tp)
+#define VDSO_GETTIMEOFDAY       1   // int (struct timeval *tp, void *tzp)
+#define VDSO_GETPID             2   // pid_t (void)
+#define VDSO_GETTID             3   // tid_t (void)
+
+#define VDSO_CLOCK              BS(0)   // the clocksource is readable from user mode.
+#define VDSO_GETCPU             BS(1)   // RDTSCP returns the APIC ID.
+
+typedef struct vdso_cpu {
+    u32         vc_seq;         // odd while vc_pid and vc_tid are updated.
+    pid_t       vc_pid;         // process running on this CPU.
+    tid_t       vc_tid;         // thread running on this CPU.
+} __aligned(64) vdso_cpu_t;
+
+typedef struct vdso_data {
+    u32         vd_seq;                 // odd while the clock parameters are updated.
+    u32         vd_flags;               // VDSO_CLOCK and VDSO_GETCPU.
+    u64         vd_cycles;              // clocksource value at vd_base.
+    u64         vd_base;                // CLOCK_MONOTONIC ns at vd_cycles.
+    u64         vd_mult;                // ns per clocksource tick, 32.32 fixed point.
+    u64         vd_realtime;            // CLOCK_REALTIME - CLOCK_MONOTONIC, 0 if not read yet.
+    u64         vd_tsc_offset[MAXNCPU]; // see tsc_read().
+    vdso_cpu_t  vd_cpu[MAXNCPU];
+} vdso_data_t;
+
+/**
+ * @brief allocate the vDSO pages, called once at boot.
+ */
+int vdso_init(void);
+
+/**
+ * @brief map the vDSO into 'mmap', which is locked.
+ */
+int vdso_map(mmap_t *mmap);
+
+/**
+ * @brief publish the clocksource parameters,
+ * 'user' is non-zero if user mode can read the clocksource itself.
+ * Calls are serialized by the caller.
+ */
+void vdso_update_clock(int user, u64 cycles, u64 base, u64 mult);
+
+void vdso_update_realtime(u64 offset);
+
+void vdso_update_tsc_offset(int cpuid, u64 offset);
+
+/**
+ * @brief record the thread switched in on the calling CPU.
+ */
+void vdso_switch(pid_t pid, tid_t tid);
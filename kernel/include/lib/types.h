@@ -54,6 +54,12 @@ typedef     union __pixel_t {
 } pixel_t;
 
 
+// deferred callback, see sync/rcu.h.
+typedef struct rcu_head {
+    struct rcu_head *next;
+    void            (*func)(struct rcu_head *head);
+} rcu_head_t;
+
 typedef     long                    time_t;
 typedef     long                    timer_t;
 typedef     long                    clock_t;
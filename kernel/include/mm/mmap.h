@@ -8,6 +8,7 @@
 #include <lib/types.h>
 #include <mm/page.h>
 #include <sync/spinlock.h>
+#include <sync/rwlock.h>
 #include <sys/system.h>
 
 #ifndef foreach
@@ -39,6 +40,7 @@ typedef struct vm_fault_t {
     pte_t       *page;
     uint8_t     user : 1;
     uintptr_t    err_code;
+    struct mmap *mmap;      // faulting address space, its pgt_lock guards the PTE update.
 }vm_fault_t;
 
 typedef struct vmr_ops {
@@ -136,15 +138,21 @@ typedef struct mmap {
     size_t      used_space; // Avalable space, may be non-contigous.
     vmr_t      *vmr_head;   // head of list of virtual memory mapping.
     vmr_t      *vmr_tail;   // tail of list of virtual memory mapping.
-    spinlock_t  lock;
+    rwlock_t    lock;       // write side for changes, read side for page-fault lookups.
+    spinlock_t  pgt_lock;   // serializes page-table updates of faults holding the read side.
 } mmap_t;
 
 #define mmap_assert(mmap)           ({ assert(mmap, "No Memory Map"); })
-#define mmap_lock(mmap)             ({ mmap_assert(mmap); spin_lock(&(mmap)->lock); })
-#define mmap_unlock(mmap)           ({ mmap_assert(mmap); spin_unlock(&(mmap)->lock); })
-#define mmap_trylock(mmap)          ({ mmap_assert(mmap); spin_trylock(&(mmap)->lock); })
-#define mmap_islocked(mmap)         ({ mmap_assert(mmap); spin_islocked(&(mmap)->lock); })
-#define mmap_assert_locked(mmap)    ({ mmap_assert(mmap); spin_assert_locked(&(mmap)->lock); })
+#define mmap_lock(mmap)             ({ mmap_assert(mmap); write_lock(&(mmap)->lock); })
+#define mmap_unlock(mmap)           ({ mmap_assert(mmap); write_unlock(&(mmap)->lock); })
+#define mmap_trylock(mmap)          ({ mmap_assert(mmap); write_trylock(&(mmap)->lock); })
+#define mmap_islocked(mmap)         ({ mmap_assert(mmap); rw_write_islocked(&(mmap)->lock); })
+#define mmap_assert_locked(mmap)    ({ mmap_assert(mmap); rw_write_assert_locked(&(mmap)->lock); })
+
+// shared access, the regions may be looked up but not changed.
+#define mmap_read_lock(mmap)        ({ mmap_assert(mmap); read_lock(&(mmap)->lock); })
+#define mmap_read_unlock(mmap)      ({ mmap_assert(mmap); read_unlock(&(mmap)->lock); })
+#define mmap_assert_held(mmap)      ({ mmap_assert(mmap); rw_assert_held(&(mmap)->lock); })
 
 int mmap_init(mmap_t *mmap);
 
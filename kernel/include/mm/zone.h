@@ -3,6 +3,7 @@
 #include <sync/spinlock.h>
 #include <mm/page.h>
 #include <ds/queue.h>
+#include <sync/pcpu_counter.h>
 
 #define NZONE   4
 
@@ -19,6 +20,9 @@ typedef struct zone_t {
 
 extern zone_t zones[NZONE];
 
+// used pages across all zones, read without taking any zone lock.
+extern pcpu_counter_t zone_upages;
+
 /////////////////////////
 /// zone indeices.  /////
 /////////////////////////
@@ -53,6 +57,9 @@ extern zone_t zones[NZONE];
 
 #define zone_isvalid(z)         ({ zone_flags_test(z, ZONE_VALID); })
 
+// account 'n' more(or less if negative) used pages in a locked zone.
+#define zone_account(z, n)      ({ zone_assert_locked(z); (z)->upages += (n); pcpu_counter_add(&zone_upages, (n)); })
+
 #define zone_size(z)            ({zone_assert(z); (z)->size; })
 #define zone_start(z)           ({zone_assert(z); (z)->start; })
 #define zone_pages(z)           ({zone_assert(z); (z)->pages; })
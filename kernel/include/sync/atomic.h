@@ -11,6 +11,9 @@ typedef unsigned long atomic_t;
 
 #define atomic_read(ptr)               ({ __atomic_load_n((ptr), __ATOMIC_SEQ_CST); })
 #define atomic_write(ptr, val)         ({ __atomic_store_n((ptr), (val), __ATOMIC_SEQ_CST); })
+/// acquire/release ordered load and store, a plain 'mov' on x86_64.
+#define atomic_load_acquire(ptr)       ({ __atomic_load_n((ptr), __ATOMIC_ACQUIRE); })
+#define atomic_store_release(ptr, val) ({ __atomic_store_n((ptr), (val), __ATOMIC_RELEASE); })
 /// clear, only used with 'char' or 'bool'
 #define atomic_clear(ptr)              ({ __atomic_clear((ptr), __ATOMIC_SEQ_CST); })
 
@@ -51,4 +54,4 @@ typedef unsigned long atomic_t;
 
 /// compare and exchange
 /// returns 'true' if the operation was successful, i.e, the and exchange was performed
-#define atomic_cmpxchg(ptr, __exp__, __des__)  ({ __atomic_compare_and_exchange_n((ptr), &(__exp__), (__des__), 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); })
\ No newline at end of file
+#define atomic_cmpxchg(ptr, __exp__, __des__)  ({ __atomic_compare_exchange_n((ptr), &(__exp__), (__des__), 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); })
\ No newline at end of file
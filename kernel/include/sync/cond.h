@@ -2,11 +2,15 @@
 
 #include <ds/queue.h>
 #include <sync/spinlock.h>
+#include <sync/waitq.h>
 
+/**
+ * Waiters sleep exclusively on 'waiters', whose lock guards 'count',
+ * so cond_signal() wakes a single thread.
+ */
 typedef struct cond {
     atomic_t   count;
-    queue_t    waiters;
-    spinlock_t guard;
+    waitq_t    waiters;
 } cond_t;
 
 #define COND_INIT()     ((cond_t){0})
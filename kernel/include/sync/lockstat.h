@@ -0,0 +1,56 @@
+#pragma once
+
+#include <lib/types.h>
+#include <lib/stdint.h>
+#include <lib/stddef.h>
+
+/**
+ * @brief Lock contention statistics(lockstat).
+ * Build with -DLOCKSTAT to have spin_lock() and mutex_lock() account,
+ * per acquisition site(__FILE__:__LINE__), the number of acquisitions,
+ * how many of them were contended, and the wait and hold times in TSC cycles.
+ * Results are read from /proc/lockstat, writing to it resets them.
+ * Without LOCKSTAT the hooks below expand to nothing.
+ */
+typedef struct lockstat {
+    const char          *ls_file;       // acquisition site.
+    int                 ls_line;
+    const char          *ls_kind;       // "spin" or "mutex".
+    int                 ls_registered;  // on lockstat_list.
+    struct lockstat     *ls_next;       // next registered site.
+    u64                 ls_acquired;    // number of acquisitions.
+    u64                 ls_contended;   // acquisitions that had to wait.
+    u64                 ls_wait_sum;    // cycles spent waiting to acquire.
+    u64                 ls_wait_max;
+    u64                 ls_hold_sum;    // cycles the lock was held for.
+    u64                 ls_hold_max;
+} lockstat_t;
+
+// static initializer of the site expanding this macro.
+#define LOCKSTAT_SITE_INIT(kind) { \
+    .ls_file = __FILE__,           \
+    .ls_line = __LINE__,           \
+    .ls_kind = (kind),             \
+}
+
+/**
+ * @brief account an acquisition at 'site' that waited 'wait' cycles.
+ * Registers the site on first use.
+ */
+void lockstat_acquired(lockstat_t *site, int contended, u64 wait);
+
+/**
+ * @brief account a release of a lock taken at 'site' and held for 'hold' cycles.
+ */
+void lockstat_released(lockstat_t *site, u64 hold);
+
+/**
+ * @brief zero the counters of every registered site.
+ */
+void lockstat_reset(void);
+
+/**
+ * @brief format the statistics of every registered site into 'buf'.
+ * @return ssize_t number of bytes written.
+ */
+ssize_t lockstat_show(char *buf, size_t size);
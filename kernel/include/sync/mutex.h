@@ -1,25 +1,99 @@
 #pragma once
 
-#include <ds/queue.h>
+#include <arch/cpu.h>
 #include <sys/sched.h>
 #include <sys/thread.h>
 #include <sync/spinlock.h>
 
+/**
+ * @brief Adaptive mutex.
+ * A contender first spins while the owner is running on another CPU,
+ * as it will likely release the mutex before a sleep and wakeup would complete,
+ * and only then sleeps on an intrusive FIFO list of waiters kept on their own
+ * kernel stacks, so blocking allocates nothing.
+ * mutex_unlock() releases the mutex and wakes the first waiter, which competes
+ * with contenders still spinning. A woken waiter that loses asks for handoff,
+ * the next mutex_unlock() then passes ownership to it directly.
+ *
+ * Mutexes use priority inheritance: a thread that blocks lends its policy and
+ * priority to the owner if they are more urgent, and on along the chain of
+ * owners that are themselves blocked on a mutex, see sched_pi_inherit().
+ * mutex_unlock() drops what the owner no longer needs, i.e. keeps only
+ * the most urgent waiter of the mutexes it still holds.
+ */
+typedef struct mutex_waiter {
+    thread_t            *mw_thread;     // sleeping contender.
+    struct mutex_waiter *mw_next;       // next waiter in FIFO order.
+    int                 mw_handoff;     // set by the waiter: pass the mutex to me on release.
+    int                 mw_woken;       // set by the releaser: taken off the list.
+    int                 mw_granted;     // set by the releaser: the mutex was handed off to me.
+} mutex_waiter_t;
+
+// number of cpu_pause()s a contender spins for before it sleeps.
+#define MUTEX_SPIN_MAX              1024
+
+// longest chain of blocked owners a priority boost is passed along.
+#define MUTEX_PI_MAXDEPTH           8
+
 typedef struct mutex_t mutex_t;
 typedef struct mutex_t {
-    uint8_t     mtx_lock;       // mutex lock ('1' if acquired, '0' if free).
-    char        *mtx_file;
-    size_t      mtx_line;
-    char        *mtx_func;
-    queue_t     mtx_waiters;    // queue for contenders of this mutex
-    thread_t    *mtx_thread;    // thread currently holding the mutex.
-    spinlock_t  mtx_guard;      // spinlock guard for this mutex.
+    uint8_t         mtx_lock;       // mutex lock ('1' if acquired, '0' if free).
+    char            *mtx_file;
+    size_t          mtx_line;
+    char            *mtx_func;
+    thread_t        *mtx_thread;    // thread currently holding the mutex.
+    cpu_t           *mtx_cpu;       // CPU on which mtx_thread acquired the mutex.
+    mutex_waiter_t  *mtx_whead;     // sleeping contenders of this mutex.
+    mutex_waiter_t  *mtx_wtail;
+    struct mutex_t  *mtx_held_next; // next mutex held by mtx_thread(priority inheritance).
+    spinlock_t      mtx_guard;      // spinlock guard for this mutex.
+#if defined(LOCKSTAT)
+    lockstat_t      *mtx_stat;      // site that acquired the mutex.
+    u64             mtx_acquired;   // TSC at acquisition.
+#endif
 } mutex_t;
 
+/**
+ * @brief called with mtx_guard held.
+ * __mutex_lock_slow() is the contended path of mutex_lock(), it returns once the caller owns the mutex.
+ * __mutex_release() releases the mutex or hands it off to the first waiter.
+ */
+void __mutex_lock_slow(mutex_t *mtx);
+void __mutex_release(mutex_t *mtx);
+
 #define MUTEX_INIT()                ((mutex_t){0})
 #define MUTEX_NEW()                 (&MUTEX_INIT())
 
+#if defined(LOCKSTAT)
+#define __mutex_lockstat_acquired(mtx, contended, t0) ({            \
+    static lockstat_t __site = LOCKSTAT_SITE_INIT("mutex");         \
+    u64 __now = rdtsc();                                            \
+    lockstat_acquired(&__site, (contended), __now - (t0));          \
+    (mtx)->mtx_stat     = &__site;                                  \
+    (mtx)->mtx_acquired = __now;                                    \
+})
+
+#define __mutex_lockstat_released(mtx) ({                               \
+    if ((mtx)->mtx_stat)                                                \
+        lockstat_released((mtx)->mtx_stat, rdtsc() - (mtx)->mtx_acquired);\
+    (mtx)->mtx_stat = NULL;                                             \
+})
+#else
+#define __mutex_lockstat_acquired(mtx, contended, t0) ({ (void)(contended); (void)(t0); })
+#define __mutex_lockstat_released(mtx)                ({ (void)(mtx); })
+#endif
+
 #define mutex_assert(mtx)               ({assert(mtx, "No mutex");})
+
+// record current as the owner, called with mtx_guard held.
+#define __mutex_set_owner(mtx) ({                                       \
+    (mtx)->mtx_thread = current;                                        \
+    (mtx)->mtx_cpu = cpu;                                               \
+    if (current) {                                                      \
+        (mtx)->mtx_held_next = current->t_sched.ts_pi_held;             \
+        current->t_sched.ts_pi_held = (mtx);                            \
+    }                                                                   \
+})
 #define mutex_guard_lock(mtx)           ({mutex_assert(mtx); spin_lock(&(mtx)->mtx_guard); })
 #define mutex_guard_unlock(mtx)         ({mutex_assert(mtx); spin_unlock(&(mtx)->mtx_guard); })
 #define mutext_guard_islocked(mtx)      ({mutex_assert(mtx); spin_islocked(&(mtx)->mtx_guard); })
@@ -46,10 +120,11 @@ typedef struct mutex_t {
                (mtx)->mtx_func, thread_gettid(current)); \
     if ((mtx)->mtx_lock == 0) {                          \
         (mtx)->mtx_lock = 1;                             \
-        (mtx)->mtx_thread = current;                     \
+        __mutex_set_owner(mtx);                          \
         (mtx)->mtx_file = __FILE__;                      \
         (mtx)->mtx_line = __LINE__;                      \
         (mtx)->mtx_func = (char *)__func__;              \
+        __mutex_lockstat_acquired(mtx, 0, __lockstat_clock()); \
         locked = 1;                                      \
     }                                                    \
     mutex_guard_unlock(mtx);                             \
@@ -57,6 +132,8 @@ typedef struct mutex_t {
 })
 
 #define mutex_lock(mtx) ({                                \
+    u64 __t0        = __lockstat_clock();                 \
+    int __contended = 0;                                  \
     mutex_guard_lock(mtx);                                \
     assert_msg(!((mtx)->mtx_lock &&                       \
                  ((mtx)->mtx_thread == current)),         \
@@ -68,15 +145,14 @@ typedef struct mutex_t {
     if ((mtx)->mtx_lock == 0)                             \
         (mtx)->mtx_lock = 1;                              \
     else {                                                \
-        current_lock();                                   \
-        sched_sleep(&(mtx)->mtx_waiters,                  \
-                    T_ISLEEP, &(mtx)->mtx_guard);         \
-        current_unlock();                                 \
+        __contended = 1;                                  \
+        __mutex_lock_slow(mtx);                           \
     }                                                     \
-    (mtx)->mtx_thread = current;                          \
+    __mutex_set_owner(mtx);                               \
     (mtx)->mtx_file = __FILE__;                           \
     (mtx)->mtx_line = __LINE__;                           \
     (mtx)->mtx_func = (char *)__func__;                   \
+    __mutex_lockstat_acquired(mtx, __contended, __t0);    \
     mutex_guard_unlock(mtx);                              \
 })
 
@@ -87,11 +163,10 @@ typedef struct mutex_t {
                "Mutex not held: tid: "           \
                "\e[0;013m%ld\e[0m\n",            \
                thread_gettid(current));          \
-    if (sched_wake1(&(mtx)->mtx_waiters))        \
-        (mtx)->mtx_lock = 0;                     \
-    (mtx)->mtx_thread = NULL;                    \
+    __mutex_lockstat_released(mtx);              \
     (mtx)->mtx_file = NULL;                      \
     (mtx)->mtx_line = 0;                         \
     (mtx)->mtx_func = NULL;                      \
+    __mutex_release(mtx);                    \
     mutex_guard_unlock(mtx);                     \
 })
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <lib/types.h>
+#include <sync/atomic.h>
+
+/**
+ * @brief Per-CPU counter.
+ * Each CPU accumulates updates in a slot on cache lines of its own and only
+ * folds them into the shared count once they reach PCPU_COUNTER_BATCH,
+ * so updates from different CPUs rarely touch the same cache line.
+ *
+ * pcpu_counter_read() is a single load of the shared count, which lags
+ * by less than PCPU_COUNTER_BATCH per CPU. pcpu_counter_sum() also adds the
+ * deltas still held by each CPU, it is exact once updates have settled.
+ *
+ * A counter takes a slot on its first update. Once PCPU_COUNTER_MAX slots
+ * are taken, further counters update the shared count directly.
+ * Only atomics are used, counters may be updated under any lock.
+ */
+
+// number of per-CPU slots, i.e. counters that get one.
+#define PCPU_COUNTER_MAX    32
+
+// per-CPU delta at which a CPU folds into the shared count.
+#define PCPU_COUNTER_BATCH  64
+
+typedef struct pcpu_counter {
+    i64     pc_count;   // shared count, per-CPU deltas fold into it.
+    int     pc_slot;    // per-CPU slot + 1, 0 if not assigned yet, -1 if none was left.
+} pcpu_counter_t;
+
+// add 'delta' to 'pc', usually touching only this CPU's slot.
+void pcpu_counter_add(pcpu_counter_t *pc, i64 delta);
+
+// exact value of 'pc', walks the slots of all CPUs.
+i64 pcpu_counter_sum(pcpu_counter_t *pc);
+
+#define pcpu_counter_inc(pc)            ({ pcpu_counter_add((pc), 1); })
+#define pcpu_counter_dec(pc)            ({ pcpu_counter_add((pc), -1); })
+
+// approximate value of 'pc', see above.
+#define pcpu_counter_read(pc)           ({ atomic_read(&(pc)->pc_count); })
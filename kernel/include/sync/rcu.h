@@ -0,0 +1,56 @@
+#pragma once
+
+#include <lib/types.h>
+#include <sync/atomic.h>
+#include <sync/preempt.h>
+
+/**
+ * @brief Read-copy-update.
+ * Readers walk shared structures without taking any lock or writing any shared
+ * cache line, writers unlink objects under their usual locks and hand them to
+ * call_rcu() instead of freeing them, so readers still walking past them are safe.
+ *
+ * A read-side section runs with interrupts disabled, so it can't be preempted and
+ * the CPU can't pass through the scheduler until it ends. Any point at which a CPU
+ * is known to be outside of one is a quiescent state:
+ *  - each pass of schedule() through its loop.
+ *  - a trap taken while interrupts were enabled.
+ * A grace period ends once every online CPU went through a quiescent state after it
+ * started, callbacks queued before it started then run from schedule().
+ * Read-side sections may nest but must not sleep.
+ */
+
+#define rcu_read_lock()             ({ pushcli(); })
+#define rcu_read_unlock()           ({ popcli(); })
+
+// load a pointer published with rcu_assign_pointer().
+#define rcu_dereference(p)          ({ atomic_load_acquire(&(p)); })
+
+// publish 'v' to readers, stores initializing *v are visible first.
+#define rcu_assign_pointer(p, v)    ({ atomic_store_release(&(p), (v)); })
+
+/**
+ * @brief run 'func(head)' once all read-side sections
+ * currently in progress on any CPU have ended.
+ * 'head' is usually embedded in the object to be freed.
+ */
+void call_rcu(rcu_head_t *head, void (*func)(rcu_head_t *head));
+
+/**
+ * @brief report a quiescent state for the calling CPU.
+ * Must not be called from within a read-side section.
+ */
+void rcu_quiescent(void);
+
+/**
+ * @brief report a quiescent state, start grace periods for callbacks
+ * queued on the calling CPU and run those whose grace period ended.
+ * Called from schedule().
+ */
+void rcu_process(void);
+
+/**
+ * @brief is the calling CPU holding up a grace period or
+ * does it have callbacks queued? The tick is kept until it doesn't.
+ */
+int rcu_pending(void);
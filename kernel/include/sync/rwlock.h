@@ -0,0 +1,121 @@
+#pragma once
+
+#include <sync/spinlock.h>
+
+/**
+ * @brief Reader-writer spinlock.
+ * Any number of readers may hold the lock at once, a writer holds it alone.
+ * write_lock() first takes 'rw_wlock', which keeps new readers out,
+ * then waits for the readers already inside to leave, so writers are not starved.
+ *
+ * Both sides run with interrupts disabled, like spinlock sections.
+ * Read sections must not nest: the inner read_lock() would wait on a writer
+ * that is itself waiting for the outer section to end.
+ * Readers are not tracked individually, so only the write side can be asserted
+ * to be held by the caller.
+ */
+typedef struct rwlock {
+    atomic_t    rw_readers; // number of readers inside the lock.
+    spinlock_t  rw_wlock;   // held by the writer, blocks new readers.
+} rwlock_t;
+
+#define RWLOCK_INIT() ((rwlock_t){   \
+    .rw_readers = 0,                 \
+    .rw_wlock   = {                  \
+        .s_ticket = 0,               \
+        .s_tid    = 0,               \
+        .s_apicid = -1,              \
+    },                               \
+})
+
+#define RWLOCK_NEW() (&RWLOCK_INIT())
+#define RWLOCK(name) rwlock_t *name = RWLOCK_NEW()
+
+#define rw_assert(rw) ({ assert(rw, "No rwlock"); })
+
+// is the write side held by the caller?
+#define rw_write_islocked(rw) ({ rwlock_t *__rw = (rw); rw_assert(__rw); spin_islocked(&__rw->rw_wlock); })
+
+// is the lock held for reading by anyone or for writing by the caller?
+#define rw_isheld(rw) ({                                                \
+    rwlock_t *__rw = (rw);                                              \
+    rw_assert(__rw);                                                    \
+    atomic_read(&__rw->rw_readers) || spin_islocked(&__rw->rw_wlock);   \
+})
+
+#define rw_write_assert_locked(rw) ({                                   \
+    assert_msg(                                                         \
+        rw_write_islocked((rw)),                                        \
+        "%s:%d: current[tid: %d, cpu: %d] "                             \
+        "ret-> %p, rwlock MUST be write locked!\n",                     \
+        __FILE__, __LINE__, thread_self(), getcpuid(), __retaddr(0));   \
+})
+
+#define rw_assert_held(rw) ({                                           \
+    assert_msg(                                                         \
+        rw_isheld((rw)),                                                \
+        "%s:%d: current[tid: %d, cpu: %d] "                             \
+        "ret-> %p, rwlock MUST be held!\n",                             \
+        __FILE__, __LINE__, thread_self(), getcpuid(), __retaddr(0));   \
+})
+
+#define read_lock(rw) ({                                                \
+    rwlock_t *__rw = (rw);                                              \
+    rw_assert(__rw);                                                    \
+    pushcli();                                                          \
+    assert_msg(                                                         \
+        !spin_islocked(&__rw->rw_wlock),                                \
+        "%s:%d: cpu: %d, tid: %d, ret -> %p "                           \
+        "read_lock() while holding the write lock.\n",                  \
+        __FILE__, __LINE__, getcpuid(), thread_self(), __retaddr(0));   \
+    for (;;) {                                                          \
+        while (__spin_held(&__rw->rw_wlock))                            \
+            cpu_pause();                                                \
+        atomic_inc(&__rw->rw_readers);                                  \
+        if (!__spin_held(&__rw->rw_wlock))                              \
+            break;                                                      \
+        /* lost the race against a writer, let it go first. */          \
+        atomic_dec(&__rw->rw_readers);                                  \
+    }                                                                   \
+})
+
+#define read_unlock(rw) ({                                              \
+    rwlock_t *__rw = (rw);                                              \
+    rw_assert(__rw);                                                    \
+    assert_msg(                                                         \
+        atomic_read(&__rw->rw_readers),                                 \
+        "%s:%d: cpu: %d, tid: %d, ret -> %p "                           \
+        "read_unlock() of an rwlock not held for reading.\n",           \
+        __FILE__, __LINE__, getcpuid(), thread_self(), __retaddr(0));   \
+    atomic_dec(&__rw->rw_readers);                                      \
+    popcli();                                                           \
+})
+
+#define write_lock(rw) ({                                               \
+    rwlock_t *__rw = (rw);                                              \
+    rw_assert(__rw);                                                    \
+    spin_lock(&__rw->rw_wlock);                                         \
+    while (atomic_read(&__rw->rw_readers))                              \
+        cpu_pause();                                                    \
+})
+
+/**
+ * @brief take the write side only if the lock is free.
+ * @return int 1 if the lock was acquired, 0 otherwise.
+ */
+#define write_trylock(rw) ({                                            \
+    rwlock_t *__rw = (rw);                                              \
+    rw_assert(__rw);                                                    \
+    int __locked = spin_trylock(&__rw->rw_wlock);                       \
+    if (__locked && atomic_read(&__rw->rw_readers)) {                   \
+        spin_unlock(&__rw->rw_wlock);                                   \
+        __locked = 0;                                                   \
+    }                                                                   \
+    __locked;                                                           \
+})
+
+#define write_unlock(rw) ({                                             \
+    rwlock_t *__rw = (rw);                                              \
+    rw_assert(__rw);                                                    \
+    spin_unlock(&__rw->rw_wlock);                                       \
+})
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <sync/spinlock.h>
+
+/**
+ * @brief Sequence counter.
+ * Writers make the count odd while they update the protected data and even again after.
+ * Readers take no lock at all: they sample the count, read the data and retry
+ * if the count was odd or has changed meanwhile.
+ * Suitable for small read-mostly data, and for structures whose nodes are never
+ * freed while readers may still be walking them.
+ * Writers must be serialized by the caller, see seqlock_t.
+ *
+ * usage:
+ *      u32 seq;
+ *      do {
+ *          seq = read_seqbegin(sl);
+ *          ...read...
+ *      } while (read_seqretry(sl, seq));
+ */
+typedef struct seqcount {
+    u32         sc_seq;     // odd while a write is in progress.
+} seqcount_t;
+
+#define SEQCOUNT_INIT() ((seqcount_t){ .sc_seq = 0 })
+
+#define read_seqcount_begin(sc) ({                              \
+    seqcount_t *__sc = (sc);                                    \
+    u32 __seq;                                                  \
+    while ((__seq = atomic_load_acquire(&__sc->sc_seq)) & 1)    \
+        cpu_pause();                                            \
+    __seq;                                                      \
+})
+
+// loads are not reordered with other loads on x86_64, a compiler barrier is enough.
+#define read_seqcount_retry(sc, seq) ({                 \
+    barrier();                                          \
+    atomic_load_acquire(&(sc)->sc_seq) != (seq);        \
+})
+
+// a locked RMW is a full barrier, data stores can't move across it.
+#define write_seqcount_begin(sc)    ({ atomic_inc(&(sc)->sc_seq); })
+#define write_seqcount_end(sc)      ({ atomic_inc(&(sc)->sc_seq); })
+
+/**
+ * @brief Sequence counter with a spinlock serializing the writers.
+ */
+typedef struct seqlock {
+    seqcount_t  sl_count;
+    spinlock_t  sl_lock;
+} seqlock_t;
+
+#define SEQLOCK_INIT() ((seqlock_t){  \
+    .sl_count = { .sc_seq = 0 },      \
+    .sl_lock  = {                     \
+        .s_ticket = 0,                \
+        .s_tid    = 0,                \
+        .s_apicid = -1,               \
+    },                                \
+})
+
+#define SEQLOCK_NEW() (&SEQLOCK_INIT())
+#define SEQLOCK(name) seqlock_t *name = SEQLOCK_NEW()
+
+#define read_seqbegin(sl)           ({ read_seqcount_begin(&(sl)->sl_count); })
+#define read_seqretry(sl, seq)      ({ read_seqcount_retry(&(sl)->sl_count, (seq)); })
+
+#define write_seqlock(sl) ({                            \
+    seqlock_t *__sl = (sl);                             \
+    spin_lock(&__sl->sl_lock);                          \
+    write_seqcount_begin(&__sl->sl_count);              \
+})
+
+#define write_sequnlock(sl) ({                          \
+    seqlock_t *__sl = (sl);                             \
+    write_seqcount_end(&__sl->sl_count);                \
+    spin_unlock(&__sl->sl_lock);                        \
+})
+
+#define write_seqlock_assert_locked(sl) ({ spin_assert_locked(&(sl)->sl_lock); })
@@ -6,28 +6,84 @@
 #include <lib/printk.h>
 #include <lib/types.h>
 #include <lib/stdint.h>
+#include <sync/lockstat.h>
 
 extern tid_t thread_self(void);
 
+/**
+ * @brief Ticket spinlock.
+ * spin_lock() takes a ticket with a single atomic add and spins reading
+ * only 's_owner' until its ticket is served, so waiters are served in FIFO order.
+ * spin_unlock() hands the lock to the next ticket with a single store.
+ *
+ * The holder(s_tid, or s_apicid when no thread is running) is always kept
+ * because spin_islocked() answers "do I hold this lock?".
+ * Build with -DSPINLOCK_DEBUG to also record the file and line of the acquisition,
+ * and with -DLOCKSTAT to account contention per acquisition site(see sync/lockstat.h).
+ */
 typedef struct __spinlock_t {
-    uint8_t s_guard;  // protects(guards) this structure.
-    tid_t s_tid;      // thread ID of currently holding thread.
-    uint8_t s_lock;   // A 1 in this bit position signifies that the lock is held.
-    uint8_t s_apicid; // APIC ID of currently holding CPU.
+    union {
+        u64     s_ticket;   // both halves below, used by spin_trylock().
+        struct {
+            u32 s_owner;    // ticket currently being served.
+            u32 s_next;     // next ticket to hand out.
+        };
+    };
+    tid_t       s_tid;      // thread ID of currently holding thread.
+    int         s_apicid;   // APIC ID of currently holding CPU.
 
-    // for debugging.
+#if defined(SPINLOCK_DEBUG)
+    char        *s_file;    // source file in which this lock was held.
+    int         s_line;     // line at which this lock is held.
+#endif
 
-    char *s_file; // source file in which this lock was held.
-    int s_line;   // line at which this lock is held.
+#if defined(LOCKSTAT)
+    lockstat_t  *s_stat;    // site that acquired the lock.
+    u64         s_acquired; // TSC at acquisition.
+#endif
 } spinlock_t;
 
+#if defined(SPINLOCK_DEBUG)
+#define __SPINLOCK_DEBUG_INIT   .s_file = NULL, .s_line = 0,
+#define __spin_site(lk)         ({ (lk)->s_file = __FILE__; (lk)->s_line = __LINE__; })
+#define __spin_clear_site(lk)   ({ (lk)->s_file = NULL; (lk)->s_line = 0; })
+#define __spin_file(lk)         ((lk)->s_file ? (lk)->s_file : "n/a")
+#define __spin_line(lk)         ((lk)->s_line)
+#else
+#define __SPINLOCK_DEBUG_INIT
+#define __spin_site(lk)         ({ (void)(lk); })
+#define __spin_clear_site(lk)   ({ (void)(lk); })
+#define __spin_file(lk)         ("n/a")
+#define __spin_line(lk)         (0)
+#endif
+
+#if defined(LOCKSTAT)
+#define __lockstat_clock()      rdtsc()
+
+#define __spin_lockstat_acquired(lk, contended, t0) ({              \
+    static lockstat_t __site = LOCKSTAT_SITE_INIT("spin");          \
+    u64 __now = rdtsc();                                            \
+    lockstat_acquired(&__site, (contended), __now - (t0));          \
+    (lk)->s_stat     = &__site;                                     \
+    (lk)->s_acquired = __now;                                       \
+})
+
+#define __spin_lockstat_released(lk) ({                             \
+    if ((lk)->s_stat)                                               \
+        lockstat_released((lk)->s_stat, rdtsc() - (lk)->s_acquired);\
+    (lk)->s_stat = NULL;                                            \
+})
+#else
+#define __lockstat_clock()      (0)
+#define __spin_lockstat_acquired(lk, contended, t0) ({ (void)(contended); (void)(t0); })
+#define __spin_lockstat_released(lk)                ({ (void)(lk); })
+#endif
+
 #define SPINLOCK_INIT() ((spinlock_t){ \
-    .s_guard = 0,                      \
-    .s_lock = 0,                       \
+    .s_ticket = 0,                     \
     .s_tid = 0,                        \
-    .s_line = 0,                       \
     .s_apicid = -1,                    \
-    .s_file = NULL,                    \
+    __SPINLOCK_DEBUG_INIT              \
 })
 
 #define SPINLOCK_NEW() (&SPINLOCK_INIT())
@@ -35,21 +91,26 @@ typedef struct __spinlock_t {
 
 #define spin_assert(lk) ({ assert(lk, "No spinlock"); })
 
-#define spin_islocked(lk) ({                                                                \
-    spin_assert(lk);                                                                        \
-    pushcli();                                                                              \
-    while (atomic_test_and_set(&(lk)->s_guard))                                             \
-    {                                                                                       \
-        popcli();                                                                           \
-        cpu_pause();                                                                        \
-        pushcli();                                                                          \
-    }                                                                                       \
-    barrier();                                                                              \
-    int locked = (lk)->s_tid ? (lk)->s_tid == thread_self() : (lk)->s_apicid == getcpuid(); \
-    locked = (lk)->s_lock && locked;                                                        \
-    atomic_clear(&(lk)->s_guard);                                                           \
-    popcli();                                                                               \
-    locked;                                                                                 \
+// is the lock held by anyone?
+#define __spin_held(lk)         (atomic_read(&(lk)->s_owner) != atomic_read(&(lk)->s_next))
+
+// is the holder recorded in the lock the caller?
+#define __spin_self(lk)         ((lk)->s_tid ? (lk)->s_tid == thread_self() \
+                                             : (lk)->s_apicid == getcpuid())
+
+#define __spin_set_owner(lk) ({         \
+    (lk)->s_apicid  = getcpuid();       \
+    (lk)->s_tid     = thread_self();    \
+    __spin_site(lk);                    \
+})
+
+#define spin_islocked(lk) ({                            \
+    spinlock_t *__lk = (lk);                            \
+    spin_assert(__lk);                                  \
+    pushcli();                                          \
+    int locked = __spin_held(__lk) && __spin_self(__lk);\
+    popcli();                                           \
+    locked;                                             \
 })
 
 #define spin_assert_locked(lk) ({                                     \
@@ -61,65 +122,61 @@ typedef struct __spinlock_t {
 })
 
 #define spin_lock(lk) ({                                                 \
-    spin_assert(lk);                                                     \
+    spinlock_t *__lk = (lk);                                             \
+    spin_assert(__lk);                                                   \
     pushcli();                                                           \
-    loop()                                                               \
-    {                                                                    \
-        while (atomic_test_and_set(&(lk)->s_guard))                      \
-        {                                                                \
-            popcli();                                                    \
-            cpu_pause();                                                 \
-            pushcli();                                                   \
-        }                                                                \
-        barrier();                                                       \
-        if ((lk)->s_lock == 0)                                           \
-            break;                                                       \
-        int self = (lk)->s_tid ? (lk)->s_tid == thread_self()            \
-                               : (lk)->s_apicid == getcpuid();           \
-        assert_msg(                                                      \
-            self == 0,                                                   \
-            "%s:%d: cpu: %d, state[tid: %d, cpu: %d, ret -> %p] "        \
-            "Spinlock held at [%s:%d].\n",                               \
-            __FILE__, __LINE__, getcpuid(), (lk)->s_tid, (lk)->s_apicid, \
-            __retaddr(0), (lk)->s_file, (lk)->s_line);                   \
-        atomic_clear(&(lk)->s_guard);                                    \
+    assert_msg(                                                          \
+        !(__spin_held(__lk) && __spin_self(__lk)),                       \
+        "%s:%d: cpu: %d, state[tid: %d, cpu: %d, ret -> %p] "            \
+        "Spinlock held at [%s:%d].\n",                                   \
+        __FILE__, __LINE__, getcpuid(), __lk->s_tid, __lk->s_apicid,     \
+        __retaddr(0), __spin_file(__lk), __spin_line(__lk));             \
+    u64 __t0        = __lockstat_clock();                                \
+    int __contended = 0;                                                 \
+    u32 __ticket    = atomic_fetch_add(&__lk->s_next, 1);                \
+    while (atomic_load_acquire(&__lk->s_owner) != __ticket) {            \
+        __contended = 1;                                                 \
+        cpu_pause();                                                     \
     }                                                                    \
-    (lk)->s_lock = 1;                                                    \
-    (lk)->s_line = __LINE__;                                             \
-    (lk)->s_file = __FILE__;                                             \
-    (lk)->s_apicid = getcpuid();                                         \
-    (lk)->s_tid = thread_self();                                         \
-    barrier();                                                           \
-    atomic_clear(&(lk)->s_guard);                                        \
+    __spin_set_owner(__lk);                                              \
+    __spin_lockstat_acquired(__lk, __contended, __t0);                   \
+})
+
+/**
+ * @brief take the lock only if it is free.
+ * @return int 1 if the lock was acquired, 0 otherwise.
+ */
+#define spin_trylock(lk) ({                                              \
+    spinlock_t *__lk = (lk);                                             \
+    spin_assert(__lk);                                                   \
+    pushcli();                                                           \
+    u64 __old = atomic_read(&__lk->s_ticket);                            \
+    int __locked = (u32)__old == (u32)(__old >> 32) &&                   \
+        atomic_cmpxchg(&__lk->s_ticket, __old, __old + BS(32));          \
+    if (__locked) {                                                      \
+        __spin_set_owner(__lk);                                          \
+        __spin_lockstat_acquired(__lk, 0, __lockstat_clock());           \
+    } else                                                               \
+        popcli();                                                        \
+    __locked;                                                            \
 })
 
 #define spin_unlock(lk) ({                                                 \
-    spin_assert(lk);                                                       \
-    pushcli();                                                             \
-    while (atomic_test_and_set(&(lk)->s_guard))                            \
-    {                                                                      \
-        popcli();                                                          \
-        cpu_pause();                                                       \
-        pushcli();                                                         \
-    }                                                                      \
-    barrier();                                                             \
-    int self = (lk)->s_tid ? (lk)->s_tid == thread_self()                  \
-                           : (lk)->s_apicid == getcpuid();                 \
+    spinlock_t *__lk = (lk);                                               \
+    spin_assert(__lk);                                                     \
     assert_msg(                                                            \
-        (self && (lk)->s_lock),                                            \
+        (__spin_held(__lk) && __spin_self(__lk)),                          \
         "%s:%d: current[tid: %d, cpu: %d]"                                 \
         "Spinlock not held"                                                \
-        " state[tid: %d, cpu: %d, %s at %s:%d: ret -> %p]\n",                \
+        " state[tid: %d, cpu: %d, %s at %s:%d: ret -> %p]\n",              \
         __FILE__, __LINE__, thread_self(), getcpuid(),                     \
-        (lk)->s_tid, (lk)->s_apicid, (lk)->s_lock ? "locked" : "unlocked", \
-        (lk)->s_file ? (lk)->s_file : "n/a", (lk)->s_line, __retaddr(0));  \
-    (lk)->s_lock = 0;                                                      \
-    (lk)->s_line = 0;                                                      \
-    (lk)->s_file = NULL;                                                   \
-    (lk)->s_apicid = -1;                                                   \
-    (lk)->s_tid = 0;                                                       \
-    barrier();                                                             \
-    atomic_clear(&(lk)->s_guard);                                          \
-    popcli();                                                              \
+        __lk->s_tid, __lk->s_apicid,                                       \
+        __spin_held(__lk) ? "locked" : "unlocked",                         \
+        __spin_file(__lk), __spin_line(__lk), __retaddr(0));               \
+    __spin_lockstat_released(__lk);                                        \
+    __spin_clear_site(__lk);                                               \
+    __lk->s_apicid  = -1;                                                  \
+    __lk->s_tid     = 0;                                                   \
+    atomic_store_release(&__lk->s_owner, __lk->s_owner + 1);               \
     popcli();                                                              \
 })
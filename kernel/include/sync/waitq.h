@@ -0,0 +1,97 @@
+#pragma once
+
+#include <ds/queue.h>
+#include <lib/types.h>
+#include <sync/spinlock.h>
+
+/**
+ * @brief Wait queue.
+ * Waiters are entries kept on their own kernel stacks, each one carries its
+ * thread on a private sleep queue so signals still reach it through thread_wake().
+ *
+ * A waker walks the entries in order and wakes those that match:
+ *  - an entry with a non-zero we_key is only woken by wakes whose key intersects it,
+ *    so one queue can serve waiters on different events.
+ *  - an entry with a we_func is only woken if we_func(entry, key) returns non-zero,
+ *    so the waker can check the waiter's condition without scheduling it.
+ * Exclusive entries(WAITQ_EXCLUSIVE) are queued after all others and a wake only
+ * takes as many of them as it was asked for, e.g. one for a resource only one
+ * waiter can get, instead of waking all of them to fight over it.
+ */
+
+#define WAITQ_EXCLUSIVE     BS(0)   // count against the number of exclusive waiters to wake.
+
+struct waitq_entry;
+
+/**
+ * @brief wake callback, called with the wait queue locked.
+ * @return int non-zero if the entry is to be woken.
+ */
+typedef int (*waitq_func_t)(struct waitq_entry *we, unsigned long key);
+
+typedef struct waitq_entry {
+    struct waitq_entry  *we_next;
+    struct waitq_entry  *we_prev;
+    int                 we_flags;   // WAITQ_* flags.
+    int                 we_woken;   // set by the waker that took the entry off the queue.
+    unsigned long       we_key;     // events waited for, 0 matches any wake.
+    waitq_func_t        we_func;    // optional wake condition.
+    void                *we_data;   // private to we_func.
+    queue_t             we_queue;   // sleep queue holding only the waiting thread.
+} waitq_entry_t;
+
+typedef struct waitq {
+    waitq_entry_t   *wq_head;
+    waitq_entry_t   *wq_tail;
+    spinlock_t      wq_lock;
+} waitq_t;
+
+#define WAITQ_INIT()                    ((waitq_t){0})
+#define WAITQ_NEW()                     (&WAITQ_INIT())
+#define WAITQ(name)                     waitq_t *name = WAITQ_NEW()
+
+#define WAITQ_ENTRY(flags, key)         ((waitq_entry_t){ .we_flags = (flags), .we_key = (key), .we_queue = QUEUE_INIT() })
+
+#define waitq_assert(wq)                ({ assert((wq), "No wait queue"); })
+#define waitq_lock(wq)                  ({ waitq_assert(wq); spin_lock(&(wq)->wq_lock); })
+#define waitq_unlock(wq)                ({ waitq_assert(wq); spin_unlock(&(wq)->wq_lock); })
+#define waitq_islocked(wq)              ({ waitq_assert(wq); spin_islocked(&(wq)->wq_lock); })
+#define waitq_assert_locked(wq)         ({ waitq_assert(wq); spin_assert_locked(&(wq)->wq_lock); })
+
+/**
+ * @brief are there waiters? Only reliable if the caller holds a lock
+ * waiters also hold until they are queued(see waitq_wait()),
+ * such wakers use it to skip taking the lock of an empty queue.
+ */
+#define waitq_active(wq)                ({ waitq_assert(wq); atomic_read(&(wq)->wq_head) != NULL; })
+
+/**
+ * @brief put current to sleep on 'wq' until an entry 'we' is woken.
+ * Called and returns with 'wq' locked, which is released while asleep.
+ * May return early, e.g. when current is woken by a signal,
+ * callers recheck their condition.
+ * @return int 0 on wakeup, -EINTR if current was killed.
+ */
+int waitq_sleep(waitq_t *wq, waitq_entry_t *we);
+
+/**
+ * @brief same as waitq_sleep(), except 'wq' is locked here
+ * and 'lk', if non-null, is released while asleep and reacquired before returning.
+ * Wakers holding 'lk' can't miss the waiter.
+ */
+int waitq_wait(waitq_t *wq, waitq_entry_t *we, spinlock_t *lk);
+
+/**
+ * @brief wake the entries of 'wq' matching 'key'.
+ * Called with 'wq' locked.
+ * @param nexclusive exclusive entries to wake, 0 wakes all of them.
+ * @param key event being signaled, 0 matches every entry.
+ * @return size_t number of entries woken.
+ */
+size_t __waitq_wake(waitq_t *wq, size_t nexclusive, unsigned long key);
+
+// same as __waitq_wake(), except 'wq' is locked here.
+size_t waitq_wake(waitq_t *wq, size_t nexclusive, unsigned long key);
+
+#define waitq_wake1(wq)                 ({ waitq_wake((wq), 1, 0); })
+#define waitq_wakeall(wq)               ({ waitq_wake((wq), 0, 0); })
@@ -112,6 +112,14 @@ extern int pause(void);
 extern int raise(int signo);
 extern int kill(pid_t pid, int signo);
 extern unsigned long alarm(unsigned sec);
+
+struct ktimer;
+// proc_t.p_alarm's function, sends SIGALRM to the process.
+extern void trigger_alarm(struct ktimer *tm);
+
+struct proc;
+// delete the timers created by timer_create(), called as 'proc' is freed.
+extern void timer_delete_all(struct proc *proc);
 extern sigfunc_t signal(int signo, sigfunc_t func);
 
 #define SIG_BLOCK   (1)
@@ -200,6 +208,15 @@ typedef struct {
     union sigval    si_value;   /* Signal value */
 } siginfo_t;
 
+#define SIGEV_NONE      0   // nothing is delivered on expiry.
+#define SIGEV_SIGNAL    1   // sigev_signo is sent to the process.
+
+struct sigevent {
+    int             sigev_notify;   /* Notification type */
+    int             sigev_signo;    /* Signal number */
+    union sigval    sigev_value;    /* Signal value */
+};
+
 typedef struct __uc_stack_t {
     void    *ss_sp;     /* stack base or pointer */
     size_t  ss_size;    /* stack size */
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <bits/errno.h>
+#include <lib/stddef.h>
+#include <lib/types.h>
+
+#define IOV_MAX 1024    // most buffers one readv()/writev() takes.
+
+struct iovec {
+    void    *iov_base;  // start of the buffer.
+    size_t  iov_len;    // bytes in the buffer.
+};
+
+/**
+ * @brief total length of a kernel copy of an I/O vector,
+ * checked once before any of it is transferred.
+ * @return ssize_t the total, -EINVAL if 'iovcnt' is out of range
+ * or the total does not fit the return value of a transfer.
+ */
+static inline ssize_t iov_length(const struct iovec *iov, int iovcnt) {
+    size_t total = 0;
+
+    if (iov == NULL || iovcnt < 0 || iovcnt > IOV_MAX)
+        return -EINVAL;
+
+    for (int i = 0; i < iovcnt; ++i) {
+        if (iov[i].iov_len > (size_t)__LONG_MAX__ - total)
+            return -EINVAL;
+        total += iov[i].iov_len;
+    }
+    return total;
+}
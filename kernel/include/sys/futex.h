@@ -0,0 +1,41 @@
+#pragma once
+
+#include <lib/stdint.h>
+#include <lib/types.h>
+#include <sys/_time.h>
+#include <ginger/jiffies.h>
+
+#define FUTEX_WAIT              0   // sleep if *uaddr == val.
+#define FUTEX_WAKE              1   // wake up to val waiters on uaddr.
+#define FUTEX_REQUEUE           3   // wake up to val waiters, move up to val2 others to uaddr2.
+#define FUTEX_WAIT_BITSET       9   // FUTEX_WAIT, only woken by wakes whose bitset intersects val3.
+#define FUTEX_WAKE_BITSET       10  // FUTEX_WAKE, only waking waiters whose bitset intersects val3.
+
+/**
+ * The futex word is only ever used within the calling process,
+ * the key is the virtual address and the lookup is skipped.
+ */
+#define FUTEX_PRIVATE_FLAG      128
+#define FUTEX_CMD_MASK          (~FUTEX_PRIVATE_FLAG)
+
+#define FUTEX_BITSET_MATCH_ANY  0xffffffff
+
+/**
+ * @brief Fast userspace mutex.
+ * Threads block on a 32-bit word in their address space. The uncontended path
+ * never enters the kernel, FUTEX_WAIT sleeps only if the word still holds the
+ * value the caller last saw, so wakes issued in between can't be lost.
+ *
+ * @param uaddr     4-byte aligned futex word.
+ * @param op        FUTEX_* command, optionally or'ed with FUTEX_PRIVATE_FLAG.
+ * @param val       expected value for waits, number of waiters to wake for wakes.
+ * @param timeout   relative timeout for waits(NULL waits forever),
+ *                  number of waiters to move for FUTEX_REQUEUE.
+ * @param uaddr2    target futex word of FUTEX_REQUEUE.
+ * @param val3      bitset of the *_BITSET commands.
+ * @return long     number of waiters woken(plus requeued) for wakes, 0 for waits.
+ *                  -EAGAIN if *uaddr != val, -ETIMEDOUT, -EINTR,
+ *                  -EINVAL or -EFAULT on bad arguments.
+ */
+long futex(u32 *uaddr, int op, u32 val, const struct timespec *timeout, u32 *uaddr2, u32 val3);
+
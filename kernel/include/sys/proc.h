@@ -2,6 +2,7 @@
 
 #include <bits/errno.h>
 #include <ds/queue.h>
+#include <ginger/ktimer.h>
 #include <fs/cred.h>
 #include <lib/stdint.h>
 #include <lib/stddef.h>
@@ -20,6 +21,8 @@ typedef enum status_t {
     P_ZOMBIE,
 } status_t;
 
+struct posix_timer;
+
 typedef struct proc {
     pid_t           pid;            // process' ID.
     pid_t           sid;            // process' sid
@@ -43,8 +46,12 @@ typedef struct proc {
     thread_t        *main_thread;
     cond_t          child_event;    // process' child wait-event condition.
     queue_t         children;       // process' children queue.
+    ktimer_t        p_alarm;        // SIGALRM timer armed by alarm().
+    struct posix_timer *p_timers;   // timers created by timer_create().
+    timer_t         p_timerid;      // last timer ID handed out.
 
     spinlock_t      lock;           // lock to protect this structure.
+    rcu_head_t      p_rcu;          // defers the free past procQ lookups.
 } proc_t;
 
 #define NPROC                   (32786)
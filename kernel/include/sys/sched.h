@@ -12,7 +12,33 @@ extern int sched_init(void);
 #define SCHED_HIGHEST_PRIORITY  0
 #define SCHED_LOWEST_PRIORITY 255
 
-#define SCHED_LEVEL(p) ((p) / ((SCHED_LOWEST_PRIORITY + 1) / NLEVELS))
+#define SCHED_LEVEL_WIDTH       ((SCHED_LOWEST_PRIORITY + 1) / NLEVELS)
+#define SCHED_LEVEL(p) ((p) / SCHED_LEVEL_WIDTH)
+
+// real-time priorities, a higher value is more urgent.
+#define SCHED_RT_NPRIO          32
+#define SCHED_RT_MINPRIO        1
+#define SCHED_RT_MAXPRIO        (SCHED_RT_NPRIO - 1)
+
+// scheduling policies.
+#define SCHED_RR    0   // real-time, round-robin among equal priorities.
+#define SCHED_MLFQ  1   // multi-level feedback queue(default).
+#define SCHED_FIFO  2   // real-time, runs until it blocks or yields.
+#define SCHED_LOTT  3   // lottery(not implemented).
+#define SCHED_FAIR  4   // fair share by virtual runtime.
+
+#define SCHED_NPOLICY   5
+
+struct sched_param {
+    int sched_priority;
+};
+
+// CPU affinity mask, bit 'n' selects cpus[n].
+#define CPU_SETSIZE     64
+
+typedef struct cpu_set {
+    unsigned long __bits[CPU_SETSIZE / (8 * sizeof (unsigned long))];
+} cpu_set_t;
 
 typedef struct level {
     atomic_t    pull;   // pull flag
@@ -21,22 +47,161 @@ typedef struct level {
 } level_t;
 
 typedef struct sched_queue {
-    level_t level[NLEVELS];
+    level_t     level[NLEVELS];         // SCHED_MLFQ levels.
+    queue_t     *rt[SCHED_RT_NPRIO];    // SCHED_FIFO and SCHED_RR, one queue per priority.
+    queue_t     *fair;                  // SCHED_FAIR, picked by least virtual runtime.
+    u64         min_vruntime;           // virtual runtime floor for SCHED_FAIR.
+    u64         mlfq_boost;             // last SCHED_MLFQ boost applied to the levels.
+    u32         turn;                   // rotates the classes of a shared rank in sched_next().
 } sched_queue_t;
 
+// wakeup-to-run latency histogram, bucket 'b' counts latencies in [2^(b-1), 2^b) ns.
+#define SCHED_LAT_NBUCKETS      32
+
+/**
+ * @brief Scheduler accounting, kept per-thread and per-CPU.
+ * All times are in ns as returned by sched_clock().
+ */
+typedef struct sched_stat {
+    u64         ss_run_sum;                     // time spent running.
+    u64         ss_wait_sum;                    // time spent runnable but waiting on a run-queue.
+    u64         ss_idle_sum;                    // time spent halted(per-CPU only).
+    u64         ss_nrun;                        // number of times switched in.
+    u64         ss_nvcsw;                       // voluntary switches(blocked, slept, exited).
+    u64         ss_nivcsw;                      // involuntary switches(preempted, yielded).
+    u64         ss_migrations;                  // switched in on a different CPU than last time.
+    u64         ss_lat[SCHED_LAT_NBUCKETS];     // wakeup-to-run latency histogram.
+} sched_stat_t;
+
+/**
+ * @brief histogram bucket of a latency of 'ns' nanoseconds.
+ */
+#define SCHED_LAT_BUCKET(ns)    ({                                  \
+    u64 __ns = (ns);                                                \
+    int __b  = __ns ? 64 - __builtin_clzl(__ns) : 0;                \
+    __b < SCHED_LAT_NBUCKETS ? __b : SCHED_LAT_NBUCKETS - 1;        \
+})
+
+/**
+ * @brief add the counters in 'src' to 'dst'.
+ */
+void sched_stat_add(sched_stat_t *dst, const sched_stat_t *src);
+
+// sched_t.s_rank, lower runs first.
+#define SCHED_RANK_RT       0   // SCHED_FIFO and SCHED_RR.
+#define SCHED_RANK_NORMAL   1   // SCHED_MLFQ and SCHED_FAIR.
+#define SCHED_NRANKS        2
+
+/**
+ * @brief Scheduling class descriptor.
+ * Classes are consulted by sched_next() in order of rank, a thread of a
+ * lower rank always runs before one of a higher rank. Classes sharing a
+ * rank take turns, so neither starves the other.
+ */
 typedef struct sched_t {
-    char *s_name;
-    enum {
-        SCHED_RR,
-        SCHED_MLFQ,
-        SCHED_FIFO,
-        SCHED_LOTT,
-    }   s_type;
-    int (*s_init)();
-    int (*s_park)();
-    int (*s_next)();
+    char        *s_name;
+    int         s_type;                                     // policy handled by this class.
+    int         s_rank;                                     // SCHED_RANK_*.
+    int         (*s_init)(sched_queue_t *rq);               // initialize a per-CPU run-queue.
+    int         (*s_park)(sched_queue_t *rq, thread_t *);   // queue up a locked thread.
+    thread_t    *(*s_next)(sched_queue_t *rq);              // dequeue the next thread(locked).
+    size_t      (*s_nready)(sched_queue_t *rq);             // number of queued threads(hint).
+    void        (*s_put)(sched_queue_t *rq, thread_t *, u64 ran); // current ran for 'ran' ns.
 } sched_t;
 
+/**
+ * @brief SCHED_MLFQ tunables, all times are in ms.
+ * quantum(level) = mlfq_quantum + level * mlfq_quantum_step.
+ */
+struct sched_tunables {
+    long    mlfq_quantum;           // quantum of the top level.
+    long    mlfq_quantum_step;      // quantum added per level down.
+    long    mlfq_boost_interval;    // period of the global priority boost, 0 disables it.
+};
+
+/**
+ * @brief get/set the scheduler tunables.
+ * Setting them requires euid 0 for user threads.
+ * @return int 0 on success, otherwise an error code is returned.
+ */
+int sched_gettunables(struct sched_tunables *tunables);
+int sched_settunables(const struct sched_tunables *tunables);
+
+extern sched_t sched_rt;
+extern sched_t sched_mlfq;
+extern sched_t sched_fair;
+
+/**
+ * @brief get the scheduling class that handles 'policy'.
+ * @return sched_t * NULL if the policy is not supported.
+ */
+sched_t *sched_class(int policy);
+
+/**
+ * @brief rank of 'policy' in the order of precedence, lower is more urgent.
+ */
+int sched_rank(int policy);
+
+/**
+ * @brief monotonic clock used for scheduler accounting.
+ * @return u64 nanoseconds.
+ */
+u64 sched_clock(void);
+
+/**
+ * @brief CPU time used by 'thread' so far, including the run in progress.
+ * Caller must hold the thread lock.
+ * @return u64 nanoseconds.
+ */
+u64 sched_cputime(thread_t *thread);
+
+/**
+ * @brief set the scheduling policy and parameters of thread 'tid'.
+ * 'tid' is a thread of the calling process, 0 refers to the calling thread.
+ * @return int 0 on success, otherwise an error code is returned.
+ */
+int sched_setscheduler(tid_t tid, int policy, const struct sched_param *param);
+
+/**
+ * @brief get the scheduling policy of thread 'tid'.
+ * 'tid' is a thread of the calling process, 0 refers to the calling thread.
+ * @return int the policy on success, otherwise an error code is returned.
+ */
+int sched_getscheduler(tid_t tid);
+
+/**
+ * @brief restrict thread 'tid' to the CPUs in 'mask'.
+ * CPUs that are not running the scheduler are ignored,
+ * a mask that selects none of them is rejected.
+ * 'tid' is a thread of the calling process, 0 refers to the calling thread,
+ * which migrates right away if it is no longer allowed on this CPU.
+ * @return int 0 on success, otherwise an error code is returned.
+ */
+int sched_setaffinity(tid_t tid, size_t setsize, const cpu_set_t *mask);
+
+/**
+ * @brief get the CPUs thread 'tid' may run on.
+ * 'tid' is a thread of the calling process, 0 refers to the calling thread.
+ * @return int 0 on success, otherwise an error code is returned.
+ */
+int sched_getaffinity(tid_t tid, size_t setsize, cpu_set_t *mask);
+
+/**
+ * @brief urgency of a thread running with 'policy' and 'priority',
+ * comparable across scheduling classes, higher is more urgent.
+ */
+long sched_urgency(int policy, long priority);
+
+/**
+ * @brief priority inheritance, let 'thread' run with 'policy' and 'priority'
+ * for as long as they are more urgent than its own.
+ * policy < 0 drops any inherited priority.
+ * A thread waiting on a run-queue is moved to the queue(or SCHED_MLFQ level)
+ * matching its new attributes. The caller must hold thread->t_lock.
+ * @return int 1 if the thread's effective policy or priority changed, 0 otherwise.
+ */
+int sched_pi_inherit(thread_t *thread, int policy, long priority);
+
 extern queue_t *sched_stopq;
 
 /*queue up a thread*/
@@ -103,6 +268,16 @@ thread_t *sched_next(void);
 thread_t *sched_getembryo(void);
 int sched_putembryo(thread_t *thread);
 
+// number of embryos waiting to be picked up by a CPU.
+size_t sched_nembryo(void);
+
+/**
+ * @brief number of threads waiting to run on 'processor',
+ * including embryos which any CPU may pick up.
+ * This is a lockless snapshot, only meant as a hint.
+ */
+size_t sched_nready(cpu_t *processor);
+
 /*context switch back to the scheduler*/
 extern void sched(void);
 
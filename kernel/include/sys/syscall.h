@@ -8,6 +8,8 @@
 #include <fs/stat.h>
 #include <sys/_time.h>
 #include <sys/_utsname.h>
+#include <sys/uring.h>
+#include <sys/_uio.h>
 
 void do_syscall(ucontext_t *uctx);
 
@@ -106,6 +108,39 @@ void do_syscall(ucontext_t *uctx);
 #define SYS_MKDIR               80  // int sys_mkdir(const char *filename, mode_t mode);
 #define SYS_MKNOD               81  // int sys_mknod(const char *filename, mode_t mode, int devid);
 
+#define SYS_SCHED_SETSCHEDULER  82  // int sys_sched_setscheduler(tid_t tid, int policy, const struct sched_param *param);
+#define SYS_SCHED_GETSCHEDULER  83  // int sys_sched_getscheduler(tid_t tid);
+#define SYS_SCHED_GETTUNABLES   84  // int sys_sched_gettunables(struct sched_tunables *tunables);
+#define SYS_SCHED_SETTUNABLES   85  // int sys_sched_settunables(const struct sched_tunables *tunables);
+#define SYS_SCHED_SETAFFINITY   86  // int sys_sched_setaffinity(tid_t tid, size_t setsize, const cpu_set_t *mask);
+#define SYS_SCHED_GETAFFINITY   87  // int sys_sched_getaffinity(tid_t tid, size_t setsize, cpu_set_t *mask);
+
+#define SYS_FUTEX               88  // long sys_futex(u32 *uaddr, int op, u32 val, const struct timespec *timeout, u32 *uaddr2, u32 val3);
+
+#define SYS_NANOSLEEP           89  // int sys_nanosleep(const struct timespec *req, struct timespec *rem);
+#define SYS_CLOCK_NANOSLEEP     90  // int sys_clock_nanosleep(clockid_t clock_id, int flags, const struct timespec *req, struct timespec *rem);
+#define SYS_TIMER_CREATE        91  // int sys_timer_create(clockid_t clock_id, struct sigevent *restrict sevp, timer_t *restrict timerid);
+#define SYS_TIMER_SETTIME       92  // int sys_timer_settime(timer_t timerid, int flags, const struct itimerspec *restrict value, struct itimerspec *restrict ovalue);
+#define SYS_TIMER_GETTIME       93  // int sys_timer_gettime(timer_t timerid, struct itimerspec *value);
+#define SYS_TIMER_GETOVERRUN    94  // int sys_timer_getoverrun(timer_t timerid);
+#define SYS_TIMER_DELETE        95  // int sys_timer_delete(timer_t timerid);
+
+#define SYS_CLOCK_GETTIME       96  // int sys_clock_gettime(clockid_t clock_id, struct timespec *tp);
+#define SYS_CLOCK_GETRES        97  // int sys_clock_getres(clockid_t clock_id, struct timespec *res);
+#define SYS_CLOCK_SETTIME       98  // int sys_clock_settime(clockid_t clock_id, const struct timespec *tp);
+
+#define SYS_URING_SETUP         99  // int sys_uring_setup(u32 entries, uring_params_t *params);
+#define SYS_URING_ENTER         100 // int sys_uring_enter(int fd, u32 to_submit, u32 min_complete, u32 flags);
+
+#define SYS_READV               101 // ssize_t sys_readv(int fd, const struct iovec *iov, int iovcnt);
+#define SYS_WRITEV              102 // ssize_t sys_writev(int fd, const struct iovec *iov, int iovcnt);
+#define SYS_PREAD               103 // ssize_t sys_pread(int fd, void *buf, size_t size, off_t off);
+#define SYS_PWRITE              104 // ssize_t sys_pwrite(int fd, void *buf, size_t size, off_t off);
+#define SYS_PREADV              105 // ssize_t sys_preadv(int fd, const struct iovec *iov, int iovcnt, off_t off);
+#define SYS_PWRITEV             106 // ssize_t sys_pwritev(int fd, const struct iovec *iov, int iovcnt, off_t off);
+#define SYS_SENDFILE            107 // ssize_t sys_sendfile(int out_fd, int in_fd, off_t *offset, size_t count);
+#define SYS_SPLICE              108 // ssize_t sys_splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, uint flags);
+
 extern void     sys_putc(int c);
 
 extern int      sys_close(int fd);
@@ -118,6 +153,14 @@ extern int      sys_ioctl(int fd, int req, void *argp);
 extern off_t    sys_lseek(int fd, off_t off, int whence);
 extern ssize_t  sys_read(int fd, void *buf, size_t size);
 extern ssize_t  sys_write(int fd, void *buf, size_t size);
+extern ssize_t  sys_readv(int fd, const struct iovec *iov, int iovcnt);
+extern ssize_t  sys_writev(int fd, const struct iovec *iov, int iovcnt);
+extern ssize_t  sys_pread(int fd, void *buf, size_t size, off_t off);
+extern ssize_t  sys_pwrite(int fd, void *buf, size_t size, off_t off);
+extern ssize_t  sys_preadv(int fd, const struct iovec *iov, int iovcnt, off_t off);
+extern ssize_t  sys_pwritev(int fd, const struct iovec *iov, int iovcnt, off_t off);
+extern ssize_t  sys_sendfile(int out_fd, int in_fd, off_t *offset, size_t count);
+extern ssize_t  sys_splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, uint flags);
 extern int      sys_open(const char *pathname, int oflags, mode_t mode);
 extern int      sys_openat(int fd, const char *pathname, int oflags, mode_t mode);
 extern int      sys_create(const char *filename, mode_t mode);
@@ -204,6 +247,37 @@ extern int      sys_sigwait(const sigset_t *restrict set, int *restrict signop);
 extern int      sys_pthread_sigmask(int how, const sigset_t *restrict set, sigset_t *restrict oset);
 extern void     sys_thread_yield(void);
 
+/** @brief SCHEDULING */
+
+extern int      sys_sched_setscheduler(tid_t tid, int policy, const struct sched_param *param);
+extern int      sys_sched_getscheduler(tid_t tid);
+extern int      sys_sched_gettunables(struct sched_tunables *tunables);
+extern int      sys_sched_settunables(const struct sched_tunables *tunables);
+extern int      sys_sched_setaffinity(tid_t tid, size_t setsize, const cpu_set_t *mask);
+extern int      sys_sched_getaffinity(tid_t tid, size_t setsize, cpu_set_t *mask);
+
+/** @brief SYNCHRONIZATION */
+
+extern long     sys_futex(u32 *uaddr, int op, u32 val, const struct timespec *timeout, u32 *uaddr2, u32 val3);
+
+/** @brief TIMERS */
+
+extern int      sys_nanosleep(const struct timespec *req, struct timespec *rem);
+extern int      sys_clock_nanosleep(clockid_t clock_id, int flags, const struct timespec *req, struct timespec *rem);
+extern int      sys_timer_create(clockid_t clock_id, struct sigevent *restrict sevp, timer_t *restrict timerid);
+extern int      sys_timer_settime(timer_t timerid, int flags, const struct itimerspec *restrict value, struct itimerspec *restrict ovalue);
+extern int      sys_timer_gettime(timer_t timerid, struct itimerspec *value);
+extern int      sys_timer_getoverrun(timer_t timerid);
+extern int      sys_timer_delete(timer_t timerid);
+extern int      sys_clock_gettime(clockid_t clock_id, struct timespec *tp);
+extern int      sys_clock_getres(clockid_t clock_id, struct timespec *res);
+extern int      sys_clock_settime(clockid_t clock_id, const struct timespec *tp);
+
+/** @brief ASYNCHRONOUS I/O */
+
+extern int      sys_uring_setup(u32 entries, uring_params_t *params);
+extern int      sys_uring_enter(int fd, u32 to_submit, u32 min_complete, u32 flags);
+
 /** @brief MEMORY MANAGEMENT */
 
 extern int      sys_munmap(void *addr, size_t len);
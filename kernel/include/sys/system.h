@@ -139,9 +139,6 @@
 extern void kend();
 extern void kstart();
 
-extern int copy_to_user(void *udst, void *ksrc, size_t size);
-extern int copy_from_user(void *kdst, void * usrc, size_t size);
-
 extern void    swapi8(char  *dst, char *src);
 extern void    swapi16(short *dst, short *src);
 extern void    swapi32(int  *dst, int  *src);
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <lib/types.h>
+#include <lib/stdint.h>
+#include <lib/stddef.h>
+
+/**
+ * @brief System call accounting and tracing(systrace).
+ * Every system call is counted per CPU, with its total time and a log2
+ * histogram of its latency. Read them from /proc/sysstat, writing to it
+ * resets them.
+ * Writing "on", "off" or "pid <pid>" to /proc/systrace starts, stops or
+ * filters(0 for all) tracing. While on, each system call of the traced
+ * process is recorded into a ring of the CPU it returns on. Reading
+ * /proc/systrace drains the rings, one line per record.
+ */
+
+#define SYSTRACE_NARGS          6
+#define SYSTRACE_LAT_NBUCKETS   32      // bucket 'b' counts latencies in [2^(b-1), 2^b) ns.
+#define SYSTRACE_RING_SIZE      1024    // records per CPU, a power of 2.
+
+typedef struct systrace_rec {
+    u64     sr_entry;                   // tsc_read() at entry.
+    u64     sr_exit;                    // tsc_read() at exit.
+    u64     sr_args[SYSTRACE_NARGS];
+    i64     sr_ret;
+    pid_t   sr_pid;
+    tid_t   sr_tid;
+    u32     sr_nr;
+    u32     sr_cpu;
+} systrace_rec_t;
+
+/**
+ * @brief allocate the per-CPU accounting, once every CPU is known.
+ */
+int     systrace_init(void);
+
+/**
+ * @brief account, and trace if on, system call 'nr' with 'args',
+ * entered at tsc_read() time 'entry' and returning 'ret'.
+ */
+void    systrace_syscall(usize nr, const u64 args[SYSTRACE_NARGS], u64 ret, u64 entry);
+
+/**
+ * @brief drain as many whole trace records as fit into 'buf' as text.
+ * @return ssize_t number of bytes written, 0 if none are pending.
+ */
+ssize_t systrace_read(char *buf, size_t size);
+
+/**
+ * @brief handle a "on", "off" or "pid <pid>" command.
+ * @return ssize_t 'size', or -EINVAL.
+ */
+ssize_t systrace_ctl(const char *buf, size_t size);
+
+/**
+ * @brief format the counts and latency histograms into 'buf'.
+ * @return ssize_t number of bytes written.
+ */
+ssize_t sysstat_show(char *buf, size_t size);
+void    sysstat_reset(void);
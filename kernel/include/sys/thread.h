@@ -43,10 +43,10 @@ typedef struct thread_attr_t {
 
 typedef struct thread_sched_t {
     time_t      ts_ctime;       // Thread ceation time.
-    time_t      ts_cpu_time;    // CPU time in jiffies(n seconds = (jiffy * (HZ_TO_ns(SYS_HZ) / seconds_TO_ns(1))) ).
+    u64         ts_cpu_time;    // CPU time in ns, not counting the run in progress(see sched_cputime()).
     time_t      ts_timeslice;   // Quantum of CPU time for which this thread is allowed to run.
     time_t      ts_total_time;  // Total time this thread has run.
-    time_t      ts_last_sched;  // Last time this thread was scheduled to run.
+    u64         ts_last_sched;  // sched_clock() when last switched in, 0 while not running.
     cpu_t       *ts_processor;  // Current Processor for which this thread has affinity.
     struct {
         enum{
@@ -55,7 +55,20 @@ typedef struct thread_sched_t {
         } type;                 // Type of affinity (SOFT or HARD).
         flags32_t   cpu_set;    // cpu set for which thread can have affinity for.
     } ts_affinity;
-    atomic_t    ts_priority;            // Thread scheduling Priority.
+    atomic_t    ts_priority;            // Thread scheduling Priority(class specific), SCHED_MLFQ adjusts it at runtime.
+    atomic_t    ts_base_priority;       // Priority set by the user, SCHED_MLFQ never goes above it.
+    jiffies_t   ts_boost;               // Last SCHED_MLFQ boost seen by this thread.
+    int         ts_policy;              // Scheduling policy(SCHED_MLFQ by default).
+    u64         ts_vruntime;            // Virtual runtime in ns(SCHED_FAIR).
+    u64         ts_enqueued;            // sched_clock() when last put on a run-queue.
+    int         ts_waking;              // last enqueue was a wakeup, not a preemption.
+    cpu_t       *ts_lastcpu;            // CPU this thread last ran on.
+    sched_stat_t ts_stat;               // scheduler accounting.
+    int         ts_pi_boosted;          // running with a policy and priority inherited from a mutex waiter.
+    int         ts_pi_policy;           // own policy while ts_pi_boosted.
+    long        ts_pi_priority;         // own priority while ts_pi_boosted.
+    struct mutex_t *ts_pi_blocked;      // mutex this thread sleeps on.
+    struct mutex_t *ts_pi_held;         // mutexes held by this thread, linked through mtx_held_next.
 } thread_sched_t;
 
 #define sched_DEFAULT() (thread_sched_t){0}
@@ -136,6 +149,7 @@ typedef struct __thread_t {
     queue_t         t_lock_chain;       // chain of locks to reliquinsh before sleeping and to hold after waking up.
 
     spinlock_t      t_lock;             // lock to synchronize access to this struct.
+    rcu_head_t      t_rcu;              // defers the kstack free past thread_get() lookups.
 
     // Misc. debug information.
     
@@ -170,6 +184,7 @@ typedef struct {
 #define THREAD_SUSPEND                  BS(13)  // flag to suspend thread execution.
 #define THREAD_KILLEXCEPT               BS(14)  //
 #define THREAD_LOCK_GROUP               BS(15)  // prior to locking thread lock tgroup first.
+#define THREAD_REAPED                   BS(16)  // thread was freed, its kstack is released after an RCU grace period.
 
 #define thread_assert(t)                ({ assert(t, "No thread pointer\n");})
 #define thread_lock(t)                  ({ thread_assert(t); spin_lock(&((t)->t_lock)); })
@@ -271,6 +286,7 @@ typedef struct {
 })
 
 #define thread_isdetached(t)            ({ thread_testflags((t), THREAD_DETACHED); })
+#define thread_isreaped(t)              ({ thread_testflags((t), THREAD_REAPED); })
 #define thread_issetwake(t)             ({ thread_testflags((t), THREAD_WAKE); })
 #define thread_issetpark(t)             ({ thread_testflags((t), THREAD_PARK); })
 
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <lib/stdint.h>
+#include <lib/types.h>
+#include <sys/system.h>
+
+/**
+ * @brief Submission/completion rings.
+ * uring_setup() returns a file descriptor whose pages userspace maps with
+ * mmap(NULL, params.up_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0):
+ *
+ *  URING_SQ_OFF            submission queue header.
+ *  URING_CQ_OFF            completion queue header.
+ *  URING_SQES_OFF          'entries' submission queue entries(SQEs).
+ *  URING_CQES_OFF(entries) 2 * 'entries' completion queue entries(CQEs).
+ *
+ * Userspace fills the SQE at sq.uq_tail & sq.uq_mask and bumps the tail,
+ * the kernel copies SQEs out as it consumes them and bumps sq.uq_head.
+ * The kernel fills CQEs at cq.uq_tail and bumps it, userspace bumps
+ * cq.uq_head once it is done with them. Each side only writes its own index.
+ *
+ * uring_enter() hands up to 'to_submit' SQEs to the ring's worker threads
+ * and optionally waits for completions. With URING_SETUP_SQPOLL a kernel
+ * thread consumes the SQ instead, uring_enter() is only needed to wake it
+ * once it has set URING_SQ_NEED_WAKEUP after URING_SQ_IDLE_MS of idling.
+ */
+
+#define URING_ENTRIES_MAX       4096
+#define URING_WORKERS           2       // worker threads if none are asked for.
+#define URING_WORKERS_MAX       8
+#define URING_SQ_IDLE_MS        10      // SQ poller idle time if none is asked for.
+#define URING_BOUNCESZ          KiB(64) // most a READ or WRITE moves through the kernel at a time.
+
+// uring_params_t.up_flags.
+#define URING_SETUP_SQPOLL      BS(0)   // a kernel thread polls the SQ.
+
+// uring_enter() flags.
+#define URING_ENTER_GETEVENTS   BS(0)   // wait for 'min_complete' CQEs.
+#define URING_ENTER_SQ_WAKEUP   BS(1)   // wake the SQ poller.
+
+// sq.uq_flags.
+#define URING_SQ_NEED_WAKEUP    BS(0)   // the SQ poller sleeps, see URING_ENTER_SQ_WAKEUP.
+
+// uring_sqe_t.sqe_op.
+#define URING_OP_NOP            0
+#define URING_OP_READ           1   // read(fd, addr, len), or pread() at off.
+#define URING_OP_WRITE          2   // write(fd, addr, len), or pwrite() at off.
+#define URING_OP_FSYNC          3   // sync(fd).
+#define URING_OP_OPENAT         4   // openat(fd, addr, flags, len).
+#define URING_OP_CLOSE          5   // close(fd).
+#define URING_OP_POLL           6   // wait for URING_POLL* 'flags' on fd.
+#define URING_OP_TIMEOUT        7   // sleep for the struct timespec at addr, completes with -ETIME.
+#define URING_OP_LAST           URING_OP_TIMEOUT
+
+// read and write at and past the file offset.
+#define URING_OFF_CURRENT       ((u64)-1)
+
+// URING_OP_POLL events.
+#define URING_POLLIN            0x001
+#define URING_POLLOUT           0x004
+#define URING_POLLERR           0x008
+#define URING_POLLHUP           0x010
+
+typedef struct uring_sqe {
+    u8      sqe_op;         // URING_OP_*.
+    u8      sqe_rsvd[3];
+    i32     sqe_fd;
+    u64     sqe_off;        // file offset or URING_OFF_CURRENT.
+    u64     sqe_addr;       // buffer, path or timespec.
+    u32     sqe_len;        // buffer length or mode.
+    u32     sqe_flags;      // open flags or poll events.
+    u64     sqe_user_data;  // passed back in the CQE.
+} uring_sqe_t;
+
+typedef struct uring_cqe {
+    u64     cqe_user_data;
+    i64     cqe_res;        // what the call returned, negated errno on failure.
+} uring_cqe_t;
+
+typedef struct uring_queue {
+    u32     uq_head;
+    u32     uq_tail;
+    u32     uq_mask;        // uq_entries - 1.
+    u32     uq_entries;
+    u32     uq_flags;       // URING_SQ_* of the SQ.
+    u32     uq_dropped;     // CQEs lost to a full CQ.
+} __aligned(64) uring_queue_t;
+
+typedef struct uring_params {
+    u32     up_entries;     // out: SQ entries, the CQ has twice as many.
+    u32     up_flags;       // URING_SETUP_*.
+    u32     up_workers;     // worker threads, 0 for URING_WORKERS.
+    u32     up_sq_idle;     // SQ poller idle time in ms, 0 for URING_SQ_IDLE_MS.
+    u64     up_size;        // out: bytes to mmap() at offset 0.
+} uring_params_t;
+
+#define URING_SQ_OFF            0
+#define URING_CQ_OFF            (sizeof (uring_queue_t))
+#define URING_SQES_OFF          (2 * sizeof (uring_queue_t))
+#define URING_CQES_OFF(n)       (URING_SQES_OFF + (n) * sizeof (uring_sqe_t))
+#define URING_SIZE(n)           (URING_CQES_OFF(n) + 2 * (n) * sizeof (uring_cqe_t))
+
+/**
+ * @brief create a ring of 'entries'(a power of 2) SQEs and its worker threads.
+ * The workers run in the caller's address space and with its file descriptors.
+ * @return int the ring's file descriptor, -EINVAL or -ENOMEM.
+ */
+int uring_setup(u32 entries, uring_params_t *params);
+
+/**
+ * @brief submit up to 'to_submit' SQEs, then with URING_ENTER_GETEVENTS
+ * wait until at least 'min_complete' CQEs are ready.
+ * @return int number of SQEs submitted, -EBADFD if 'fd' isn't a ring of
+ * the calling process, -EINTR if a signal ended the wait.
+ */
+int uring_enter(int fd, u32 to_submit, u32 min_complete, u32 flags);
@@ -1,4 +1,5 @@
 #include <mm/kalloc.h>
+#include <sync/pcpu_counter.h>
 
 /**  Durand's Amazing Super Duper Memory functions.  */
 
@@ -85,8 +86,8 @@ static struct liballoc_major *l_bestBet = NULL; ///< The major with the most kfr
 
 static unsigned int l_pageSize = 4096;	   ///< The size of an individual page. Set up in liballoc_init.
 static unsigned int l_pageCount = 16;	   ///< The number of pages to request per chunk. Set up in liballoc_init.
-static unsigned long long l_allocated = 0; ///< Running total of allocated memory.
-static unsigned long long l_inuse = 0;	   ///< Running total of used memory.
+static pcpu_counter_t l_allocated = {0}; ///< Running total of allocated memory.
+static pcpu_counter_t l_inuse = {0};	 ///< Running total of used memory.
 
 static long long l_warningCount = 0;	 ///< Number of warnings encountered
 static long long l_errorCount = 0;		 ///< Number of actual errors
@@ -136,8 +137,8 @@ static void liballoc_dump()
 #endif
 
 	printk("liballoc: ------ Memory data ---------------\n");
-	printk("liballoc: System memory allocated: %i bytes\n", l_allocated);
-	printk("liballoc: Memory in used (kmalloc'ed): %i bytes\n", l_inuse);
+	printk("liballoc: System memory allocated: %i bytes\n", pcpu_counter_sum(&l_allocated));
+	printk("liballoc: Memory in used (kmalloc'ed): %i bytes\n", pcpu_counter_sum(&l_inuse));
 	printk("liballoc: Warning count: %i\n", l_warningCount);
 	printk("liballoc: Error count: %i\n", l_errorCount);
 	printk("liballoc: Possible overruns: %i\n", l_possibleOverruns);
@@ -208,12 +209,12 @@ static struct liballoc_major *allocate_new_page(unsigned int size)
 	maj->usage = sizeof(struct liballoc_major);
 	maj->first = NULL;
 
-	l_allocated += maj->size;
+	pcpu_counter_add(&l_allocated, maj->size);
 
 #ifdef DEBUG
 	printk("liballoc: Resource allocated %p of %i pages (%i bytes) for %i size.\n", maj, st, maj->size, size);
 
-	printk("liballoc: Total memory usage = %i KB\n", (int)((l_allocated / (1024))));
+	printk("liballoc: Total memory usage = %i KB\n", (int)((pcpu_counter_read(&l_allocated) / (1024))));
 // FLUSH();
 #endif
 
@@ -370,7 +371,7 @@ void *PREFIX(malloc)(size_t req_size)
 			maj->first->req_size = req_size;
 			maj->usage += size + sizeof(struct liballoc_minor);
 
-			l_inuse += size;
+			pcpu_counter_add(&l_inuse, size);
 
 			p = (void *)((uintptr_t)(maj->first) + sizeof(struct liballoc_minor));
 
@@ -407,7 +408,7 @@ void *PREFIX(malloc)(size_t req_size)
 			maj->first->req_size = req_size;
 			maj->usage += size + sizeof(struct liballoc_minor);
 
-			l_inuse += size;
+			pcpu_counter_add(&l_inuse, size);
 
 			p = (void *)((uintptr_t)(maj->first) + sizeof(struct liballoc_minor));
 			ALIGN(p);
@@ -453,7 +454,7 @@ void *PREFIX(malloc)(size_t req_size)
 					min->req_size = req_size;
 					maj->usage += size + sizeof(struct liballoc_minor);
 
-					l_inuse += size;
+					pcpu_counter_add(&l_inuse, size);
 
 					p = (void *)((uintptr_t)min + sizeof(struct liballoc_minor));
 					ALIGN(p);
@@ -492,7 +493,7 @@ void *PREFIX(malloc)(size_t req_size)
 					min->next = new_min;
 					maj->usage += size + sizeof(struct liballoc_minor);
 
-					l_inuse += size;
+					pcpu_counter_add(&l_inuse, size);
 
 					p = (void *)((uintptr_t)new_min + sizeof(struct liballoc_minor));
 					ALIGN(p);
@@ -629,7 +630,7 @@ void PREFIX(free)(void *ptr)
 
 	maj = min->block;
 
-	l_inuse -= min->size;
+	pcpu_counter_add(&l_inuse, -(i64)min->size);
 
 	maj->usage -= (min->size + sizeof(struct liballoc_minor));
 	min->magic = LIBALLOC_DEAD; // No mojo.
@@ -656,7 +657,7 @@ void PREFIX(free)(void *ptr)
 			maj->prev->next = maj->next;
 		if (maj->next != NULL)
 			maj->next->prev = maj->prev;
-		l_allocated -= maj->size;
+		pcpu_counter_add(&l_allocated, -(i64)maj->size);
 
 		liballoc_free(maj, maj->pages);
 	}
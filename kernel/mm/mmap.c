@@ -102,7 +102,8 @@ int mmap_alloc(mmap_t **ref) {
     mmap->pgdir     = pgdir;
     mmap->flags     = MMAP_USER;
     mmap->guard_len = PAGESZ;
-    mmap->lock      = SPINLOCK_INIT();
+    mmap->lock      = RWLOCK_INIT();
+    mmap->pgt_lock  = SPINLOCK_INIT();
     mmap->limit     = __mmap_limit;
 
     mmap_lock(mmap);
@@ -290,7 +291,7 @@ vmr_t *mmap_find(mmap_t *mmap, uintptr_t addr) {
     if (mmap == NULL)
         return NULL;
 
-    mmap_assert_locked(mmap);
+    mmap_assert_held(mmap);
 
     forlinked(tmp, mmap->vmr_head, tmp->next) {
         if (addr >= tmp->start && addr <= tmp->end)
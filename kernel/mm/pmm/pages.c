@@ -36,30 +36,21 @@ void mm_free(uintptr_t addr) {
     __page_putref(addr);
 }
 
-size_t mem_free(void) {
-    size_t size = 0;
-    zone_t *z = NULL;
-
-    for (size_t zone = ZONEi_DMA; zone < NELEM(zones); ++zone) {
-        zone_lock(&zones[zone]);
-        if (zone_isvalid(z = &zones[zone])) {
-            size += (z->npages - z->upages) * PAGESZ;
-        }
-        zone_unlock(&zones[zone]);
-    }
-    return (size / 1024);
+size_t mem_used(void) {
+    return (pcpu_counter_sum(&zone_upages) * PAGESZ) / 1024;
 }
 
-size_t mem_used(void) {
+size_t mem_free(void) {
     size_t size = 0;
 
+    // used pages come from zone_upages, which needs no zone lock.
     for (size_t zone = ZONEi_DMA; zone < NELEM(zones); ++zone) {
         zone_lock(&zones[zone]);
         if (zone_isvalid(&zones[zone]))
-            size += zones[zone].upages * PAGESZ;
+            size += zones[zone].npages * PAGESZ;
         zone_unlock(&zones[zone]);
     }
-    return (size / 1024);
+    return (size / 1024) - mem_used();
 }
 
 #define page_index(page, zone)      ({ ((page) - (zone)->pages); })
@@ -121,7 +112,7 @@ int page_alloc_n(gfp_t gfp, usize order, page_t **pp) {
             // managed to get all the pages?
             if (++count == npage) {
                 for ( index++; page < &zone->pages[index]; page++) {
-                    zone->upages++;
+                    zone_account(zone, 1);
                     assert(!atomic_read(&page->refcnt),
                             "page->refcnt not 'zero'???.");
 
@@ -258,7 +249,7 @@ void page_free_n(page_t *page, usize order) {
             
             page_resetflags(page);
             page_setswappable(page);
-            zone->upages--;
+            zone_account(zone, -1);
         }
     }
     zone_unlock(zone);
@@ -356,7 +347,7 @@ void __page_free_n(uintptr_t paddr, usize order) {
             
             page_resetflags(page);
             page_setswappable(page);
-            zone->upages--;
+            zone_account(zone, -1);
         }
     }
     zone_unlock(zone);
@@ -6,6 +6,7 @@
 #include <sys/system.h>
 
 zone_t zones[NZONE];
+pcpu_counter_t zone_upages = {0};
 
 const char *str_zone[] = {
     "DMA", "NORM", "HOLE", "HIGH", NULL,
@@ -206,7 +207,7 @@ int zones_init(void) {
             page = z->pages + NPAGE(addr - z->start);
             for (np = NPAGE(size); np; --np, page++, addr += PGSZ) {
                 if (page->refcnt == 0)
-                    z->upages       += 1; // increment no. used pages.
+                    zone_account(z, 1); // increment no. used pages.
                 else printk("%s:%d: [NOTE]: already marked!!!\n", __FILE__, __LINE__);
 
                 page->refcnt    += 1;
@@ -230,7 +231,7 @@ int zones_init(void) {
         page = z->pages + NPAGE(addr - z->start);
         for (np = NPAGE(size); np; --np, page++, addr += PGSZ) {
             if (page->refcnt == 0)
-                z->upages       += 1; // increment no. used pages.
+                zone_account(z, 1); // increment no. used pages.
             else printk("%s:%d: [NOTE]: already marked!!!\n", __FILE__, __LINE__);
 
             page->refcnt    += 1;
@@ -8,6 +8,7 @@
 #include <lib/string.h>
 #include <sys/system.h>
 #include <sync/spinlock.h>
+#include <sync/pcpu_counter.h>
 
 typedef struct node_t {
     struct node_t *prev;
@@ -25,7 +26,7 @@ typedef struct node_t {
 #define NNODES                  (KHEAPSIZE / 4096)
 
 static      atomic_t    initialized     = 0;
-static      size_t      used_memsz      = 0;
+static      pcpu_counter_t used_memsz   = {0};
 static      node_t      *free_node_list = NULL;
 static      node_t      *usedvmr_list   = NULL;
 static      node_t      *freevmr_list   = NULL;
@@ -318,7 +319,7 @@ static int alloc(size_t size, void **ppv) {
         usedvmr_put(split);
     } else assert(0, "Failed to get correct sized vmr_node");
 
-    used_memsz += size;
+    pcpu_counter_add(&used_memsz, size);
 
     vm_unlock();
     return 0;
@@ -346,7 +347,7 @@ static void free(void *addr) {
     if (right)
         right->prev = node->prev;
 
-    used_memsz -= node->size;
+    pcpu_counter_add(&used_memsz, -(i64)node->size);
 
     freevmr_put(node);
 
@@ -364,11 +365,11 @@ uintptr_t vmm_alloc(size_t size) {
 }
 
 size_t vmm_getinuse() {
-    return used_memsz;
+    return pcpu_counter_sum(&used_memsz);
 }
 
 size_t vmm_getfreesize() {
-    return KHEAPSIZE - used_memsz;
+    return KHEAPSIZE - pcpu_counter_sum(&used_memsz);
 }
 
 int vmm_active(void) {
@@ -11,8 +11,6 @@ int cond_new(cond_t **ref) {
 }
 
 void cond_free(cond_t *c) {
-    queue_lock(&c->waiters);
-    queue_flush(&c->waiters);
     kfree(c);
 }
 
@@ -30,10 +28,8 @@ int cond_init(cond_t *c, cond_t **ref) {
         }
     }
 
-    *c = (cond_t){0};
-
-    c->waiters  = QUEUE_INIT();
-    c->guard    = SPINLOCK_INIT();
+    *c = COND_INIT();
+    c->waiters.wq_lock = SPINLOCK_INIT();
 
     if (ref)
         *ref = c;
@@ -45,56 +41,57 @@ error:
     return err;
 }
 
+static int cond_wait_locked(cond_t *cond) {
+    waitq_entry_t we = WAITQ_ENTRY(WAITQ_EXCLUSIVE, 0);
+
+    if ((int)atomic_inc(&cond->count) < 0)
+        return 0;
+    return waitq_sleep(&cond->waiters, &we);
+}
+
 int cond_wait(cond_t *cond) {
     int retval = 0;
 
     assert(cond, "no condition-variable");
     current_assert();
 
-    spin_lock(&cond->guard);
-    if ((int)atomic_inc(&cond->count) >= 0) {
-        current_lock();
-        retval = sched_sleep(&cond->waiters, T_ISLEEP, &cond->guard);
-        current_unlock();
-    }
-    spin_unlock(&cond->guard);
+    waitq_lock(&cond->waiters);
+    retval = cond_wait_locked(cond);
+    waitq_unlock(&cond->waiters);
     return retval;
 }
 
 int cond_wait_releasing(cond_t *cond, spinlock_t *lk) {
     int retval = 0;
 
+    assert(cond, "no condition-variable");
+    current_assert();
+
+    // take the guard before 'lk' is released, so signals sent under 'lk' can't be missed.
+    waitq_lock(&cond->waiters);
     if (lk)
         spin_unlock(lk);
-    retval = cond_wait(cond);
+    retval = cond_wait_locked(cond);
+    waitq_unlock(&cond->waiters);
     if (lk)
         spin_lock(lk);
     return retval;
 }
 
-static void cond_wake1(cond_t *cond) {
-    sched_wake1(&cond->waiters);
-}
-
 void cond_signal(cond_t *cond) {
     assert(cond, "no condition-variable");
-    spin_lock(&cond->guard);
-    cond_wake1(cond);
+    waitq_lock(&cond->waiters);
+    __waitq_wake(&cond->waiters, 1, 0);
     atomic_dec(&cond->count);
-    spin_unlock(&cond->guard);
+    waitq_unlock(&cond->waiters);
 }
 
-static void cond_wakeall(cond_t *cond) {
-    int waiters = sched_wakeall(&cond->waiters);
-    if (waiters == 0)
+void cond_broadcast(cond_t *cond) {
+    assert(cond, "no condition-variable");
+    waitq_lock(&cond->waiters);
+    if (__waitq_wake(&cond->waiters, 0, 0) == 0)
         atomic_write(&cond->count, -1);
     else
         atomic_write(&cond->count, 0);
-}
-
-void cond_broadcast(cond_t *cond) {
-    assert(cond, "no condition-variable");
-    spin_lock(&cond->guard);
-    cond_wakeall(cond);
-    spin_unlock(&cond->guard);
+    waitq_unlock(&cond->waiters);
 }
\ No newline at end of file
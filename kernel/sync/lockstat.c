@@ -0,0 +1,85 @@
+#include <sync/atomic.h>
+#include <sync/lockstat.h>
+#include <lib/printk.h>
+
+#if defined(LOCKSTAT)
+
+/**
+ * Sites are pushed here on their first acquisition and never removed.
+ * Only atomics are used so that spinlocks can be accounted without recursion.
+ */
+static lockstat_t *lockstat_list = NULL;
+
+static void lockstat_register(lockstat_t *site) {
+    int         unregistered = 0;
+    lockstat_t  *head        = NULL;
+
+    if (atomic_read(&site->ls_registered))
+        return;
+
+    if (!atomic_cmpxchg(&site->ls_registered, unregistered, 1))
+        return;
+
+    head = atomic_read(&lockstat_list);
+    do {
+        site->ls_next = head;
+    } while (!atomic_cmpxchg(&lockstat_list, head, site));
+}
+
+static void lockstat_max(u64 *max, u64 val) {
+    u64 old = atomic_read(max);
+
+    while (val > old && !atomic_cmpxchg(max, old, val))
+        ;
+}
+
+void lockstat_acquired(lockstat_t *site, int contended, u64 wait) {
+    lockstat_register(site);
+
+    atomic_inc(&site->ls_acquired);
+    if (contended) {
+        atomic_inc(&site->ls_contended);
+        atomic_fetch_add(&site->ls_wait_sum, wait);
+        lockstat_max(&site->ls_wait_max, wait);
+    }
+}
+
+void lockstat_released(lockstat_t *site, u64 hold) {
+    atomic_fetch_add(&site->ls_hold_sum, hold);
+    lockstat_max(&site->ls_hold_max, hold);
+}
+
+void lockstat_reset(void) {
+    for (lockstat_t *site = atomic_read(&lockstat_list); site; site = site->ls_next) {
+        atomic_write(&site->ls_acquired, 0);
+        atomic_write(&site->ls_contended, 0);
+        atomic_write(&site->ls_wait_sum, 0);
+        atomic_write(&site->ls_wait_max, 0);
+        atomic_write(&site->ls_hold_sum, 0);
+        atomic_write(&site->ls_hold_max, 0);
+    }
+}
+
+ssize_t lockstat_show(char *buf, size_t size) {
+    size_t len = 0;
+
+    len += snprintf(buf + len, size - len,
+        "# site kind acquired contended wait_sum wait_max hold_sum hold_max(cycles)\n");
+
+    for (lockstat_t *site = atomic_read(&lockstat_list); site && len < size; site = site->ls_next) {
+        if (site->ls_acquired == 0)
+            continue;
+
+        len += snprintf(buf + len, size - len,
+            "%s:%d %s %lu %lu %lu %lu %lu %lu\n",
+            site->ls_file, site->ls_line, site->ls_kind,
+            site->ls_acquired, site->ls_contended,
+            site->ls_wait_sum, site->ls_wait_max,
+            site->ls_hold_sum, site->ls_hold_max
+        );
+    }
+
+    return len < size ? len : size;
+}
+
+#endif // LOCKSTAT
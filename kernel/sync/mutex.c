@@ -0,0 +1,263 @@
+#include <arch/cpu.h>
+#include <lib/printk.h>
+#include <sync/mutex.h>
+#include <sys/sched.h>
+#include <sys/thread.h>
+
+static void mutex_waiter_append(mutex_t *mtx, mutex_waiter_t *waiter) {
+    waiter->mw_next = NULL;
+    if (mtx->mtx_wtail)
+        mtx->mtx_wtail->mw_next = waiter;
+    else
+        mtx->mtx_whead = waiter;
+    mtx->mtx_wtail = waiter;
+}
+
+static void mutex_waiter_push(mutex_t *mtx, mutex_waiter_t *waiter) {
+    if ((waiter->mw_next = mtx->mtx_whead) == NULL)
+        mtx->mtx_wtail = waiter;
+    mtx->mtx_whead = waiter;
+}
+
+static mutex_waiter_t *mutex_waiter_pop(mutex_t *mtx) {
+    mutex_waiter_t *waiter = NULL;
+
+    if ((waiter = mtx->mtx_whead) == NULL)
+        return NULL;
+
+    if ((mtx->mtx_whead = waiter->mw_next) == NULL)
+        mtx->mtx_wtail = NULL;
+    waiter->mw_next = NULL;
+    return waiter;
+}
+
+/**
+ * @brief spin while the owner is running on another CPU.
+ * Called and returns with mtx_guard held.
+ * @return int 1 if the mutex was acquired, 0 if the caller should sleep.
+ */
+static int mutex_spin(mutex_t *mtx) {
+    thread_t    *owner  = mtx->mtx_thread;
+    cpu_t       *ocpu   = mtx->mtx_cpu;
+
+    // the owner is asleep, or would have to preempt us to make progress.
+    if (owner == NULL || ocpu == NULL || ocpu == cpu)
+        return 0;
+
+    mutex_guard_unlock(mtx);
+    /**
+     * Only the mutex and the owner's cpu_t are read here,
+     * never 'owner' itself which may exit once it releases the mutex.
+     */
+    for (size_t spins = 0; spins < MUTEX_SPIN_MAX; ++spins) {
+        if (atomic_read(&mtx->mtx_lock) == 0                ||
+            atomic_read(&mtx->mtx_thread) != owner          ||
+            atomic_read(&ocpu->thread) != owner)
+            break;
+        cpu_pause();
+    }
+    mutex_guard_lock(mtx);
+
+    if (mtx->mtx_lock == 0) {
+        mtx->mtx_lock = 1;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief most urgent policy and priority among the waiters of 'mtx'.
+ * @return int 1 if 'mtx' has waiters, 0 otherwise.
+ */
+static int mutex_pi_top(mutex_t *mtx, int *ppolicy, long *ppriority) {
+    int     found    = 0;
+    int     policy   = 0;
+    long    priority = 0;
+
+    for (mutex_waiter_t *w = mtx->mtx_whead; w; w = w->mw_next) {
+        policy   = atomic_read(&w->mw_thread->t_sched.ts_policy);
+        priority = atomic_read(&w->mw_thread->t_sched.ts_priority);
+        if (!found || sched_urgency(policy, priority) > sched_urgency(*ppolicy, *ppriority)) {
+            *ppolicy    = policy;
+            *ppriority  = priority;
+            found       = 1;
+        }
+    }
+    return found;
+}
+
+// lend 'policy' and 'priority' to a locked 'thread' if they are more urgent than what it runs with.
+static int mutex_pi_raise(thread_t *thread, int policy, long priority) {
+    thread_sched_t *tsched = &thread->t_sched;
+
+    if (sched_urgency(policy, priority) <= sched_urgency(tsched->ts_policy, tsched->ts_priority))
+        return 0;
+    return sched_pi_inherit(thread, policy, priority);
+}
+
+/**
+ * @brief current is about to sleep on 'mtx', boost its owner
+ * and every owner down the chain of mutexes they are blocked on.
+ * Called with mtx_guard held, which keeps the first owner from letting go.
+ * Further guards are only tried so walks can't deadlock,
+ * a contended one ends the walk early.
+ */
+static void mutex_pi_block(mutex_t *mtx) {
+    int         policy      = current->t_sched.ts_policy;
+    long        priority    = current->t_sched.ts_priority;
+    mutex_t     *next       = NULL;
+    mutex_t     *locked     = NULL;
+    thread_t    *owner      = mtx->mtx_thread;
+
+    for (int depth = 0; owner && depth < MUTEX_PI_MAXDEPTH; ++depth) {
+        thread_lock(owner);
+        if (!mutex_pi_raise(owner, policy, priority)) {
+            thread_unlock(owner);
+            break;
+        }
+        next = owner->t_sched.ts_pi_blocked;
+        thread_unlock(owner);
+
+        if (next == NULL || next == mtx || next == locked)
+            break;
+
+        if (!spin_trylock(&next->mtx_guard))
+            break;
+
+        if (locked)
+            mutex_guard_unlock(locked);
+        locked = next;
+        owner  = next->mtx_thread;
+    }
+
+    if (locked)
+        mutex_guard_unlock(locked);
+}
+
+/**
+ * @brief current released 'mtx', keep only the boost
+ * needed by the waiters of the mutexes it still holds.
+ */
+static void mutex_pi_release(mutex_t *mtx) {
+    int         found       = 0;
+    int         policy      = -1;
+    long        priority    = 0;
+    int         pol         = 0;
+    long        pri         = 0;
+    mutex_t     **pp        = NULL;
+
+    if (current == NULL)
+        return;
+
+    for (pp = &current->t_sched.ts_pi_held; *pp; pp = &(*pp)->mtx_held_next) {
+        if (*pp == mtx) {
+            *pp = mtx->mtx_held_next;
+            break;
+        }
+    }
+    mtx->mtx_held_next = NULL;
+
+    for (mutex_t *held = current->t_sched.ts_pi_held; held; held = held->mtx_held_next) {
+        mutex_guard_lock(held);
+        found = mutex_pi_top(held, &pol, &pri);
+        mutex_guard_unlock(held);
+
+        if (found && (policy < 0 || sched_urgency(pol, pri) > sched_urgency(policy, priority))) {
+            policy   = pol;
+            priority = pri;
+        }
+    }
+
+    current_lock();
+    if (current->t_sched.ts_pi_boosted || policy >= 0)
+        sched_pi_inherit(current, policy, priority);
+    current_unlock();
+}
+
+void __mutex_lock_slow(mutex_t *mtx) {
+    int             policy   = 0;
+    long            priority = 0;
+    mutex_waiter_t  waiter   = {0};
+
+    mutex_guard_assert_locked(mtx);
+
+    if (mutex_spin(mtx))
+        goto acquired;
+
+    waiter.mw_thread = current;
+    mutex_waiter_append(mtx, &waiter);
+    mutex_pi_block(mtx);
+
+    for (;;) {
+        current_lock();
+        current->t_sched.ts_pi_blocked = mtx;
+        current_enter_state(T_ISLEEP);
+        mutex_guard_unlock(mtx);
+        sched();
+        current_unlock();
+        mutex_guard_lock(mtx);
+
+        if (waiter.mw_granted)
+            break;
+
+        // not woken by a release, still on the list.
+        if (!waiter.mw_woken)
+            continue;
+
+        if (mtx->mtx_lock == 0) {
+            mtx->mtx_lock = 1;
+            break;
+        }
+
+        if (mutex_spin(mtx))
+            break;
+
+        // lost the mutex to a spinner, go back to the front and ask for it directly.
+        waiter.mw_woken   = 0;
+        waiter.mw_handoff = 1;
+        mutex_waiter_push(mtx, &waiter);
+        mutex_pi_block(mtx);
+    }
+
+acquired:
+    current_lock();
+    current->t_sched.ts_pi_blocked = NULL;
+    // the waiters left behind now wait on us.
+    if (mutex_pi_top(mtx, &policy, &priority))
+        mutex_pi_raise(current, policy, priority);
+    current_unlock();
+}
+
+void __mutex_release(mutex_t *mtx) {
+    int             err     = 0;
+    thread_t        *thread = NULL;
+    mutex_waiter_t  *waiter = NULL;
+
+    mutex_guard_assert_locked(mtx);
+
+    mtx->mtx_thread = NULL;
+    mtx->mtx_cpu    = NULL;
+    mutex_pi_release(mtx);
+
+    if ((waiter = mutex_waiter_pop(mtx)) == NULL) {
+        mtx->mtx_lock = 0;
+        return;
+    }
+
+    // the waiter can't return from __mutex_lock_slow() before we drop mtx_guard.
+    thread = waiter->mw_thread;
+    waiter->mw_woken = 1;
+    if (waiter->mw_handoff) {
+        waiter->mw_granted  = 1;
+        mtx->mtx_thread     = thread;
+    } else
+        mtx->mtx_lock = 0;
+
+    thread_lock(thread);
+    if (thread_isisleep(thread)) {
+        thread_enter_state(thread, T_READY);
+        if ((err = sched_park(thread)))
+            panic("failed to wake thread[%d], err=%d\n", thread_gettid(thread), err);
+    }
+    thread_unlock(thread);
+}
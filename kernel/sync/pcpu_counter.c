@@ -0,0 +1,60 @@
+#include <arch/cpu.h>
+#include <sync/pcpu_counter.h>
+#include <sync/preempt.h>
+
+// one row of slots per CPU, on cache lines of its own.
+typedef struct pcpu_row {
+    i64     pr_delta[PCPU_COUNTER_MAX];
+} __aligned(64) pcpu_row_t;
+
+static pcpu_row_t   pcpu_rows[MAXNCPU];
+static int          pcpu_nslots = 0;
+
+static int pcpu_counter_slot(pcpu_counter_t *pc) {
+    int slot  = 0;
+    int unset = 0;
+
+    if ((slot = atomic_read(&pc->pc_slot)))
+        return slot;
+
+    if ((slot = atomic_inc_fetch(&pcpu_nslots)) > PCPU_COUNTER_MAX)
+        slot = -1;
+
+    // lost to another CPU assigning a slot, that one's wasted.
+    if (!atomic_cmpxchg(&pc->pc_slot, unset, slot))
+        return unset;
+    return slot;
+}
+
+void pcpu_counter_add(pcpu_counter_t *pc, i64 delta) {
+    int slot    = 0;
+    i64 *local  = NULL;
+
+    if ((slot = pcpu_counter_slot(pc)) < 0) {
+        atomic_fetch_add(&pc->pc_count, delta);
+        return;
+    }
+
+    pushcli();
+    local = &pcpu_rows[cpu->apicID].pr_delta[slot - 1];
+    // pcpu_counter_sum() may read it from another CPU.
+    atomic_write(local, *local + delta);
+    if (*local >= PCPU_COUNTER_BATCH || *local <= -PCPU_COUNTER_BATCH) {
+        atomic_fetch_add(&pc->pc_count, *local);
+        atomic_write(local, 0);
+    }
+    popcli();
+}
+
+i64 pcpu_counter_sum(pcpu_counter_t *pc) {
+    int slot    = 0;
+    i64 sum     = 0;
+
+    sum = atomic_read(&pc->pc_count);
+    if ((slot = atomic_read(&pc->pc_slot)) <= 0)
+        return sum;
+
+    for (int i = 0; i < MAXNCPU; ++i)
+        sum += atomic_read(&pcpu_rows[i].pr_delta[slot - 1]);
+    return sum;
+}
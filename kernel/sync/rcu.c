@@ -0,0 +1,164 @@
+#include <arch/cpu.h>
+#include <ginger/tick.h>
+#include <sync/atomic.h>
+#include <sync/rcu.h>
+#include <sync/spinlock.h>
+
+/**
+ * Callbacks are batched per CPU, a batch waits for a single grace period.
+ * Only the owning CPU touches its lists, with interrupts disabled.
+ */
+typedef struct rcu_cpu {
+    rcu_head_t  *rc_next;       // queued since the batch in flight was started.
+    rcu_head_t  *rc_next_tail;
+    rcu_head_t  *rc_wait;       // batch in flight, waiting for grace period 'rc_wait_gp'.
+    u64         rc_wait_gp;
+} rcu_cpu_t;
+
+static rcu_cpu_t    rcu_cpus[MAXNCPU];
+
+// serializes grace period start and end.
+static SPINLOCK(rcu_lock);
+static u64          rcu_gp_cur      = 0;    // last grace period started.
+static u64          rcu_gp_done     = 0;    // last grace period completed.
+static int          rcu_gp_more     = 0;    // another grace period is needed after 'rcu_gp_cur'.
+static atomic_t     rcu_gp_cpus     = 0;    // CPUs yet to pass a quiescent state in 'rcu_gp_cur'.
+
+static atomic_t rcu_online(void) {
+    atomic_t mask = 0;
+
+    for (int i = 0; i < MAXNCPU; ++i) {
+        if (cpus[i] && (atomic_read(&cpus[i]->flags) & CPU_ONLINE))
+            mask |= BS(cpus[i]->apicID);
+    }
+    return mask;
+}
+
+/**
+ * @brief start a grace period. Called with rcu_lock held.
+ * @return int 1 if other CPUs have to be told about it.
+ */
+static int rcu_gp_start(void) {
+    rcu_gp_cur++;
+    atomic_write(&rcu_gp_cpus, rcu_online());
+    if (rcu_gp_cpus == 0) {
+        rcu_gp_done = rcu_gp_cur;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief grace period that covers callbacks queued until now.
+ * Called with rcu_lock held.
+ */
+static u64 rcu_gp_request(int *pkick) {
+    if (rcu_gp_cur == rcu_gp_done) {
+        *pkick |= rcu_gp_start();
+        return rcu_gp_cur;
+    }
+
+    // readers may have started before the one in progress.
+    rcu_gp_more = 1;
+    return rcu_gp_cur + 1;
+}
+
+// @return int 1 if a new grace period was started.
+static int rcu_report(void) {
+    int         kick = 0;
+    atomic_t    bit  = BS(getcpuid());
+
+    if ((atomic_read(&rcu_gp_cpus) & bit) == 0)
+        return 0;
+
+    spin_lock(rcu_lock);
+    if (rcu_gp_cpus & bit) {
+        atomic_and_fetch(&rcu_gp_cpus, ~bit);
+        if (rcu_gp_cpus == 0) {
+            rcu_gp_done = rcu_gp_cur;
+            if (rcu_gp_more) {
+                rcu_gp_more = 0;
+                kick = rcu_gp_start();
+            }
+        }
+    }
+    spin_unlock(rcu_lock);
+    return kick;
+}
+
+void rcu_quiescent(void) {
+    int kick = 0;
+
+    pushcli();
+    kick = rcu_report();
+    popcli();
+
+    // idle CPUs halt without a tick, wake them up so they report too.
+    if (kick)
+        tick_kick(NULL);
+}
+
+void call_rcu(rcu_head_t *head, void (*func)(rcu_head_t *head)) {
+    rcu_cpu_t *rc = NULL;
+
+    head->next = NULL;
+    head->func = func;
+
+    pushcli();
+    rc = &rcu_cpus[getcpuid()];
+    if (rc->rc_next_tail)
+        rc->rc_next_tail->next = head;
+    else
+        rc->rc_next = head;
+    rc->rc_next_tail = head;
+    popcli();
+}
+
+void rcu_process(void) {
+    int         kick    = 0;
+    rcu_cpu_t   *rc     = NULL;
+    rcu_head_t  *done   = NULL;
+    rcu_head_t  *next   = NULL;
+
+    pushcli();
+    kick = rcu_report();
+    rc   = &rcu_cpus[getcpuid()];
+
+    if (rc->rc_wait && (i64)(atomic_read(&rcu_gp_done) - rc->rc_wait_gp) >= 0) {
+        done        = rc->rc_wait;
+        rc->rc_wait = NULL;
+    }
+
+    if (rc->rc_wait == NULL && rc->rc_next) {
+        rc->rc_wait         = rc->rc_next;
+        rc->rc_next         = NULL;
+        rc->rc_next_tail    = NULL;
+
+        spin_lock(rcu_lock);
+        rc->rc_wait_gp = rcu_gp_request(&kick);
+        spin_unlock(rcu_lock);
+        // we are in a quiescent state, don't hold up the grace period just started.
+        kick |= rcu_report();
+    }
+    popcli();
+
+    if (kick)
+        tick_kick(NULL);
+
+    for (; done; done = next) {
+        next = done->next;
+        done->func(done);
+    }
+}
+
+int rcu_pending(void) {
+    int         pending = 0;
+    rcu_cpu_t   *rc     = NULL;
+
+    pushcli();
+    rc      = &rcu_cpus[getcpuid()];
+    pending = rc->rc_next || rc->rc_wait ||
+        (atomic_read(&rcu_gp_cpus) & BS(getcpuid()));
+    popcli();
+    return pending;
+}
@@ -0,0 +1,127 @@
+#include <bits/errno.h>
+#include <sync/waitq.h>
+#include <sys/sched.h>
+#include <sys/thread.h>
+
+static void waitq_add(waitq_t *wq, waitq_entry_t *we) {
+    waitq_entry_t *at = NULL;
+
+    // non-exclusive entries go before the exclusive ones, they are all woken anyway.
+    if (we->we_flags & WAITQ_EXCLUSIVE)
+        at = NULL;
+    else for (at = wq->wq_head; at && !(at->we_flags & WAITQ_EXCLUSIVE); at = at->we_next);
+
+    we->we_next = at;
+    we->we_prev = at ? at->we_prev : wq->wq_tail;
+
+    if (we->we_prev)
+        we->we_prev->we_next = we;
+    else
+        atomic_write(&wq->wq_head, we);
+
+    if (at)
+        at->we_prev = we;
+    else
+        wq->wq_tail = we;
+}
+
+static void waitq_del(waitq_t *wq, waitq_entry_t *we) {
+    if (we->we_prev)
+        we->we_prev->we_next = we->we_next;
+    else
+        atomic_write(&wq->wq_head, we->we_next);
+
+    if (we->we_next)
+        we->we_next->we_prev = we->we_prev;
+    else
+        wq->wq_tail = we->we_prev;
+
+    we->we_next = NULL;
+    we->we_prev = NULL;
+}
+
+// sleep on a locked 'wq' with 'we' already queued.
+static int waitq_sleep_queued(waitq_t *wq, waitq_entry_t *we) {
+    int err = 0;
+
+    current_lock();
+    err = sched_sleep(&we->we_queue, T_ISLEEP, &wq->wq_lock);
+    current_unlock();
+
+    if (!we->we_woken) {
+        waitq_del(wq, we);
+        return err;
+    }
+
+    // we took the place of another exclusive waiter but won't use it, pass it on.
+    if (err && (we->we_flags & WAITQ_EXCLUSIVE))
+        __waitq_wake(wq, 1, we->we_key);
+    return err;
+}
+
+int waitq_sleep(waitq_t *wq, waitq_entry_t *we) {
+    waitq_assert_locked(wq);
+    current_assert();
+
+    we->we_woken = 0;
+    waitq_add(wq, we);
+    return waitq_sleep_queued(wq, we);
+}
+
+int waitq_wait(waitq_t *wq, waitq_entry_t *we, spinlock_t *lk) {
+    int err = 0;
+
+    current_assert();
+
+    // queue up before dropping 'lk', wakers holding it rely on waitq_active().
+    waitq_lock(wq);
+    we->we_woken = 0;
+    waitq_add(wq, we);
+
+    if (lk)
+        spin_unlock(lk);
+
+    err = waitq_sleep_queued(wq, we);
+    waitq_unlock(wq);
+
+    if (lk)
+        spin_lock(lk);
+    return err;
+}
+
+size_t __waitq_wake(waitq_t *wq, size_t nexclusive, unsigned long key) {
+    size_t          woken   = 0;
+    waitq_entry_t   *next   = NULL;
+
+    waitq_assert_locked(wq);
+
+    for (waitq_entry_t *we = wq->wq_head; we; we = next) {
+        next = we->we_next;
+
+        if (key && we->we_key && !(we->we_key & key))
+            continue;
+
+        if (we->we_func && !we->we_func(we, key))
+            continue;
+
+        waitq_del(wq, we);
+        we->we_woken = 1;
+        // the waiter is on we_queue unless a signal got to it first.
+        sched_wake1(&we->we_queue);
+        woken++;
+
+        if ((we->we_flags & WAITQ_EXCLUSIVE) && nexclusive && --nexclusive == 0)
+            break;
+    }
+
+    return woken;
+}
+
+size_t waitq_wake(waitq_t *wq, size_t nexclusive, unsigned long key) {
+    size_t woken = 0;
+
+    waitq_lock(wq);
+    woken = __waitq_wake(wq, nexclusive, key);
+    waitq_unlock(wq);
+    return woken;
+}
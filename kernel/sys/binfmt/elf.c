@@ -1,5 +1,6 @@
 #include <bits/errno.h>
 #include <fs/fs.h>
+#include <ginger/vdso.h>
 #include <lib/string.h>
 #include <mm/kalloc.h>
 #include <mm/mmap.h>
@@ -88,6 +89,9 @@ int binfmt_elf_load(inode_t *binary, mmap_t *mmap, thread_entry_t *entry) {
 
     // mmap_dump_list(*proc->mmap);
 
+    if ((err = vdso_map(mmap)))
+        goto error;
+
     kfree(phdr);
     *entry = (thread_entry_t)elf.e_entry;
     return 0;
@@ -0,0 +1,343 @@
+#include <arch/paging.h>
+#include <arch/uaccess.h>
+#include <bits/errno.h>
+#include <ginger/ktimer.h>
+#include <lib/printk.h>
+#include <mm/mmap.h>
+#include <sync/atomic.h>
+#include <sync/spinlock.h>
+#include <sys/futex.h>
+#include <sys/sched.h>
+#include <sys/thread.h>
+
+#define FUTEX_HASHBITS      8
+#define FUTEX_NBUCKETS      (1 << FUTEX_HASHBITS)
+
+// times futex_getkey() tries to fault the word in before giving up.
+#define FUTEX_FAULT_RETRY   2
+
+/**
+ * A word in a shared mapping is identified by its physical address,
+ * so every address space mapping the page agrees on the key.
+ * Any other word is identified by its address space and virtual address,
+ * as its page may still be shared copy-on-write with another process.
+ */
+typedef struct futex_key {
+    mmap_t      *fk_mmap;   // NULL for shared keys.
+    uintptr_t   fk_addr;    // physical address of shared keys, virtual otherwise.
+} futex_key_t;
+
+struct futex_bucket;
+
+typedef struct futex_waiter {
+    futex_key_t         fw_key;
+    u32                 fw_bitset;
+    struct futex_bucket *fw_bucket;     // bucket queued on, changed by FUTEX_REQUEUE.
+    queue_t             fw_queue;       // sleep queue holding only the waiting thread.
+    int                 fw_woken;       // unlinked by a wake.
+    int                 fw_timedout;
+    ktimer_t            fw_timer;       // wakes the waiter once its timeout expires.
+    struct futex_waiter *fw_prev;
+    struct futex_waiter *fw_next;
+} futex_waiter_t;
+
+typedef struct futex_bucket {
+    spinlock_t          fb_lock;
+    futex_waiter_t      *fb_head;
+    futex_waiter_t      *fb_tail;
+} futex_bucket_t;
+
+static futex_bucket_t   futex_table[FUTEX_NBUCKETS];
+
+static futex_bucket_t *futex_hash(futex_key_t *key) {
+    u64 hash = (key->fk_addr >> 2) ^ ((uintptr_t)key->fk_mmap >> 4);
+    return &futex_table[(hash * 0x9E3779B97F4A7C15ul) >> (64 - FUTEX_HASHBITS)];
+}
+
+static int futex_key_eq(futex_key_t *a, futex_key_t *b) {
+    return a->fk_mmap == b->fk_mmap && a->fk_addr == b->fk_addr;
+}
+
+static void futex_bucket_append(futex_bucket_t *bucket, futex_waiter_t *waiter) {
+    waiter->fw_next = NULL;
+    if ((waiter->fw_prev = bucket->fb_tail))
+        bucket->fb_tail->fw_next = waiter;
+    else
+        bucket->fb_head = waiter;
+    bucket->fb_tail = waiter;
+    atomic_write(&waiter->fw_bucket, bucket);
+}
+
+static void futex_bucket_unlink(futex_bucket_t *bucket, futex_waiter_t *waiter) {
+    if (waiter->fw_prev)
+        waiter->fw_prev->fw_next = waiter->fw_next;
+    else
+        bucket->fb_head = waiter->fw_next;
+
+    if (waiter->fw_next)
+        waiter->fw_next->fw_prev = waiter->fw_prev;
+    else
+        bucket->fb_tail = waiter->fw_prev;
+
+    waiter->fw_prev = NULL;
+    waiter->fw_next = NULL;
+}
+
+// lock the bucket 'waiter' is queued on, it may be requeued meanwhile.
+static futex_bucket_t *futex_waiter_lock(futex_waiter_t *waiter) {
+    futex_bucket_t *bucket = NULL;
+
+    for (;;) {
+        bucket = atomic_read(&waiter->fw_bucket);
+        spin_lock(&bucket->fb_lock);
+        if (bucket == waiter->fw_bucket)
+            return bucket;
+        spin_unlock(&bucket->fb_lock);
+    }
+}
+
+static void futex_timeout(ktimer_t *tm) {
+    futex_waiter_t *waiter = tm->tm_arg;
+    futex_bucket_t *bucket = NULL;
+
+    bucket = futex_waiter_lock(waiter);
+    waiter->fw_timedout = 1;
+    sched_wake1(&waiter->fw_queue);
+    spin_unlock(&bucket->fb_lock);
+}
+
+/**
+ * @brief compute the key of the futex word at 'uaddr'.
+ * The word is faulted in first(-EFAULT if it can't be), on success returns with the mmap
+ * read-locked so that the page can't be unmapped before the caller is done with it.
+ */
+static int futex_getkey(u32 *uaddr, int private, futex_key_t *key) {
+    u32         word    = 0;
+    vmr_t       *vmr    = NULL;
+    pte_t       *pte    = NULL;
+    mmap_t      *mmap   = NULL;
+    uintptr_t   addr    = (uintptr_t)uaddr;
+
+    if (addr == 0 || (addr & (sizeof *uaddr - 1)) || iskernel_addr(addr))
+        return -EINVAL;
+
+    if (!access_ok(uaddr, sizeof *uaddr))
+        return -EFAULT;
+
+    current_assert();
+    if ((mmap = current->t_mmap) == NULL)
+        return -EFAULT;
+
+    for (int retry = 0; retry < FUTEX_FAULT_RETRY; ++retry) {
+        // the fault handler takes the read side too, so touch the word before locking.
+        if (copy_from_user(&word, uaddr, sizeof word))
+            return -EFAULT;
+
+        mmap_read_lock(mmap);
+        if ((vmr = mmap_find(mmap, addr)) == NULL) {
+            mmap_read_unlock(mmap);
+            return -EFAULT;
+        }
+
+        if (arch_getmapping(addr, &pte) == 0) {
+            if (private || !__vm_shared(vmr->vflags))
+                *key = (futex_key_t){ .fk_mmap = mmap, .fk_addr = addr };
+            else
+                *key = (futex_key_t){ .fk_mmap = NULL, .fk_addr = GETPHYS(pte) + PGOFF(addr) };
+            return 0;
+        }
+        mmap_read_unlock(mmap);
+    }
+
+    return -EFAULT;
+}
+
+static long futex_wait(u32 *uaddr, int private, u32 val, const struct timespec *utimeout, u32 bitset) {
+    long            err     = 0;
+    u32             word    = 0;
+    jiffies_t       ticks   = 0;
+    struct timespec ts      = {0};
+    struct timespec *timeout= NULL;
+    futex_bucket_t  *bucket = NULL;
+    futex_waiter_t  waiter  = {0};
+
+    if (bitset == 0)
+        return -EINVAL;
+
+    if (utimeout) {
+        if (copy_from_user(&ts, utimeout, sizeof ts))
+            return -EFAULT;
+        timeout = &ts;
+
+        if (timeout->tv_sec < 0 || timeout->tv_nsec < 0 || timeout->tv_nsec >= NSEC_PER_SEC)
+            return -EINVAL;
+        // never wake before the full timeout has elapsed.
+        ticks = TIMESPEC_TO_JIFFIES(timeout);
+        if (timeout->tv_nsec % (NSEC_PER_SEC / SYS_HZ))
+            ticks++;
+    }
+
+    if ((err = futex_getkey(uaddr, private, &waiter.fw_key)))
+        return err;
+
+    waiter.fw_bitset = bitset;
+    waiter.fw_queue  = QUEUE_INIT();
+    waiter.fw_timer  = KTIMER_INIT(futex_timeout, &waiter);
+    bucket = futex_hash(&waiter.fw_key);
+
+    /**
+     * Wakers change the word before they take the bucket lock,
+     * so comparing it under the lock can't miss a wake.
+     */
+    spin_lock(&bucket->fb_lock);
+    // futex_getkey() found the page mapped and the read side keeps it so, this can't fault.
+    word = atomic_read(uaddr);
+    mmap_read_unlock(current->t_mmap);
+
+    if (word != val) {
+        spin_unlock(&bucket->fb_lock);
+        return -EAGAIN;
+    }
+
+    if (timeout && ticks == 0) {
+        spin_unlock(&bucket->fb_lock);
+        return -ETIMEDOUT;
+    }
+
+    futex_bucket_append(bucket, &waiter);
+    if (timeout)
+        ktimer_add(&waiter.fw_timer, jiffies_get() + ticks);
+
+    current_lock();
+    err = sched_sleep(&waiter.fw_queue, T_ISLEEP, &bucket->fb_lock);
+    current_unlock();
+    // sched_sleep() relocked the bucket we went to sleep on.
+    spin_unlock(&bucket->fb_lock);
+
+    // 'waiter' lives on our stack, the timer must be done with it.
+    if (timeout)
+        ktimer_del_sync(&waiter.fw_timer);
+
+    bucket = futex_waiter_lock(&waiter);
+    if (!waiter.fw_woken)
+        futex_bucket_unlink(bucket, &waiter);
+    spin_unlock(&bucket->fb_lock);
+
+    if (waiter.fw_woken)
+        return 0;
+    if (err)
+        return err;
+    return waiter.fw_timedout ? -ETIMEDOUT : -EINTR;
+}
+
+// wake up to 'nr' waiters for 'key' on a locked 'bucket'.
+static long futex_wake_locked(futex_bucket_t *bucket, futex_key_t *key, long nr, u32 bitset) {
+    long            woken   = 0;
+    futex_waiter_t  *next   = NULL;
+
+    spin_assert_locked(&bucket->fb_lock);
+
+    for (futex_waiter_t *waiter = bucket->fb_head; waiter && woken < nr; waiter = next) {
+        next = waiter->fw_next;
+        if (!futex_key_eq(&waiter->fw_key, key) || !(waiter->fw_bitset & bitset))
+            continue;
+
+        futex_bucket_unlink(bucket, waiter);
+        waiter->fw_woken = 1;
+        // the waiter can't leave futex_wait() before we drop the bucket lock.
+        sched_wake1(&waiter->fw_queue);
+        woken++;
+    }
+
+    return woken;
+}
+
+static long futex_wake(u32 *uaddr, int private, u32 nr, u32 bitset) {
+    long            err     = 0;
+    futex_key_t     key     = {0};
+    futex_bucket_t  *bucket = NULL;
+
+    if (bitset == 0)
+        return -EINVAL;
+
+    if ((err = futex_getkey(uaddr, private, &key)))
+        return err;
+    mmap_read_unlock(current->t_mmap);
+
+    bucket = futex_hash(&key);
+    spin_lock(&bucket->fb_lock);
+    err = futex_wake_locked(bucket, &key, nr, bitset);
+    spin_unlock(&bucket->fb_lock);
+
+    return err;
+}
+
+static long futex_requeue(u32 *uaddr, int private, u32 nr_wake, u32 nr_requeue, u32 *uaddr2) {
+    long            err     = 0;
+    long            count   = 0;
+    long            moved   = 0;
+    futex_key_t     key1    = {0};
+    futex_key_t     key2    = {0};
+    futex_bucket_t  *b1     = NULL;
+    futex_bucket_t  *b2     = NULL;
+    futex_bucket_t  *lo     = NULL;
+    futex_bucket_t  *hi     = NULL;
+    futex_waiter_t  *next   = NULL;
+
+    if ((err = futex_getkey(uaddr, private, &key1)))
+        return err;
+    mmap_read_unlock(current->t_mmap);
+
+    if ((err = futex_getkey(uaddr2, private, &key2)))
+        return err;
+    mmap_read_unlock(current->t_mmap);
+
+    b1 = futex_hash(&key1);
+    b2 = futex_hash(&key2);
+
+    // take both buckets in address order.
+    lo = b1 < b2 ? b1 : b2;
+    hi = b1 < b2 ? b2 : b1;
+    spin_lock(&lo->fb_lock);
+    if (hi != lo)
+        spin_lock(&hi->fb_lock);
+
+    count = futex_wake_locked(b1, &key1, nr_wake, FUTEX_BITSET_MATCH_ANY);
+
+    for (futex_waiter_t *waiter = b1->fb_head; waiter && moved < nr_requeue; waiter = next) {
+        next = waiter->fw_next;
+        if (!futex_key_eq(&waiter->fw_key, &key1))
+            continue;
+
+        futex_bucket_unlink(b1, waiter);
+        waiter->fw_key = key2;
+        futex_bucket_append(b2, waiter);
+        moved++;
+    }
+
+    if (hi != lo)
+        spin_unlock(&hi->fb_lock);
+    spin_unlock(&lo->fb_lock);
+
+    return count + moved;
+}
+
+long futex(u32 *uaddr, int op, u32 val, const struct timespec *timeout, u32 *uaddr2, u32 val3) {
+    int private = op & FUTEX_PRIVATE_FLAG;
+
+    switch (op & FUTEX_CMD_MASK) {
+    case FUTEX_WAIT:
+        return futex_wait(uaddr, private, val, timeout, FUTEX_BITSET_MATCH_ANY);
+    case FUTEX_WAIT_BITSET:
+        return futex_wait(uaddr, private, val, timeout, val3);
+    case FUTEX_WAKE:
+        return futex_wake(uaddr, private, val, FUTEX_BITSET_MATCH_ANY);
+    case FUTEX_WAKE_BITSET:
+        return futex_wake(uaddr, private, val, val3);
+    case FUTEX_REQUEUE:
+        // like Linux, the timeout slot carries the number of waiters to requeue.
+        return futex_requeue(uaddr, private, val, (u32)(uintptr_t)timeout, uaddr2);
+    }
+
+    return -ENOSYS;
+}
@@ -2,6 +2,7 @@
 #include <fs/fs.h>
 #include <lib/string.h>
 #include <mm/kalloc.h>
+#include <sync/rcu.h>
 #include <sys/proc.h>
 #include <sys/elf/elf.h>
 
@@ -16,6 +17,7 @@ static struct binfmt {
 };
 
 proc_t *initproc = NULL;
+// lookups walk it under rcu_read_lock(), changes are serialized by its queue lock.
 queue_t *procQ   = QUEUE_NEW();
 
 // bucket to hold free'd PIDs.
@@ -61,7 +63,7 @@ int procQ_remove(proc_t *proc) {
     
     proc_assert_locked(proc);
     queue_lock(procQ);
-    if ((err = queue_remove(procQ, proc)) == 0)
+    if ((err = queue_remove_rcu(procQ, proc)) == 0)
         proc_putref(proc);
     queue_unlock(procQ);
     return err;
@@ -97,47 +99,47 @@ void procQ_remove_bypid(pid_t pid) {
     queue_unlock(procQ);
 }
 
-int procQ_search_bypid(pid_t pid, proc_t **ref) {
+/**
+ * Lookups walk procQ under rcu_read_lock() without taking any shared lock.
+ * Nodes and procs unlinked meanwhile are only freed after a grace period,
+ * so the key is compared locklessly and rechecked once the proc lock is held.
+ * A proc whose last reference is gone is being freed and is skipped.
+ */
+static int procQ_search(int bypgid, pid_t id, proc_t **ref) {
     proc_t *proc = NULL;
-    queue_lock(procQ);
-    forlinked(node, procQ->head, node->next) {
+
+#define procQ_key(p) (bypgid ? (p)->pgid : (p)->pid)
+    rcu_read_lock();
+    forlinked(node, rcu_dereference(procQ->head), rcu_dereference(node->next)) {
         proc = node->data;
+        if (procQ_key(proc) != id)
+            continue;
+
         proc_lock(proc);
-        if (proc->pid == pid) {
-            if (ref)
-                *ref = proc_getref(proc);
-            else
-                proc_unlock(proc);
-            queue_unlock(procQ);
-            return 0;
+        if (proc->refcnt <= 0 || procQ_key(proc) != id) {
+            proc_unlock(proc);
+            continue;
         }
-        proc_unlock(proc);
+
+        if (ref)
+            *ref = proc_getref(proc);
+        else
+            proc_unlock(proc);
+        rcu_read_unlock();
+        return 0;
     }
-    queue_unlock(procQ);
+    rcu_read_unlock();
+#undef procQ_key
 
     return -ESRCH;
 }
 
-int procQ_search_bypgid(pid_t pgid, proc_t **ref) {
-    proc_t *proc = NULL;
-
-    queue_lock(procQ);
-    forlinked(node, procQ->head, node->next) {
-        proc = node->data;
-        proc_lock(proc);
-        if (proc->pgid == pgid) {
-            if (ref)
-                *ref = proc_getref(proc);
-            else
-                proc_unlock(proc);
-            queue_unlock(procQ);
-            return 0;
-        }
-        proc_unlock(proc);
-    }
-    queue_unlock(procQ);
+int procQ_search_bypid(pid_t pid, proc_t **ref) {
+    return procQ_search(0, pid, ref);
+}
 
-    return -ESRCH;
+int procQ_search_bypgid(pid_t pgid, proc_t **ref) {
+    return procQ_search(1, pgid, ref);
 }
 
 int proc_alloc(const char *name, proc_t **pref) {
@@ -175,6 +177,7 @@ int proc_alloc(const char *name, proc_t **pref) {
     proc->pgid          = proc->pid;
     proc->sid           = proc->pid;
     proc->child_event   = COND_INIT();
+    proc->p_alarm       = KTIMER_INIT(trigger_alarm, (void *)(long)proc->pid);
     proc->lock          = SPINLOCK_INIT();
     proc->cred          = thread->t_cred;
     proc->fctx          = thread->t_fctx;
@@ -207,6 +210,10 @@ error:
     return err;
 }
 
+static void proc_free_rcu(rcu_head_t *head) {
+    kfree(container_of(head, proc_t, p_rcu));
+}
+
 void proc_free(proc_t *proc) {
     if (proc == NULL)
         return;
@@ -238,12 +245,23 @@ void proc_free(proc_t *proc) {
 
         proc_free_pid(proc->pid);
 
+        /**
+         * trigger_alarm() may still be running on another CPU, but it runs with
+         * interrupts disabled so the grace period below outlasts it.
+         */
+        ktimer_del(&proc->p_alarm);
+
         proc_unlock(proc);
 
         /// TODO: a solution to the problem above
         /// may be to kill the thread(s) waiting
         /// to avoid access to resources that have already been released.
-        kfree(proc);
+
+        // unlike p_alarm these are freed here, wait for their functions.
+        timer_delete_all(proc);
+
+        // procQ_search() may still be looking at it.
+        call_rcu(&proc->p_rcu, proc_free_rcu);
         return;
     }
 
@@ -167,12 +167,23 @@ thread_t *sched_getembryo(void) {
 }
 
 int sched_putembryo(thread_t *thread) {
+    int err = 0;
+
     if (thread == NULL)
         return -EINVAL;
 
     thread_assert_locked(thread);
     thread_enter_state(thread, T_EMBRYO);
-    return thread_enqueue(embryo_queue, thread, NULL);
+    if ((err = thread_enqueue(embryo_queue, thread, NULL)))
+        return err;
+
+    // embryos are picked up by any CPU, so wake them all.
+    tick_kick(NULL);
+    return 0;
+}
+
+size_t sched_nembryo(void) {
+    return atomic_read(&embryo_queue->q_count);
 }
 
 void sched_remove_zombies(void) {
@@ -10,6 +10,138 @@
 #include <ginger/jiffies.h>
 #include <arch/lapic.h>
 #include <sys/proc.h>
+#include <ginger/tick.h>
+#include <ginger/clocksource.h>
+#include <ginger/vdso.h>
+#include <sys/sysprot.h>
+#include <sync/rcu.h>
+
+// scheduling classes sorted by rank.
+static sched_t *sched_classes[] = {
+    &sched_rt,
+    &sched_mlfq,
+    &sched_fair,
+};
+
+sched_t *sched_class(int policy) {
+    switch (policy) {
+    case SCHED_RR:
+        __fallthrough;
+    case SCHED_FIFO:
+        return &sched_rt;
+    case SCHED_MLFQ:
+        return &sched_mlfq;
+    case SCHED_FAIR:
+        return &sched_fair;
+    default:
+        return NULL;
+    }
+}
+
+int sched_rank(int policy) {
+    sched_t *class = sched_class(policy);
+    return class ? class->s_rank : SCHED_NRANKS;
+}
+
+u64 sched_clock(void) {
+    return clocksource_ns();
+}
+
+u64 sched_cputime(thread_t *thread) {
+    u64             ran     = 0;
+    thread_sched_t  *tsched = &thread->t_sched;
+
+    thread_assert_locked(thread);
+    // add the time it has been running for, if it is on a CPU right now.
+    if (tsched->ts_last_sched)
+        ran = sched_clock() - tsched->ts_last_sched;
+    return tsched->ts_cpu_time + ran;
+}
+
+void sched_stat_add(sched_stat_t *dst, const sched_stat_t *src) {
+    dst->ss_run_sum     += src->ss_run_sum;
+    dst->ss_wait_sum    += src->ss_wait_sum;
+    dst->ss_idle_sum    += src->ss_idle_sum;
+    dst->ss_nrun        += src->ss_nrun;
+    dst->ss_nvcsw       += src->ss_nvcsw;
+    dst->ss_nivcsw      += src->ss_nivcsw;
+    dst->ss_migrations  += src->ss_migrations;
+    for (size_t b = 0; b < SCHED_LAT_NBUCKETS; ++b)
+        dst->ss_lat[b]  += src->ss_lat[b];
+}
+
+/**
+ * @brief account for 'current' being switched in at 'now'.
+ * Only this CPU updates its own counters so no locking is needed for them.
+ */
+static void sched_stat_switchin(u64 now) {
+    u64             waited  = 0;
+    thread_sched_t  *tsched = &current->t_sched;
+    sched_stat_t    *cstat  = &cpu->sched_stat;
+
+    if (tsched->ts_enqueued && now > tsched->ts_enqueued)
+        waited = now - tsched->ts_enqueued;
+
+    tsched->ts_stat.ss_wait_sum += waited;
+    cstat->ss_wait_sum          += waited;
+
+    if (tsched->ts_waking) {
+        tsched->ts_stat.ss_lat[SCHED_LAT_BUCKET(waited)]++;
+        cstat->ss_lat[SCHED_LAT_BUCKET(waited)]++;
+    }
+
+    if (tsched->ts_lastcpu && tsched->ts_lastcpu != cpu) {
+        tsched->ts_stat.ss_migrations++;
+        cstat->ss_migrations++;
+    }
+
+    tsched->ts_stat.ss_nrun++;
+    cstat->ss_nrun++;
+    tsched->ts_lastcpu  = cpu;
+    tsched->ts_enqueued = 0;
+    tsched->ts_waking   = 0;
+}
+
+/**
+ * @brief account for 'current' having run for 'ran' ns.
+ * A thread still T_READY was preempted or yielded, anything else gave up the CPU.
+ */
+static void sched_stat_switchout(u64 ran) {
+    thread_sched_t  *tsched = &current->t_sched;
+    sched_stat_t    *cstat  = &cpu->sched_stat;
+
+    tsched->ts_stat.ss_run_sum  += ran;
+    cstat->ss_run_sum           += ran;
+
+    if (current_isstate(T_READY)) {
+        tsched->ts_stat.ss_nivcsw++;
+        cstat->ss_nivcsw++;
+    } else {
+        tsched->ts_stat.ss_nvcsw++;
+        cstat->ss_nvcsw++;
+    }
+}
+
+static void sched_queue_free(sched_queue_t *rq) {
+    for (size_t i = 0; i < NELEM(rq->level); ++i) {
+        if (rq->level[i].queue) {
+            queue_free(rq->level[i].queue);
+            rq->level[i].queue = NULL;
+        }
+    }
+
+    for (size_t i = 0; i < NELEM(rq->rt); ++i) {
+        if (rq->rt[i]) {
+            queue_free(rq->rt[i]);
+            rq->rt[i] = NULL;
+        }
+    }
+
+    if (rq->fair) {
+        queue_free(rq->fair);
+        rq->fair = NULL;
+    }
+}
 
 int sched_init(void) {
     int err = 0;
@@ -20,20 +152,14 @@ int sched_init(void) {
     
     memset(&ready_queue, 0, sizeof ready_queue);
 
-    for (size_t i = 0; i < NELEM(ready_queue.level); ++i) {
-        if ((err = queue_alloc(&ready_queue.level[i].queue)))
+    for (size_t i = 0; i < NELEM(sched_classes); ++i) {
+        if ((err = sched_classes[i]->s_init(&ready_queue)))
             goto error;
-        ready_queue.level[i].quatum = ms_TO_jiffies(20);
     }
 
     return 0;
 error:
-    for (size_t i = 0; i < NELEM(ready_queue.level); ++i) {
-        if (ready_queue.level[i].queue) {
-            queue_free(ready_queue.level[i].queue);
-            ready_queue.level->queue = NULL;
-        }
-    }
+    sched_queue_free(&ready_queue);
     return err;
 }
 
@@ -70,13 +196,98 @@ void sched_yield(void) {
     current_unlock();
 }
 
+/**
+ * @brief should thread 'a' preempt thread 'b'?
+ * Only reads scheduling attributes of 'b', so it need not be locked.
+ */
+static int sched_outranks(thread_t *a, thread_t *b) {
+    int rank_a = sched_rank(a->t_sched.ts_policy);
+    int rank_b = sched_rank(atomic_read(&b->t_sched.ts_policy));
+
+    if (rank_a != rank_b)
+        return rank_a < rank_b;
+
+    // real-time threads preempt less urgent ones of the same class.
+    if (sched_class(a->t_sched.ts_policy) == &sched_rt)
+        return a->t_sched.ts_priority > atomic_read(&b->t_sched.ts_priority);
+    return 0;
+}
+
+// a CPU with at most this many threads(running + queued) still keeps a woken thread's cache warm.
+#define SCHED_LIGHT_LOAD    2
+
+/**
+ * @brief threads running or queued on 'processor', the embryo queue is not counted.
+ */
+static size_t sched_load(cpu_t *processor) {
+    size_t  load    = atomic_read(&processor->thread) ? 1 : 0;
+
+    for (size_t i = 0; i < NELEM(sched_classes); ++i)
+        load += sched_classes[i]->s_nready(&processor->queueq);
+    return load;
+}
+
+/**
+ * @brief CPUs 'thread' may be parked on.
+ */
+static flags32_t sched_allowed(thread_sched_t *tsched) {
+    if (tsched->ts_affinity.type == HARD_AFFINITY)
+        return tsched->ts_affinity.cpu_set;
+    return (flags32_t)-1;
+}
+
+static int sched_cpu_usable(cpu_t *processor, flags32_t allowed) {
+    if (processor == NULL || processor->apicID >= MAXNCPU)
+        return 0;
+    if ((atomic_read(&processor->flags) & CPU_SCHED) == 0)
+        return 0;
+    return BTEST(allowed, processor->apicID) != 0;
+}
+
+/**
+ * @brief pick the run-queue for 'thread'.
+ * A preempted thread stays on its CPU. A waking thread goes back to the
+ * CPU it last ran on(its cache is still warm) unless that CPU is busy,
+ * then to an idle CPU, then to the least loaded one.
+ */
+static cpu_t *sched_select_cpu(thread_t *thread) {
+    size_t          load        = 0;
+    size_t          best_load   = (size_t)-1;
+    cpu_t           *best       = NULL;
+    cpu_t           *last       = NULL;
+    thread_sched_t  *tsched     = &thread->t_sched;
+    flags32_t       allowed     = sched_allowed(tsched);
+
+    if (thread == current && sched_cpu_usable(cpu, allowed))
+        return cpu;
+
+    last = tsched->ts_lastcpu ? tsched->ts_lastcpu : tsched->ts_processor;
+    if (sched_cpu_usable(last, allowed) && sched_load(last) <= SCHED_LIGHT_LOAD)
+        return last;
+
+    for (int id = 0; id < MAXNCPU; ++id) {
+        if (!sched_cpu_usable(cpus[id], allowed))
+            continue;
+
+        if ((load = sched_load(cpus[id])) == 0)
+            return cpus[id];
+
+        if (load < best_load) {
+            best        = cpus[id];
+            best_load   = load;
+        }
+    }
+
+    // no CPU is allowed(none has started scheduling yet), stay local.
+    return best ? best : cpu;
+}
+
 int sched_park(thread_t *thread) {
-    int             prior       = 0;
-    int             affini      = 0;
-    level_t         *lvl        = NULL;
+    int             err         = 0;
+    sched_t         *class      = NULL;
+    thread_t        *running    = NULL;
     cpu_t           *processor  = NULL;
     thread_sched_t  *tsched     = NULL;
-    int             core        = getcpuid();
 
     if (thread == NULL)
         return -EINVAL;
@@ -87,36 +298,41 @@ int sched_park(thread_t *thread) {
         return sched_putembryo(thread);
     }
 
-    tsched  = &thread->t_sched;
-    prior   = tsched->ts_priority;
-    affini  = tsched->ts_affinity.type;
-
-    if (affini == HARD_AFFINITY) {
-        /// test cpus for affinity
-        /// if thread has hard affinity scheduling enabled.
-        for (core = 0; core < cpu_online(); core++) {
-            if (BTEST(tsched->ts_affinity.cpu_set, core))
-                break;
-        }
+    tsched      = &thread->t_sched;
+    processor   = sched_select_cpu(thread);
+    tsched->ts_processor = processor;
 
-        if (core >= cpu_online()) {
-            core = getcpuid();
-            tsched->ts_affinity.cpu_set |= BS(core);
-        }
-    }
+    // a thread re-queued by its own CPU in schedule() was preempted, anything else is waking up.
+    tsched->ts_enqueued  = sched_clock();
+    tsched->ts_waking    = thread != current;
 
-    processor = tsched->ts_processor ? tsched->ts_processor : cpus[core];
+    if ((class = sched_class(tsched->ts_policy)) == NULL)
+        return -EINVAL;
+
+    if ((err = class->s_park(&processor->queueq, thread)))
+        return err;
+
+    running = atomic_read(&processor->thread);
+    if (running && running != thread && sched_outranks(thread, running))
+        tick_preempt(processor);
+    else // the processor may have stopped its tick, let it know it has work.
+        tick_kick(processor);
+    return 0;
+}
+
+size_t sched_nready(cpu_t *processor) {
+    size_t  nready  = 0;
 
     if (processor == NULL)
-        processor = cpu;
-    
-    tsched->ts_processor = processor;
-    lvl = &processor->queueq.level[SCHED_LEVEL(prior)];
-    return thread_enqueue(lvl->queue, thread, NULL);
+        return 0;
+
+    for (size_t i = 0; i < NELEM(sched_classes); ++i)
+        nready += sched_classes[i]->s_nready(&processor->queueq);
+
+    return nready + sched_nembryo();
 }
 
 thread_t *sched_next(void) {
-    level_t  *lvl    = NULL;
     thread_t *thread = NULL;
 
     if (NULL == (thread = sched_getembryo()))
@@ -126,20 +342,267 @@ thread_t *sched_next(void) {
     assert(!sched_park(thread), "Failed to park\n");
     thread_unlock(thread);
 self:
-    thread = NULL;
-    for (int i = 0; i < NLEVELS; ++i) {
-        lvl = &ready_queue.level[i];
-        queue_lock(lvl->queue);
-        thread = thread_dequeue(lvl->queue);
-        queue_unlock(lvl->queue);
+    // the first class of a shared rank to be asked changes with every pick.
+    for (size_t i = 0, n = 0; i < NELEM(sched_classes); i += n) {
+        for (n = 1; i + n < NELEM(sched_classes); ++n) {
+            if (sched_classes[i + n]->s_rank != sched_classes[i]->s_rank)
+                break;
+        }
 
-        if (thread == NULL)
-            continue;
-        
-        thread->t_sched.ts_timeslice = lvl->quatum;
+        for (size_t k = 0; k < n; ++k) {
+            if ((thread = sched_classes[i + (ready_queue.turn + k) % n]->s_next(&ready_queue))) {
+                ready_queue.turn += n > 1;
+                return thread;
+            }
+        }
+    }
+    return NULL;
+}
+
+// thread 'tid' of the calling process, returned locked, e.g. a manager pinning its workers.
+static thread_t *sched_lookup(tid_t tid) {
+    int         err     = 0;
+    thread_t    *thread = NULL;
+
+    if (tid == 0 || tid == thread_self()) {
+        current_lock();
+        return current;
+    }
+
+    // tgroup_get_thread() takes -1 for any thread.
+    if (tid < 0 || current_tgroup() == NULL)
+        return NULL;
+
+    current_tgroup_lock();
+    err = tgroup_get_thread(current_tgroup(), tid, T_READY, &thread);
+    current_tgroup_unlock();
+    return err ? NULL : thread;
+}
+
+static void sched_lookup_done(thread_t *thread) {
+    if (thread == current) {
+        current_unlock();
+        return;
+    }
+    thread_release(thread);
+}
+
+int sched_setscheduler(tid_t tid, int policy, const struct sched_param *param) {
+    int         prio    = 0;
+    thread_t    *thread = NULL;
+
+    if (param == NULL || sched_class(policy) == NULL)
+        return -EINVAL;
+
+    prio = param->sched_priority;
+    switch (policy) {
+    case SCHED_RR:
+        __fallthrough;
+    case SCHED_FIFO:
+        if (prio < SCHED_RT_MINPRIO || prio > SCHED_RT_MAXPRIO)
+            return -EINVAL;
+        // only the superuser may run real-time threads.
+        if (current_isuser() && geteuid() != 0)
+            return -EPERM;
+        break;
+    case SCHED_MLFQ:
+        if (prio < SCHED_HIGHEST_PRIORITY || prio > SCHED_LOWEST_PRIORITY)
+            return -EINVAL;
         break;
+    default:
+        if (prio != 0)
+            return -EINVAL;
+    }
+
+    if ((thread = sched_lookup(tid)) == NULL)
+        return -ESRCH;
+
+    /**
+     * A thread already sitting on a run-queue keeps its place there,
+     * the new policy takes effect the next time it is parked.
+     * The calling thread gives up its timeslice so that happens right away.
+     */
+    thread->t_sched.ts_base_priority    = prio;
+    if (thread->t_sched.ts_pi_boosted) {
+        // takes effect once the inherited priority is dropped.
+        thread->t_sched.ts_pi_policy    = policy;
+        thread->t_sched.ts_pi_priority  = prio;
+    } else {
+        thread->t_sched.ts_policy       = policy;
+        thread->t_sched.ts_priority     = prio;
+    }
+    if (thread == current)
+        current->t_sched.ts_timeslice = 0;
+
+    sched_lookup_done(thread);
+    return 0;
+}
+
+int sched_getscheduler(tid_t tid) {
+    int         policy  = 0;
+    thread_t    *thread = NULL;
+
+    if ((thread = sched_lookup(tid)) == NULL)
+        return -ESRCH;
+
+    policy = thread->t_sched.ts_pi_boosted ?
+        thread->t_sched.ts_pi_policy : thread->t_sched.ts_policy;
+    sched_lookup_done(thread);
+    return policy;
+}
+
+int sched_setaffinity(tid_t tid, size_t setsize, const cpu_set_t *mask) {
+    flags32_t   online  = 0;
+    flags32_t   cpu_set = 0;
+    thread_t    *thread = NULL;
+
+    if (mask == NULL || setsize < sizeof (flags32_t))
+        return -EINVAL;
+
+    for (int id = 0; id < MAXNCPU; ++id) {
+        if (sched_cpu_usable(cpus[id], (flags32_t)-1))
+            online |= BS(id);
+    }
+
+    if ((cpu_set = (flags32_t)mask->__bits[0] & online) == 0)
+        return -EINVAL;
+
+    if ((thread = sched_lookup(tid)) == NULL)
+        return -ESRCH;
+
+    thread->t_sched.ts_affinity.cpu_set = cpu_set;
+    thread->t_sched.ts_affinity.type    =
+        cpu_set == online ? SOFT_AFFINITY : HARD_AFFINITY;
+
+    /**
+     * A thread already sitting on a run-queue runs there once more,
+     * it moves to an allowed CPU the next time it is parked.
+     * The calling thread gets off this CPU right away if it is no longer allowed on it.
+     */
+    if (thread == current && !BTEST(cpu_set, getcpuid())) {
+        sched_lookup_done(thread);
+        sched_yield();
+        return 0;
+    }
+
+    sched_lookup_done(thread);
+    return 0;
+}
+
+int sched_getaffinity(tid_t tid, size_t setsize, cpu_set_t *mask) {
+    thread_t    *thread = NULL;
+
+    if (mask == NULL || setsize < sizeof (flags32_t))
+        return -EINVAL;
+
+    if ((thread = sched_lookup(tid)) == NULL)
+        return -ESRCH;
+
+    memset(mask, 0, MIN(setsize, sizeof *mask));
+    mask->__bits[0] = sched_allowed(&thread->t_sched);
+    sched_lookup_done(thread);
+
+    // soft affinity is reported as every CPU that runs the scheduler.
+    for (int id = 0; id < MAXNCPU; ++id) {
+        if (!sched_cpu_usable(cpus[id], (flags32_t)-1))
+            mask->__bits[0] &= ~BS(id);
     }
-    return thread;
+    return 0;
+}
+
+long sched_urgency(int policy, long priority) {
+    long key = (long)(SCHED_NRANKS - sched_rank(policy)) << 16;
+
+    switch (policy) {
+    case SCHED_RR:
+        __fallthrough;
+    case SCHED_FIFO:
+        return key + priority;
+    case SCHED_MLFQ:
+        return key + (SCHED_LOWEST_PRIORITY - priority);
+    default:
+        return key;
+    }
+}
+
+// is 'q' one of the run-queues of 'rq'?
+static int sched_isrunqueue(sched_queue_t *rq, queue_t *q) {
+    for (int i = 0; i < NLEVELS; ++i) {
+        if (rq->level[i].queue == q)
+            return 1;
+    }
+
+    for (int i = 0; i < SCHED_RT_NPRIO; ++i) {
+        if (rq->rt[i] == q)
+            return 1;
+    }
+    return rq->fair == q;
+}
+
+/**
+ * @brief move a queued thread to the run-queue matching its scheduling attributes.
+ * The run-queue is only tried, sched_next() locks it before the thread,
+ * a thread left in place moves the next time it is parked.
+ */
+static void sched_requeue(thread_t *thread) {
+    int     err     = 0;
+    queue_t *queue  = NULL;
+    cpu_t   *proc   = thread->t_sched.ts_processor;
+
+    if (proc == NULL || !thread_isstate(thread, T_READY))
+        return;
+
+    queue_lock(&thread->t_queues);
+    forlinked(node, thread->t_queues.head, node->next) {
+        if (sched_isrunqueue(&proc->queueq, node->data)) {
+            queue = node->data;
+            break;
+        }
+    }
+    queue_unlock(&thread->t_queues);
+
+    if (queue == NULL || !spin_trylock(&queue->q_lock))
+        return;
+
+    err = thread_remove_queue(thread, queue);
+    queue_unlock(queue);
+
+    if (err == 0 && (err = sched_park(thread)))
+        panic("failed to requeue thread[%d], err=%d\n", thread_gettid(thread), err);
+}
+
+int sched_pi_inherit(thread_t *thread, int policy, long priority) {
+    int             boost   = 0;
+    int             own_pol = 0;
+    long            own_pri = 0;
+    thread_sched_t  *tsched = NULL;
+
+    thread_assert_locked(thread);
+    tsched  = &thread->t_sched;
+    own_pol = tsched->ts_pi_boosted ? tsched->ts_pi_policy   : tsched->ts_policy;
+    own_pri = tsched->ts_pi_boosted ? tsched->ts_pi_priority : (long)tsched->ts_priority;
+
+    boost = policy >= 0 && sched_urgency(policy, priority) > sched_urgency(own_pol, own_pri);
+    if (!boost) {
+        policy   = own_pol;
+        priority = own_pri;
+    }
+
+    if (boost == tsched->ts_pi_boosted &&
+        policy == tsched->ts_policy && priority == (long)tsched->ts_priority)
+        return 0;
+
+    if (boost && !tsched->ts_pi_boosted) {
+        tsched->ts_pi_policy    = own_pol;
+        tsched->ts_pi_priority  = own_pri;
+    }
+
+    tsched->ts_pi_boosted   = boost;
+    tsched->ts_policy       = policy;
+    tsched->ts_priority     = priority;
+
+    sched_requeue(thread);
+    return 1;
 }
 
 static void sched_self_destruct(void) {
@@ -176,7 +639,9 @@ static void sched_self_destruct(void) {
 __noreturn void schedule(void) {
     int             err     = 0;
     uintptr_t       pdbr    = 0;
-    jiffies_t       before  = 0;
+    u64             start   = 0;
+    u64             ran     = 0;
+    sched_t         *class  = NULL;
     mmap_t          *mmap   = NULL;
     arch_thread_t   *arch   = NULL;
     thread_t        *thread = NULL;
@@ -190,6 +655,9 @@ __noreturn void schedule(void) {
         );
     }
 
+    // other CPUs may now park threads on this one.
+    atomic_fetch_or(&cpu->flags, CPU_SCHED);
+
     loop() {
         cpu->ncli   = 0;
         cpu->intena = 0;
@@ -197,11 +665,21 @@ __noreturn void schedule(void) {
 
         sti(); // start hardware interrupts here
 
+        // no thread is running here, so this CPU is in a quiescent state.
+        rcu_process();
+
         if (NULL == (thread = sched_next())) {
             /// TODO: make cpu core enter an idle state,
             /// to reduce queue contentions in sched_next().
             /// instead of hlt() and cpu_pause().
-            hlt();
+            cli();
+            // stop the tick unless this CPU is servicing timer events.
+            tick_program();
+            if (sched_nready(cpu) == 0) {
+                start = sched_clock();
+                sti_hlt();
+                cpu->sched_stat.ss_idle_sum += sched_clock() - start;
+            }
             cpu_pause();
             continue;
         }
@@ -245,8 +723,14 @@ __noreturn void schedule(void) {
         arch    = &current->t_arch;
         tsched  = &current->t_sched;
 
-        // get the current time of scheduling.
-        tsched->ts_last_sched = jiffies_TO_s(before = jiffies_get());
+        start = sched_clock();
+        sched_stat_switchin(start);
+        tsched->ts_last_sched = start;
+        vdso_switch(curproc ? curproc->pid : 0, current->t_tid);
+
+        // arm the timeslice, the tick is only kept if other threads are waiting.
+        tick_start_slice(tsched->ts_timeslice);
+        tick_program();
 
         if (mmap) {
             mmap_lock(mmap);
@@ -288,8 +772,14 @@ __noreturn void schedule(void) {
         // a lock on itself.
         current_assert_locked();
     
-        // get the time thread returned execution to the scheduler.
-        tsched->ts_cpu_time += jiffies_TO_s(jiffies_get() - before);
+        ran = sched_clock() - start;
+        sched_stat_switchout(ran);
+        tsched->ts_cpu_time  += ran;
+        tsched->ts_last_sched = 0;
+
+        // let the thread's class account for the time it ran.
+        if ((class = sched_class(tsched->ts_policy)) && class->s_put)
+            class->s_put(&ready_queue, current, ran);
         
         pushcli();
         if (current_iskilled()) {
@@ -0,0 +1,78 @@
+#include <bits/errno.h>
+#include <ds/queue.h>
+#include <ginger/jiffies.h>
+#include <lib/printk.h>
+#include <sys/sched.h>
+#include <sys/thread.h>
+
+/**
+ * SCHED_FAIR picks the queued thread that has had the least CPU time
+ * (virtual runtime). A thread that slept for long is placed slightly
+ * behind the run-queue's floor so it runs soon, without being able to
+ * monopolize the CPU with the credit it built up while asleep.
+ */
+
+#define SCHED_FAIR_QUANTUM      (ms_TO_jiffies(20))
+#define SCHED_FAIR_SLEEP_CREDIT ((u64)jiffies_TO_ns(SCHED_FAIR_QUANTUM))
+
+static int fair_init(sched_queue_t *rq) {
+    rq->min_vruntime = 0;
+    return queue_alloc(&rq->fair);
+}
+
+static int fair_park(sched_queue_t *rq, thread_t *thread) {
+    u64 floor = atomic_read(&rq->min_vruntime);
+    
+    floor = floor > SCHED_FAIR_SLEEP_CREDIT ? floor - SCHED_FAIR_SLEEP_CREDIT : 0;
+    if (thread->t_sched.ts_vruntime < floor)
+        thread->t_sched.ts_vruntime = floor;
+
+    return thread_enqueue(rq->fair, thread, NULL);
+}
+
+static thread_t *fair_next(sched_queue_t *rq) {
+    thread_t *thread = NULL;
+
+    if (atomic_read(&rq->fair->q_count) == 0)
+        return NULL;
+
+    queue_lock(rq->fair);
+    queue_foreach(thread_t *, t, rq->fair) {
+        if (thread == NULL || t->t_sched.ts_vruntime < thread->t_sched.ts_vruntime)
+            thread = t;
+    }
+
+    if (thread) {
+        thread_lock(thread);
+        if (thread_remove_queue(thread, rq->fair)) {
+            thread_unlock(thread);
+            thread = NULL;
+        } else {
+            if (thread->t_sched.ts_vruntime > rq->min_vruntime)
+                atomic_write(&rq->min_vruntime, thread->t_sched.ts_vruntime);
+            thread->t_sched.ts_timeslice = SCHED_FAIR_QUANTUM;
+        }
+    }
+    queue_unlock(rq->fair);
+
+    return thread;
+}
+
+static size_t fair_nready(sched_queue_t *rq) {
+    return rq->fair ? atomic_read(&rq->fair->q_count) : 0;
+}
+
+static void fair_put(sched_queue_t *rq __unused, thread_t *thread, u64 ran) {
+    thread->t_sched.ts_vruntime += ran;
+}
+
+sched_t sched_fair = {
+    .s_name     = "fair",
+    .s_type     = SCHED_FAIR,
+    .s_rank     = SCHED_RANK_NORMAL,
+    .s_init     = fair_init,
+    .s_park     = fair_park,
+    .s_next     = fair_next,
+    .s_nready   = fair_nready,
+    .s_put      = fair_put,
+};
@@ -0,0 +1,204 @@
+#include <bits/errno.h>
+#include <ds/queue.h>
+#include <ginger/jiffies.h>
+#include <lib/printk.h>
+#include <sync/spinlock.h>
+#include <sys/sched.h>
+#include <sys/sysprot.h>
+#include <sys/thread.h>
+
+/**
+ * Multi-level feedback queue.
+ * - A thread that runs for its whole quantum drops a level,
+ *   lower levels have longer quanta.
+ * - A thread that blocks before using half of its quantum
+ *   climbs back a level, up to its base priority.
+ * - Every mlfq_boost_interval all threads go back to their base priority,
+ *   so CPU hogs that sank to the bottom are not starved for ever.
+ */
+
+static SPINLOCK(mlfq_lock);
+static struct sched_tunables mlfq_tunables = {
+    .mlfq_quantum           = 20,
+    .mlfq_quantum_step      = 20,
+    .mlfq_boost_interval    = 1000,
+};
+
+// jiffy of the last global boost.
+static jiffies_t mlfq_boost = 0;
+
+#define mlfq_get(knob)  ({ atomic_read(&mlfq_tunables.knob); })
+
+static long mlfq_quantum(int level) {
+    return ms_TO_jiffies(mlfq_get(mlfq_quantum) + level * mlfq_get(mlfq_quantum_step));
+}
+
+// start a new boost period if the current one has elapsed.
+static jiffies_t mlfq_boost_update(void) {
+    jiffies_t   now     = jiffies_get();
+    jiffies_t   last    = atomic_read(&mlfq_boost);
+    long        period  = mlfq_get(mlfq_boost_interval);
+
+    if (period > 0 && time_after_eq(now, last + (jiffies_t)ms_TO_jiffies(period))) {
+        if (atomic_cmpxchg(&mlfq_boost, last, now))
+            return now;
+    }
+    return atomic_read(&mlfq_boost);
+}
+
+// bring a thread that missed a boost back to its base priority.
+static void mlfq_boost_thread(thread_t *thread, jiffies_t boost) {
+    thread_sched_t *tsched = &thread->t_sched;
+
+    // an inherited priority is only dropped by the mutex holder.
+    if (tsched->ts_boost == boost || tsched->ts_pi_boosted)
+        return;
+    tsched->ts_boost    = boost;
+    tsched->ts_priority = tsched->ts_base_priority;
+}
+
+static int mlfq_init(sched_queue_t *rq) {
+    int err = 0;
+
+    for (size_t i = 0; i < NELEM(rq->level); ++i) {
+        if ((err = queue_alloc(&rq->level[i].queue)))
+            return err;
+        rq->level[i].quatum = mlfq_quantum(i);
+    }
+
+    rq->mlfq_boost = atomic_read(&mlfq_boost);
+    return 0;
+}
+
+static int mlfq_park(sched_queue_t *rq, thread_t *thread) {
+    level_t *lvl = NULL;
+
+    mlfq_boost_thread(thread, atomic_read(&mlfq_boost));
+    lvl = &rq->level[SCHED_LEVEL(thread->t_sched.ts_priority)];
+    return thread_enqueue(lvl->queue, thread, NULL);
+}
+
+// move every thread below the top of 'rq' back to its base level.
+static void mlfq_boost_queue(sched_queue_t *rq, jiffies_t boost) {
+    size_t   count   = 0;
+    queue_t  *queue  = NULL;
+    thread_t *thread = NULL;
+
+    for (int i = 1; i < NLEVELS; ++i) {
+        queue = rq->level[i].queue;
+        count = atomic_read(&queue->q_count);
+
+        while (count--) {
+            queue_lock(queue);
+            thread = thread_dequeue(queue);
+            queue_unlock(queue);
+
+            if (thread == NULL)
+                break;
+
+            mlfq_boost_thread(thread, boost);
+            thread_enqueue(rq->level[SCHED_LEVEL(thread->t_sched.ts_priority)].queue, thread, NULL);
+            thread_unlock(thread);
+        }
+    }
+}
+
+static thread_t *mlfq_next(sched_queue_t *rq) {
+    level_t   *lvl    = NULL;
+    thread_t  *thread = NULL;
+    jiffies_t boost   = mlfq_boost_update();
+
+    if (rq->mlfq_boost != boost) {
+        rq->mlfq_boost = boost;
+        mlfq_boost_queue(rq, boost);
+    }
+
+    for (int i = 0; i < NLEVELS; ++i) {
+        lvl = &rq->level[i];
+        queue_lock(lvl->queue);
+        thread = thread_dequeue(lvl->queue);
+        queue_unlock(lvl->queue);
+
+        if (thread == NULL)
+            continue;
+        
+        lvl->quatum = mlfq_quantum(i);
+        thread->t_sched.ts_timeslice = lvl->quatum;
+        break;
+    }
+    return thread;
+}
+
+static size_t mlfq_nready(sched_queue_t *rq) {
+    size_t nready = 0;
+
+    for (int i = 0; i < NLEVELS; ++i) {
+        if (rq->level[i].queue)
+            nready += atomic_read(&rq->level[i].queue->q_count);
+    }
+    return nready;
+}
+
+static void mlfq_put(sched_queue_t *rq __unused, thread_t *thread, u64 ran) {
+    thread_sched_t  *tsched  = &thread->t_sched;
+    long            prio     = tsched->ts_priority;
+    u64             quantum  = jiffies_TO_ns(mlfq_quantum(SCHED_LEVEL(prio)));
+
+    if (tsched->ts_pi_boosted)
+        return;
+
+    if (ran >= quantum) {
+        // used up the whole quantum, drop a level.
+        prio = MIN(prio + SCHED_LEVEL_WIDTH, SCHED_LOWEST_PRIORITY);
+    } else if (!thread_isstate(thread, T_READY) && ran < quantum / 2) {
+        // blocked early, climb back a level.
+        prio = MAX(prio - SCHED_LEVEL_WIDTH, (long)tsched->ts_base_priority);
+    }
+
+    tsched->ts_priority = prio;
+}
+
+int sched_gettunables(struct sched_tunables *tunables) {
+    if (tunables == NULL)
+        return -EINVAL;
+
+    spin_lock(mlfq_lock);
+    *tunables = mlfq_tunables;
+    spin_unlock(mlfq_lock);
+    return 0;
+}
+
+int sched_settunables(const struct sched_tunables *tunables) {
+    struct sched_tunables snap = {0};
+
+    if (tunables == NULL)
+        return -EINVAL;
+
+    if (current && current_isuser() && geteuid() != 0)
+        return -EPERM;
+
+    // validate and store one snapshot, '*tunables' may change under us.
+    snap = *tunables;
+    if (snap.mlfq_quantum <= 0 ||
+        snap.mlfq_quantum_step < 0 ||
+        snap.mlfq_boost_interval < 0)
+        return -EINVAL;
+
+    spin_lock(mlfq_lock);
+    atomic_write(&mlfq_tunables.mlfq_quantum, snap.mlfq_quantum);
+    atomic_write(&mlfq_tunables.mlfq_quantum_step, snap.mlfq_quantum_step);
+    atomic_write(&mlfq_tunables.mlfq_boost_interval, snap.mlfq_boost_interval);
+    spin_unlock(mlfq_lock);
+    return 0;
+}
+
+sched_t sched_mlfq = {
+    .s_name     = "mlfq",
+    .s_type     = SCHED_MLFQ,
+    .s_rank     = SCHED_RANK_NORMAL,
+    .s_init     = mlfq_init,
+    .s_park     = mlfq_park,
+    .s_next     = mlfq_next,
+    .s_nready   = mlfq_nready,
+    .s_put      = mlfq_put,
+};
@@ -0,0 +1,84 @@
+#include <bits/errno.h>
+#include <ds/queue.h>
+#include <ginger/jiffies.h>
+#include <ginger/tick.h>
+#include <lib/printk.h>
+#include <lib/limits.h>
+#include <sys/sched.h>
+#include <sys/thread.h>
+
+/**
+ * SCHED_FIFO and SCHED_RR share one class with a queue per priority.
+ * SCHED_RR threads get a quantum and go to the back of their queue when
+ * it runs out, SCHED_FIFO threads run until they block, yield or are
+ * preempted by a more urgent thread.
+ */
+
+#define SCHED_RR_QUANTUM    (ms_TO_jiffies(100))
+#define SCHED_FIFO_QUANTUM  TICK_SLICE_INFINITE
+
+#define rt_prio(thread) ({                               \
+    long __prio = (thread)->t_sched.ts_priority;         \
+    __prio < SCHED_RT_MINPRIO ? SCHED_RT_MINPRIO :       \
+    __prio > SCHED_RT_MAXPRIO ? SCHED_RT_MAXPRIO : __prio; \
+})
+
+static int rt_init(sched_queue_t *rq) {
+    int err = 0;
+
+    for (size_t i = 0; i < NELEM(rq->rt); ++i) {
+        if ((err = queue_alloc(&rq->rt[i])))
+            return err;
+    }
+
+    return 0;
+}
+
+static int rt_park(sched_queue_t *rq, thread_t *thread) {
+    return thread_enqueue(rq->rt[rt_prio(thread)], thread, NULL);
+}
+
+static thread_t *rt_next(sched_queue_t *rq) {
+    queue_t  *queue  = NULL;
+    thread_t *thread = NULL;
+
+    for (int prio = SCHED_RT_MAXPRIO; prio >= SCHED_RT_MINPRIO; --prio) {
+        queue = rq->rt[prio];
+        if (atomic_read(&queue->q_count) == 0)
+            continue;
+
+        queue_lock(queue);
+        thread = thread_dequeue(queue);
+        queue_unlock(queue);
+
+        if (thread == NULL)
+            continue;
+
+        thread->t_sched.ts_timeslice =
+            thread->t_sched.ts_policy == SCHED_FIFO ?
+            SCHED_FIFO_QUANTUM : SCHED_RR_QUANTUM;
+        break;
+    }
+    return thread;
+}
+
+static size_t rt_nready(sched_queue_t *rq) {
+    size_t nready = 0;
+
+    for (size_t i = 0; i < NELEM(rq->rt); ++i) {
+        if (rq->rt[i])
+            nready += atomic_read(&rq->rt[i]->q_count);
+    }
+    return nready;
+}
+
+sched_t sched_rt = {
+    .s_name     = "rt",
+    .s_type     = SCHED_FIFO,
+    .s_rank     = SCHED_RANK_RT,
+    .s_init     = rt_init,
+    .s_park     = rt_park,
+    .s_next     = rt_next,
+    .s_nready   = rt_nready,
+    .s_put      = NULL,
+};
@@ -2,13 +2,12 @@
 #include <arch/signal.h>
 #include <arch/thread.h>
 #include <bits/errno.h>
-#include <dev/clocks.h>
+#include <ginger/ktimer.h>
 #include <mm/kalloc.h>
 #include <sys/proc.h>
 #include <sys/_signal.h>
 #include <sys/sysproc.h>
 #include <sys/thread.h>
-#include <ds/btree.h>
 
 int raise(int signo) {
     return pthread_kill(thread_gettid(current), signo);
@@ -26,39 +25,25 @@ int pause(void) {
     return -EINTR;
 }
 
-void trigger_alarm(pid_t pid) {
-    kill(pid, SIGALRM);
+void trigger_alarm(ktimer_t *tm) {
+    kill((pid_t)(long)tm->tm_arg, SIGALRM);
 }
 
 unsigned long alarm(unsigned sec) {
-    timeval_t       tv    = {0};
-    clockid_t       clkid = 0;
-    static btree_t alarms = {0};
-
-    tv.tv_sec   = sec;
-    tv.tv_usec  = 0;
+    unsigned long   remaining   = 0;
+    jiffies_t       now         = jiffies_get();
+    ktimer_t        *tm         = NULL;
 
     proc_lock(curproc);
-    if (sec == 0) { // disarm previous alarm.
-        btree_lock(&alarms);
-        btree_search(&alarms, curproc->pid, (void **)&clkid);
-        btree_unlock(&alarms);
-        proc_unlock(curproc);
-        return 0;
-    }
+    tm = &curproc->p_alarm;
 
-    assert(
-        clock_set(&tv,
-        (void *)trigger_alarm,
-        (void *)(long)curproc->pid,
-        CLK_ARMED, &clkid
-    ) == 0, "Failed to set alarm\n");
-    
-    btree_lock(&alarms);
-    btree_insert(&alarms, curproc->pid, (void *)clkid);
-    btree_unlock(&alarms);
+    // a new alarm replaces the previous one, report what was left of it.
+    if (ktimer_del(tm) && time_after(tm->tm_expires, now))
+        remaining = (tm->tm_expires - now + SYS_HZ - 1) / SYS_HZ;
 
+    if (sec)
+        ktimer_add(tm, now + (jiffies_t)sec * SYS_HZ);
     proc_unlock(curproc);
 
-    return 0;
-}
\ No newline at end of file
+    return remaining;
+}
@@ -0,0 +1,288 @@
+#include <arch/cpu.h>
+#include <bits/errno.h>
+#include <ginger/hrtimer.h>
+#include <ginger/jiffies.h>
+#include <lib/string.h>
+#include <mm/kalloc.h>
+#include <sys/proc.h>
+#include <sys/_signal.h>
+#include <sys/_time.h>
+#include <sys/sysproc.h>
+#include <sys/thread.h>
+
+// timers a process may have at once.
+#define TIMER_MAX   32
+
+/**
+ * A timer created by timer_create().
+ * pt_lock serializes timer_settime() with the expiry function rearming
+ * a periodic timer, the list of timers is protected by the process lock.
+ */
+typedef struct posix_timer {
+    hrtimer_t           pt_timer;
+    spinlock_t          pt_lock;
+    timer_t             pt_id;
+    pid_t               pt_pid;         // process signaled on expiry.
+    int                 pt_signo;       // 0 for SIGEV_NONE.
+    clockid_t           pt_clock;
+    int                 pt_armed;       // set by timer_settime(), cleared once a one-shot timer expired.
+    u64                 pt_interval;    // period in ns, 0 for one-shot timers.
+    int                 pt_overrun;     // periods missed before the last expiry.
+    struct posix_timer  *pt_next;
+} posix_timer_t;
+
+static void timer_expire(hrtimer_t *ht) {
+    u64             now     = 0;
+    u64             missed  = 0;
+    u64             expires = 0;
+    int             signo   = 0;
+    posix_timer_t   *pt     = ht->ht_arg;
+
+    spin_lock(&pt->pt_lock);
+    // timer_settime() rearmed or disarmed it while we were on our way here.
+    if (!pt->pt_armed || hrtimer_pending(ht)) {
+        spin_unlock(&pt->pt_lock);
+        return;
+    }
+
+    signo = pt->pt_signo;
+    if (pt->pt_interval == 0)
+        pt->pt_armed = 0;
+    else {
+        // skip the periods we were too late for, and count them.
+        now     = hrtimer_now();
+        expires = ht->ht_expires + pt->pt_interval;
+        if (expires <= now) {
+            missed   = (now - expires) / pt->pt_interval + 1;
+            expires += missed * pt->pt_interval;
+        }
+        pt->pt_overrun = MIN(missed, (u64)__INT_MAX__);
+        hrtimer_add(ht, expires);
+    }
+    spin_unlock(&pt->pt_lock);
+
+    // timer_delete() waits for us, so 'pt' outlives the signal.
+    if (signo)
+        kill(pt->pt_pid, signo);
+}
+
+static posix_timer_t *timer_lookup(proc_t *proc, timer_t timerid) {
+    proc_assert_locked(proc);
+
+    for (posix_timer_t *pt = proc->p_timers; pt; pt = pt->pt_next) {
+        if (pt->pt_id == timerid)
+            return pt;
+    }
+    return NULL;
+}
+
+// fill 'value' with the time left on 'pt', locked.
+static void timer_getvalue(posix_timer_t *pt, struct itimerspec *value) {
+    u64 now     = hrtimer_now();
+    u64 left    = 0;
+
+    if (hrtimer_pending(&pt->pt_timer) && pt->pt_timer.ht_expires > now)
+        left = pt->pt_timer.ht_expires - now;
+    // one that is due but hasn't run yet is reported as about to expire.
+    else if (pt->pt_armed)
+        left = 1;
+
+    NS_TO_TIMESPEC(pt->pt_interval, &value->it_interval);
+    NS_TO_TIMESPEC(left, &value->it_value);
+}
+
+int timer_create(clockid_t clock_id, struct sigevent *restrict sevp, timer_t *restrict timerid) {
+    int             err     = 0;
+    int             ntimers = 0;
+    u64             offset  = 0;
+    posix_timer_t   *pt     = NULL;
+
+    if (timerid == NULL)
+        return -EFAULT;
+
+    if ((err = hrtimer_clock_offset(clock_id, &offset)))
+        return err;
+
+    if (sevp) {
+        switch (sevp->sigev_notify) {
+        case SIGEV_NONE:
+            break;
+        case SIGEV_SIGNAL:
+            if (SIGBAD(sevp->sigev_signo))
+                return -EINVAL;
+            break;
+        default:
+            return -EINVAL;
+        }
+    }
+
+    if (NULL == (pt = kmalloc(sizeof *pt)))
+        return -ENOMEM;
+
+    memset(pt, 0, sizeof *pt);
+    pt->pt_timer = HRTIMER_INIT(timer_expire, pt);
+    pt->pt_lock  = SPINLOCK_INIT();
+    pt->pt_clock = clock_id;
+    // without a sigevent, SIGALRM is sent.
+    pt->pt_signo = sevp == NULL ? SIGALRM :
+        sevp->sigev_notify == SIGEV_SIGNAL ? sevp->sigev_signo : 0;
+
+    proc_lock(curproc);
+    for (posix_timer_t *tmp = curproc->p_timers; tmp; tmp = tmp->pt_next)
+        ntimers++;
+
+    if (ntimers >= TIMER_MAX) {
+        err = -EAGAIN;
+        proc_unlock(curproc);
+        goto error;
+    }
+
+    pt->pt_pid          = curproc->pid;
+    pt->pt_id           = ++curproc->p_timerid;
+    pt->pt_next         = curproc->p_timers;
+    curproc->p_timers   = pt;
+    *timerid            = pt->pt_id;
+    proc_unlock(curproc);
+
+    return 0;
+error:
+    kfree(pt);
+    return err;
+}
+
+int timer_settime(timer_t timerid, int flags, const struct itimerspec *restrict value, struct itimerspec *restrict ovalue) {
+    int             err     = 0;
+    u64             now     = 0;
+    u64             offset  = 0;
+    u64             expires = 0;
+    posix_timer_t   *pt     = NULL;
+
+    if (value == NULL)
+        return -EFAULT;
+
+    if (value->it_value.tv_sec < 0 || value->it_value.tv_nsec < 0 ||
+        value->it_value.tv_nsec >= NSEC_PER_SEC || value->it_interval.tv_sec < 0 ||
+        value->it_interval.tv_nsec < 0 || value->it_interval.tv_nsec >= NSEC_PER_SEC)
+        return -EINVAL;
+
+    proc_lock(curproc);
+    if (NULL == (pt = timer_lookup(curproc, timerid))) {
+        proc_unlock(curproc);
+        return -EINVAL;
+    }
+
+    if ((err = hrtimer_clock_offset(pt->pt_clock, &offset))) {
+        proc_unlock(curproc);
+        return err;
+    }
+
+    spin_lock(&pt->pt_lock);
+    if (ovalue)
+        timer_getvalue(pt, ovalue);
+
+    hrtimer_del(&pt->pt_timer);
+    pt->pt_armed    = 0;
+    pt->pt_overrun  = 0;
+    pt->pt_interval = TIMESPEC_TO_NS(&value->it_interval);
+
+    if ((expires = TIMESPEC_TO_NS(&value->it_value))) {
+        now = hrtimer_now();
+        if (flags & TIMER_ABSTIME)
+            // a time already past expires right away.
+            expires = expires > offset ? expires - offset : now;
+        else
+            expires += now;
+
+        pt->pt_armed = 1;
+        hrtimer_add(&pt->pt_timer, expires);
+    }
+    spin_unlock(&pt->pt_lock);
+    proc_unlock(curproc);
+
+    return 0;
+}
+
+int timer_gettime(timer_t timerid, struct itimerspec *value) {
+    posix_timer_t *pt = NULL;
+
+    if (value == NULL)
+        return -EFAULT;
+
+    proc_lock(curproc);
+    if (NULL == (pt = timer_lookup(curproc, timerid))) {
+        proc_unlock(curproc);
+        return -EINVAL;
+    }
+
+    spin_lock(&pt->pt_lock);
+    timer_getvalue(pt, value);
+    spin_unlock(&pt->pt_lock);
+    proc_unlock(curproc);
+
+    return 0;
+}
+
+int timer_getoverrun(timer_t timerid) {
+    int             overrun = 0;
+    posix_timer_t   *pt     = NULL;
+
+    proc_lock(curproc);
+    if (NULL == (pt = timer_lookup(curproc, timerid))) {
+        proc_unlock(curproc);
+        return -EINVAL;
+    }
+
+    overrun = atomic_read(&pt->pt_overrun);
+    proc_unlock(curproc);
+
+    return overrun;
+}
+
+// disarm and free 'pt', already unlinked from its process.
+static void timer_free(posix_timer_t *pt) {
+    spin_lock(&pt->pt_lock);
+    pt->pt_armed = 0;
+    spin_unlock(&pt->pt_lock);
+
+    // timer_expire() won't rearm it anymore, wait for a running one to return.
+    hrtimer_del_sync(&pt->pt_timer);
+    kfree(pt);
+}
+
+int timer_delete(timer_t timerid) {
+    posix_timer_t *pt   = NULL;
+    posix_timer_t **ppt = NULL;
+
+    proc_lock(curproc);
+    for (ppt = &curproc->p_timers; (pt = *ppt); ppt = &pt->pt_next) {
+        if (pt->pt_id == timerid)
+            break;
+    }
+
+    if (pt == NULL) {
+        proc_unlock(curproc);
+        return -EINVAL;
+    }
+
+    *ppt = pt->pt_next;
+    proc_unlock(curproc);
+
+    // timer_expire() takes the process lock to signal it.
+    timer_free(pt);
+    return 0;
+}
+
+void timer_delete_all(proc_t *proc) {
+    posix_timer_t *pt   = NULL;
+    posix_timer_t *next = NULL;
+
+    proc_lock(proc);
+    pt = proc->p_timers;
+    proc->p_timers = NULL;
+    proc_unlock(proc);
+
+    for (; pt; pt = next) {
+        next = pt->pt_next;
+        timer_free(pt);
+    }
+}
@@ -5,6 +5,16 @@
 #include <sys/sched.h>
 #include <ds/queue.h>
 #include <bits/errno.h>
+#include <ginger/hrtimer.h>
+#include <sys/_time.h>
+
+// a thread in clock_nanosleep(), woken by its own high-resolution timer.
+typedef struct nanosleeper {
+    hrtimer_t   ns_timer;
+    spinlock_t  ns_lock;
+    int         ns_expired;
+    queue_t     ns_queue;   // sleep queue holding only the sleeping thread.
+} nanosleeper_t;
 
 static queue_t *global_sleep_queue = QUEUE_NEW(/*"Global sleep queue"*/);
 
@@ -18,6 +28,72 @@ long sleep(long s) {
     return s;
 }
 
+static void nanosleep_expired(hrtimer_t *ht) {
+    nanosleeper_t *ns = ht->ht_arg;
+
+    spin_lock(&ns->ns_lock);
+    ns->ns_expired = 1;
+    sched_wake1(&ns->ns_queue);
+    spin_unlock(&ns->ns_lock);
+}
+
+int clock_nanosleep(clockid_t clock_id, int flags, const struct timespec *req, struct timespec *rem) {
+    int             err     = 0;
+    u64             now     = 0;
+    u64             offset  = 0;
+    u64             expires = 0;
+    nanosleeper_t   ns      = {0};
+
+    if (req == NULL)
+        return -EFAULT;
+
+    if (req->tv_sec < 0 || req->tv_nsec < 0 || req->tv_nsec >= NSEC_PER_SEC)
+        return -EINVAL;
+
+    if ((err = hrtimer_clock_offset(clock_id, &offset)))
+        return err;
+
+    now     = hrtimer_now();
+    expires = TIMESPEC_TO_NS(req);
+    if (flags & TIMER_ABSTIME)
+        expires = expires > offset ? expires - offset : 0;
+    else
+        expires += now;
+
+    if (expires <= now)
+        return 0;
+
+    ns.ns_lock  = SPINLOCK_INIT();
+    ns.ns_queue = QUEUE_INIT();
+    ns.ns_timer = HRTIMER_INIT(nanosleep_expired, &ns);
+    hrtimer_add(&ns.ns_timer, expires);
+
+    spin_lock(&ns.ns_lock);
+    if (!ns.ns_expired) {
+        current_lock();
+        err = sched_sleep(&ns.ns_queue, T_ISLEEP, &ns.ns_lock);
+        current_unlock();
+    }
+    spin_unlock(&ns.ns_lock);
+
+    // 'ns' lives on our stack, the timer must be done with it.
+    hrtimer_del_sync(&ns.ns_timer);
+
+    if (ns.ns_expired)
+        return 0;
+
+    // woken early by a signal, report what was left of a relative sleep.
+    if (rem && !(flags & TIMER_ABSTIME)) {
+        now = hrtimer_now();
+        NS_TO_TIMESPEC(expires > now ? expires - now : 0, rem);
+    }
+    return err ? err : -EINTR;
+}
+
+int nanosleep(const struct timespec *req, struct timespec *rem) {
+    return clock_nanosleep(CLOCK_MONOTONIC, 0, req, rem);
+}
+
 int park(void) {
     int err = 0;
 
@@ -1,3 +1,4 @@
+#include <arch/uaccess.h>
 #include <bits/errno.h>
 #include <mm/kalloc.h>
 #include <mm/mmap.h>
@@ -10,35 +11,68 @@ typedef struct {
     char **envp;
 } argvenvp_t;
 
-int copy_argenv(char *__argv[], char *__envp[], argvenvp_t *ppargs) {
-    int     err     = 0;
+// copy the NULL-terminated user string vector 'uv' into a new kernel vector at *'pv'.
+static int copy_strv(char *const uv[], char *buf, char ***pv) {
+    isize   len     = 0;
     usize   cnt     = 0;
+    char    *uarg   = NULL;
     char    **tmpv  = NULL;
-    char    **argp  = NULL;
-    char    **envp  = NULL;
+    char    **v     = NULL;
 
-    if (ppargs == NULL)
-        return -EINVAL;
-
-    foreach(arg, __argv) {
-        if (NULL == (tmpv = (char **)krealloc(argp, (cnt + 2) * sizeof (char **))))
+    // a NULL vector is an empty one.
+    while (uv) {
+        if (copy_from_user(&uarg, &uv[cnt], sizeof uarg)) {
+            len = -EFAULT;
             goto error;
-        argp = tmpv;
-        if (NULL == (argp[cnt] = strdup(arg)))
+        }
+
+        if (uarg == NULL)
+            break;
+
+        if ((len = strncpy_from_user(buf, uarg, PGSZ)) < 0) {
+            len = len == -ENAMETOOLONG ? -E2BIG : len;
             goto error;
-        argp[++cnt] = NULL;
-    }
+        }
 
-    cnt = 0;
-    foreach(env, __envp) {
-        if (NULL == (tmpv = (char **)krealloc(envp, (cnt + 2) * sizeof (char **))))
+        len = -ENOMEM;
+        if (NULL == (tmpv = (char **)krealloc(v, (cnt + 2) * sizeof (char **))))
             goto error;
-        envp = tmpv;
-        if (NULL == (envp[cnt] = strdup(env)))
+        v = tmpv;
+        v[cnt + 1] = NULL;
+        if (NULL == (v[cnt] = strdup(buf)))
             goto error;
-        envp[++cnt] = NULL;
+        ++cnt;
     }
 
+    *pv = v;
+    return 0;
+error:
+    if (v)
+        tokens_free(v);
+    return len;
+}
+
+int copy_argenv(char *__argv[], char *__envp[], argvenvp_t *ppargs) {
+    int     err     = 0;
+    char    *buf    = NULL;
+    char    **argp  = NULL;
+    char    **envp  = NULL;
+
+    if (ppargs == NULL)
+        return -EINVAL;
+
+    // each string is bounced through 'buf' and then duplicated at its length.
+    if (NULL == (buf = kmalloc(PGSZ)))
+        return -ENOMEM;
+
+    if ((err = copy_strv(__argv, buf, &argp)))
+        goto error;
+
+    if ((err = copy_strv(__envp, buf, &envp)))
+        goto error;
+
+    kfree(buf);
+
     *ppargs = (argvenvp_t) {
         .argv = argp,
         .envp = envp
@@ -46,12 +80,10 @@ int copy_argenv(char *__argv[], char *__envp[], argvenvp_t *ppargs) {
 
     return 0;
 error:
+    kfree(buf);
     if (argp)
         tokens_free(argp);
-    if (envp)
-        tokens_free(envp);
-    printk("%s:%d: failed to copy argv[] and envp[], err = %d\n", __FILE__, __LINE__, err);
-    return -ENOMEM;
+    return err;
 }
 
 int execve(const char *pathname, char *const argv[], char *const envp[]) {
@@ -77,10 +109,8 @@ int execve(const char *pathname, char *const argv[], char *const envp[]) {
         return err;
 
     // copy the filename of the new process image.
-    if (NULL == (binary = strdup(pathname))) {
-        err = -ENOMEM;
+    if ((err = strndup_user(pathname, PGSZ, &binary)))
         goto error;
-    }
 
     /**
      * copy argv and envp
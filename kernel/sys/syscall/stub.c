@@ -1,6 +1,9 @@
+#include <arch/traps.h>
+#include <arch/tsc.h>
 #include <bits/errno.h>
 #include <lib/printk.h>
 #include <sys/syscall.h>
+#include <sys/systrace.h>
 #include <arch/x86_64/context.h>
 
 size_t (*syscall[])() = {
@@ -75,6 +78,33 @@ size_t (*syscall[])() = {
     [SYS_UNMAP]             = (void *)sys_munmap,
     [SYS_MPROTECT]          = (void *)sys_mprotect,
     [SYS_THREAD_YIELD]      = (void *)sys_thread_yield,
+    [SYS_SCHED_SETSCHEDULER]= (void *)sys_sched_setscheduler,
+    [SYS_SCHED_GETSCHEDULER]= (void *)sys_sched_getscheduler,
+    [SYS_SCHED_GETTUNABLES] = (void *)sys_sched_gettunables,
+    [SYS_SCHED_SETTUNABLES] = (void *)sys_sched_settunables,
+    [SYS_SCHED_SETAFFINITY] = (void *)sys_sched_setaffinity,
+    [SYS_SCHED_GETAFFINITY] = (void *)sys_sched_getaffinity,
+    [SYS_FUTEX]             = (void *)sys_futex,
+    [SYS_NANOSLEEP]         = (void *)sys_nanosleep,
+    [SYS_CLOCK_NANOSLEEP]   = (void *)sys_clock_nanosleep,
+    [SYS_TIMER_CREATE]      = (void *)sys_timer_create,
+    [SYS_TIMER_SETTIME]     = (void *)sys_timer_settime,
+    [SYS_TIMER_GETTIME]     = (void *)sys_timer_gettime,
+    [SYS_TIMER_GETOVERRUN]  = (void *)sys_timer_getoverrun,
+    [SYS_TIMER_DELETE]      = (void *)sys_timer_delete,
+    [SYS_CLOCK_GETTIME]     = (void *)sys_clock_gettime,
+    [SYS_CLOCK_GETRES]      = (void *)sys_clock_getres,
+    [SYS_CLOCK_SETTIME]     = (void *)sys_clock_settime,
+    [SYS_URING_SETUP]       = (void *)sys_uring_setup,
+    [SYS_URING_ENTER]       = (void *)sys_uring_enter,
+    [SYS_READV]             = (void *)sys_readv,
+    [SYS_WRITEV]            = (void *)sys_writev,
+    [SYS_PREAD]             = (void *)sys_pread,
+    [SYS_PWRITE]            = (void *)sys_pwrite,
+    [SYS_PREADV]            = (void *)sys_preadv,
+    [SYS_PWRITEV]           = (void *)sys_pwritev,
+    [SYS_SENDFILE]          = (void *)sys_sendfile,
+    [SYS_SPLICE]            = (void *)sys_splice,
     [SYS_GETPAGESIZE]       = (void *)sys_getpagesize,
     [SYS_GETMEMUSAGE]       = (void *)sys_getmemusage,
 
@@ -103,23 +133,27 @@ static int sys_syscall_ni(ucontext_t *uctx) {
 }
 
 void do_syscall(ucontext_t *uctx) {
-    mcontext_t  *mctx = &uctx->uc_mcontext;
+    u64         entry   = tsc_read();
+    usize       nr      = 0;
+    mcontext_t  *mctx   = &uctx->uc_mcontext;
+    u64         args[SYSTRACE_NARGS];
 
     if (uctx == NULL)
         return;
 
-    if (mctx->rax >= NELEM(syscall))
-        mctx->rax = sys_syscall_ni(uctx);
-    else if ((long)mctx->rax < 0 || !syscall[mctx->rax])
+    nr      = mctx->rax;
+    args[0] = mctx->rdi;
+    args[1] = mctx->rsi;
+    args[2] = mctx->rdx;
+    // SYSCALL keeps the return address in rcx.
+    args[3] = mctx->trapno == T_SYSCALL ? mctx->r10 : mctx->rcx;
+    args[4] = mctx->r8;
+    args[5] = mctx->r9;
+
+    if (nr >= NELEM(syscall) || !syscall[nr])
         mctx->rax = sys_syscall_ni(uctx);
-    else {
-        mctx->rax = (syscall[mctx->rax])(
-            mctx->rdi,
-            mctx->rsi,
-            mctx->rdx,
-            mctx->rcx,
-            mctx->r8,
-            mctx->r9
-        );
-    }
+    else
+        mctx->rax = (syscall[nr])(args[0], args[1], args[2], args[3], args[4], args[5]);
+
+    systrace_syscall(nr, args, mctx->rax, entry);
 }
\ No newline at end of file
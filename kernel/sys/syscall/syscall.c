@@ -1,3 +1,4 @@
+#include <arch/uaccess.h>
 #include <bits/errno.h>
 #include <lib/printk.h>
 #include <sys/syscall.h>
@@ -5,6 +6,7 @@
 #include <fs/file.h>
 #include <arch/x86_64/context.h>
 #include <sys/sleep.h>
+#include <sys/futex.h>
 #include <sys/_signal.h>
 #include <sys/mman/mman.h>
 #include <sys/sysprot.h>
@@ -27,6 +29,135 @@ ssize_t  sys_write(int fd, void *buf, size_t sz) {
     return write(fd, buf, sz);
 }
 
+/**
+ * @brief copy the I/O vector 'uiov' into a new kernel array at *'piov',
+ * so its entries are read once and can't change under the transfer.
+ * @return int 0 on success, -EINVAL for a bad count or total length,
+ * -EFAULT for a bad vector or buffer.
+ */
+static int iov_import(const struct iovec *uiov, int iovcnt, struct iovec **piov) {
+    int             err = 0;
+    struct iovec    *iov= NULL;
+
+    if (iovcnt < 0 || iovcnt > IOV_MAX)
+        return -EINVAL;
+
+    if (NULL == (iov = kmalloc(MAX(iovcnt, 1) * sizeof *iov)))
+        return -ENOMEM;
+
+    err = -EFAULT;
+    if (copy_from_user(iov, uiov, iovcnt * sizeof *iov))
+        goto error;
+
+    for (int i = 0; i < iovcnt; ++i) {
+        if (!access_ok(iov[i].iov_base, iov[i].iov_len))
+            goto error;
+    }
+
+    err = -EINVAL;
+    if (iov_length(iov, iovcnt) < 0)
+        goto error;
+
+    *piov = iov;
+    return 0;
+error:
+    kfree(iov);
+    return err;
+}
+
+ssize_t  sys_readv(int fd, const struct iovec *iov, int iovcnt) {
+    ssize_t         err     = 0;
+    struct iovec    *kiov   = NULL;
+
+    if ((err = iov_import(iov, iovcnt, &kiov)))
+        return err;
+    err = readv(fd, kiov, iovcnt);
+    kfree(kiov);
+    return err;
+}
+
+ssize_t  sys_writev(int fd, const struct iovec *iov, int iovcnt) {
+    ssize_t         err     = 0;
+    struct iovec    *kiov   = NULL;
+
+    if ((err = iov_import(iov, iovcnt, &kiov)))
+        return err;
+    err = writev(fd, kiov, iovcnt);
+    kfree(kiov);
+    return err;
+}
+
+// like iov_import(), keep the buffer in the user half.
+ssize_t  sys_pread(int fd, void *buf, size_t sz, off_t off) {
+    if (!access_ok(buf, sz))
+        return -EFAULT;
+    return pread(fd, buf, sz, off);
+}
+
+ssize_t  sys_pwrite(int fd, void *buf, size_t sz, off_t off) {
+    if (!access_ok(buf, sz))
+        return -EFAULT;
+    return pwrite(fd, buf, sz, off);
+}
+
+ssize_t  sys_preadv(int fd, const struct iovec *iov, int iovcnt, off_t off) {
+    ssize_t         err     = 0;
+    struct iovec    *kiov   = NULL;
+
+    if ((err = iov_import(iov, iovcnt, &kiov)))
+        return err;
+    err = preadv(fd, kiov, iovcnt, off);
+    kfree(kiov);
+    return err;
+}
+
+ssize_t  sys_pwritev(int fd, const struct iovec *iov, int iovcnt, off_t off) {
+    ssize_t         err     = 0;
+    struct iovec    *kiov   = NULL;
+
+    if ((err = iov_import(iov, iovcnt, &kiov)))
+        return err;
+    err = pwritev(fd, kiov, iovcnt, off);
+    kfree(kiov);
+    return err;
+}
+
+// the offsets are copied in and back out, sendfile() and splice() take kernel pointers.
+ssize_t  sys_sendfile(int out_fd, int in_fd, off_t *offset, size_t count) {
+    ssize_t err = 0;
+    off_t   off = 0;
+
+    if (offset && copy_from_user(&off, offset, sizeof off))
+        return -EFAULT;
+
+    err = sendfile(out_fd, in_fd, offset ? &off : NULL, count);
+
+    if (offset && copy_to_user(offset, &off, sizeof off))
+        return -EFAULT;
+    return err;
+}
+
+ssize_t  sys_splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, uint flags) {
+    ssize_t err     = 0;
+    off_t   koff_in = 0;
+    off_t   koff_out= 0;
+
+    if (off_in && copy_from_user(&koff_in, off_in, sizeof koff_in))
+        return -EFAULT;
+
+    if (off_out && copy_from_user(&koff_out, off_out, sizeof koff_out))
+        return -EFAULT;
+
+    err = splice(fd_in, off_in ? &koff_in : NULL, fd_out, off_out ? &koff_out : NULL, len, flags);
+
+    if (off_in && copy_to_user(off_in, &koff_in, sizeof koff_in))
+        return -EFAULT;
+
+    if (off_out && copy_to_user(off_out, &koff_out, sizeof koff_out))
+        return -EFAULT;
+    return err;
+}
+
 off_t    sys_lseek(int fd, off_t off, int whence) {
     return lseek(fd, off, whence);
 }
@@ -108,23 +239,75 @@ int      sys_setattr(int fd, void *attr) {
 }
 
 int      sys_fstat(int fildes, struct stat *buf) {
-    return fstat(fildes, buf);
+    int         err = 0;
+    struct stat st  = {0};
+
+    if ((err = fstat(fildes, &st)))
+        return err;
+    return copy_to_user(buf, &st, sizeof st) ? -EFAULT : 0;
 }
 
 int      sys_stat(const char *restrict path, struct stat *restrict buf) {
-    return stat(path, buf);
+    int         err     = 0;
+    char        *kpath  = NULL;
+    struct stat st      = {0};
+
+    if ((err = strndup_user(path, PGSZ, &kpath)))
+        return err;
+
+    err = stat(kpath, &st);
+    kfree(kpath);
+
+    if (err)
+        return err;
+    return copy_to_user(buf, &st, sizeof st) ? -EFAULT : 0;
 }
 
 int      sys_lstat(const char *restrict path, struct stat *restrict buf) {
-    return lstat(path, buf);
+    int         err     = 0;
+    char        *kpath  = NULL;
+    struct stat st      = {0};
+
+    if ((err = strndup_user(path, PGSZ, &kpath)))
+        return err;
+
+    err = lstat(kpath, &st);
+    kfree(kpath);
+
+    if (err)
+        return err;
+    return copy_to_user(buf, &st, sizeof st) ? -EFAULT : 0;
 }
 
 int      sys_fstatat(int fd, const char *restrict path, struct stat *restrict buf, int flag) {
-    return fstatat(fd, path, buf, flag);
+    int         err     = 0;
+    char        *kpath  = NULL;
+    struct stat st      = {0};
+
+    if ((err = strndup_user(path, PGSZ, &kpath)))
+        return err;
+
+    err = fstatat(fd, kpath, &st, flag);
+    kfree(kpath);
+
+    if (err)
+        return err;
+    return copy_to_user(buf, &st, sizeof st) ? -EFAULT : 0;
 }
 
 int     sys_pipe(int fds[2]) {
-    return pipe(fds);
+    int err     = 0;
+    int kfds[2] = {0};
+
+    if ((err = pipe(kfds)))
+        return err;
+
+    if (copy_to_user(fds, kfds, sizeof kfds)) {
+        close(kfds[0]);
+        close(kfds[1]);
+        return -EFAULT;
+    }
+    return 0;
 }
 
 int      sys_uname(struct utsname *name) {
@@ -204,7 +387,7 @@ int sys_getcwd(char *buf, size_t size) {
         return err;
     }
 
-    err = copy_to_user(buf, buffer, size);
+    err = copy_to_user(buf, buffer, size) ? -EFAULT : 0;
 
     kfree(buffer);
 
@@ -321,6 +504,184 @@ void sys_thread_yield(void) {
     thread_yield();
 }
 
+// the scheduler calls below take kernel pointers, their arguments are copied in and out here.
+int sys_sched_setscheduler(tid_t tid, int policy, const struct sched_param *param) {
+    struct sched_param kparam = {0};
+
+    if (param && copy_from_user(&kparam, param, sizeof kparam))
+        return -EFAULT;
+    return sched_setscheduler(tid, policy, param ? &kparam : NULL);
+}
+
+int sys_sched_getscheduler(tid_t tid) {
+    return sched_getscheduler(tid);
+}
+
+int sys_sched_gettunables(struct sched_tunables *tunables) {
+    int                     err       = 0;
+    struct sched_tunables   ktunables = {0};
+
+    if (tunables == NULL)
+        return -EINVAL;
+
+    if ((err = sched_gettunables(&ktunables)))
+        return err;
+    return copy_to_user(tunables, &ktunables, sizeof ktunables) ? -EFAULT : 0;
+}
+
+int sys_sched_settunables(const struct sched_tunables *tunables) {
+    struct sched_tunables ktunables = {0};
+
+    if (tunables && copy_from_user(&ktunables, tunables, sizeof ktunables))
+        return -EFAULT;
+    return sched_settunables(tunables ? &ktunables : NULL);
+}
+
+int sys_sched_setaffinity(tid_t tid, size_t setsize, const cpu_set_t *mask) {
+    cpu_set_t kmask = {0};
+
+    if (mask && copy_from_user(&kmask, mask, MIN(setsize, sizeof kmask)))
+        return -EFAULT;
+    return sched_setaffinity(tid, setsize, mask ? &kmask : NULL);
+}
+
+int sys_sched_getaffinity(tid_t tid, size_t setsize, cpu_set_t *mask) {
+    int         err     = 0;
+    cpu_set_t   kmask   = {0};
+
+    if ((err = sched_getaffinity(tid, setsize, mask ? &kmask : NULL)))
+        return err;
+    return copy_to_user(mask, &kmask, MIN(setsize, sizeof kmask)) ? -EFAULT : 0;
+}
+
+long sys_futex(u32 *uaddr, int op, u32 val, const struct timespec *timeout, u32 *uaddr2, u32 val3) {
+    return futex(uaddr, op, val, timeout, uaddr2, val3);
+}
+
+// the time calls below take kernel pointers, their arguments are copied in and out here.
+int sys_nanosleep(const struct timespec *req, struct timespec *rem) {
+    return sys_clock_nanosleep(CLOCK_MONOTONIC, 0, req, rem);
+}
+
+int sys_clock_nanosleep(clockid_t clock_id, int flags, const struct timespec *req, struct timespec *rem) {
+    int             err     = 0;
+    struct timespec kreq    = {0};
+    struct timespec krem    = {0};
+
+    if (copy_from_user(&kreq, req, sizeof kreq))
+        return -EFAULT;
+
+    err = clock_nanosleep(clock_id, flags, &kreq, rem ? &krem : NULL);
+
+    // only an interrupted relative sleep reports what was left.
+    if (err == -EINTR && rem && !(flags & TIMER_ABSTIME)) {
+        if (copy_to_user(rem, &krem, sizeof krem))
+            return -EFAULT;
+    }
+    return err;
+}
+
+int sys_timer_create(clockid_t clock_id, struct sigevent *restrict sevp, timer_t *restrict timerid) {
+    int             err     = 0;
+    timer_t         id      = 0;
+    struct sigevent sev     = {0};
+
+    if (sevp && copy_from_user(&sev, sevp, sizeof sev))
+        return -EFAULT;
+
+    if ((err = timer_create(clock_id, sevp ? &sev : NULL, &id)))
+        return err;
+
+    if (copy_to_user(timerid, &id, sizeof id)) {
+        timer_delete(id);
+        return -EFAULT;
+    }
+    return 0;
+}
+
+int sys_timer_settime(timer_t timerid, int flags, const struct itimerspec *restrict value, struct itimerspec *restrict ovalue) {
+    int                 err     = 0;
+    struct itimerspec   kvalue  = {0};
+    struct itimerspec   kovalue = {0};
+
+    if (copy_from_user(&kvalue, value, sizeof kvalue))
+        return -EFAULT;
+
+    if ((err = timer_settime(timerid, flags, &kvalue, ovalue ? &kovalue : NULL)))
+        return err;
+
+    if (ovalue && copy_to_user(ovalue, &kovalue, sizeof kovalue))
+        return -EFAULT;
+    return 0;
+}
+
+int sys_timer_gettime(timer_t timerid, struct itimerspec *value) {
+    int                 err     = 0;
+    struct itimerspec   kvalue  = {0};
+
+    if ((err = timer_gettime(timerid, &kvalue)))
+        return err;
+    return copy_to_user(value, &kvalue, sizeof kvalue) ? -EFAULT : 0;
+}
+
+int sys_timer_getoverrun(timer_t timerid) {
+    return timer_getoverrun(timerid);
+}
+
+int sys_timer_delete(timer_t timerid) {
+    return timer_delete(timerid);
+}
+
+int sys_clock_gettime(clockid_t clock_id, struct timespec *tp) {
+    int             err = 0;
+    struct timespec ts  = {0};
+
+    if ((err = clock_gettime(clock_id, &ts)))
+        return err;
+    return copy_to_user(tp, &ts, sizeof ts) ? -EFAULT : 0;
+}
+
+int sys_clock_getres(clockid_t clock_id, struct timespec *res) {
+    int             err = 0;
+    struct timespec ts  = {0};
+
+    if ((err = clock_getres(clock_id, &ts)))
+        return err;
+
+    if (res && copy_to_user(res, &ts, sizeof ts))
+        return -EFAULT;
+    return 0;
+}
+
+int sys_clock_settime(clockid_t clock_id, const struct timespec *tp) {
+    struct timespec ts = {0};
+
+    if (copy_from_user(&ts, tp, sizeof ts))
+        return -EFAULT;
+    return clock_settime(clock_id, &ts);
+}
+
+int sys_uring_setup(u32 entries, uring_params_t *params) {
+    int             fd      = 0;
+    uring_params_t  kparams = {0};
+
+    if (copy_from_user(&kparams, params, sizeof kparams))
+        return -EFAULT;
+
+    if ((fd = uring_setup(entries, &kparams)) < 0)
+        return fd;
+
+    if (copy_to_user(params, &kparams, sizeof kparams)) {
+        close(fd);
+        return -EFAULT;
+    }
+    return fd;
+}
+
+int sys_uring_enter(int fd, u32 to_submit, u32 min_complete, u32 flags) {
+    return uring_enter(fd, to_submit, min_complete, flags);
+}
+
 int sys_pause(void) {
     return pause();
 }
@@ -350,7 +711,19 @@ int sys_sigpending(sigset_t *set) {
 }
 
 int sys_sigaction(int signo, const sigaction_t *restrict act, sigaction_t *restrict oact) {
-    return sigaction(signo, act, oact);
+    int         err     = 0;
+    sigaction_t kact    = {0};
+    sigaction_t koact   = {0};
+
+    if (act && copy_from_user(&kact, act, sizeof kact))
+        return -EFAULT;
+
+    if ((err = sigaction(signo, act ? &kact : NULL, oact ? &koact : NULL)))
+        return err;
+
+    if (oact && copy_to_user(oact, &koact, sizeof koact))
+        return -EFAULT;
+    return 0;
 }
 
 int sys_pthread_kill(tid_t thread, int signo) {
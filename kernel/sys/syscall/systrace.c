@@ -0,0 +1,366 @@
+#include <arch/cpu.h>
+#include <arch/tsc.h>
+#include <bits/errno.h>
+#include <lib/printk.h>
+#include <lib/string.h>
+#include <mm/kalloc.h>
+#include <sync/atomic.h>
+#include <sync/preempt.h>
+#include <sync/spinlock.h>
+#include <sys/proc.h>
+#include <sys/syscall.h>
+#include <sys/systrace.h>
+#include <sys/thread.h>
+
+// name and argument count of each system call, for the trace.
+static const struct {
+    const char  *name;
+    int         nargs;
+} systrace_calls[] = {
+    [SYS_PUTC]              = { "putc", 1 },
+    [SYS_CLOSE]             = { "close", 1 },
+    [SYS_UNLINK]            = { "unlink", 1 },
+    [SYS_DUP]               = { "dup", 1 },
+    [SYS_DUP2]              = { "dup2", 2 },
+    [SYS_TRUNCATE]          = { "truncate", 2 },
+    [SYS_FCNTL]             = { "fcntl", 3 },
+    [SYS_IOCTL]             = { "ioctl", 3 },
+    [SYS_LSEEK]             = { "lseek", 3 },
+    [SYS_READ]              = { "read", 3 },
+    [SYS_WRITE]             = { "write", 3 },
+    [SYS_OPEN]              = { "open", 3 },
+    [SYS_CREATE]            = { "create", 3 },
+    [SYS_MKDIRAT]           = { "mkdirat", 3 },
+    [SYS_READDIR]           = { "readdir", 4 },
+    [SYS_LINKAT]            = { "linkat", 3 },
+    [SYS_MKNODAT]           = { "mknodat", 4 },
+    [SYS_SYNC]              = { "sync", 1 },
+    [SYS_GETATTR]           = { "getattr", 2 },
+    [SYS_SETATTR]           = { "setattr", 2 },
+    [SYS_PARK]              = { "park", 0 },
+    [SYS_UNPARK]            = { "unpark", 1 },
+    [SYS_EXIT]              = { "exit", 1 },
+    [SYS_GETPID]            = { "getpid", 0 },
+    [SYS_GETPPID]           = { "getppid", 0 },
+    [SYS_SLEEP]             = { "sleep", 1 },
+    [SYS_GETTID]            = { "gettid", 0 },
+    [SYS_THREAD_EXIT]       = { "thread_exit", 1 },
+    [SYS_THREAD_CREATE]     = { "thread_create", 4 },
+    [SYS_THREAD_JOIN]       = { "thread_join", 2 },
+    [SYS_PAUSE]             = { "pause", 0 },
+    [SYS_KILL]              = { "kill", 2 },
+    [SYS_ALARM]             = { "alarm", 1 },
+    [SYS_SIGNAL]            = { "signal", 2 },
+    [SYS_SIGPROCMASK]       = { "sigprocmask", 3 },
+    [SYS_SIGPENDING]        = { "sigpending", 1 },
+    [SYS_SIGACTION]         = { "sigaction", 3 },
+    [SYS_PTHREAD_KILL]      = { "pthread_kill", 2 },
+    [SYS_SIGWAIT]           = { "sigwait", 2 },
+    [SYS_PTHREAD_SIGMASK]   = { "pthread_sigmask", 3 },
+    [SYS_THREAD_SELF]       = { "thread_self", 0 },
+    [SYS_MMAP]              = { "mmap", 6 },
+    [SYS_UNMAP]             = { "munmap", 2 },
+    [SYS_MPROTECT]          = { "mprotect", 3 },
+    [SYS_THREAD_YIELD]      = { "thread_yield", 0 },
+    [SYS_GETPAGESIZE]       = { "getpagesize", 0 },
+    [SYS_GETUID]            = { "getuid", 0 },
+    [SYS_GETGID]            = { "getgid", 0 },
+    [SYS_GETEUID]           = { "geteuid", 0 },
+    [SYS_GETEGID]           = { "getegid", 0 },
+    [SYS_SETUID]            = { "setuid", 1 },
+    [SYS_SETGID]            = { "setgid", 1 },
+    [SYS_SETEUID]           = { "seteuid", 1 },
+    [SYS_SETEGID]           = { "setegid", 1 },
+    [SYS_FORK]              = { "fork", 0 },
+    [SYS_GETMEMUSAGE]       = { "getmemusage", 1 },
+    [SYS_GETSID]            = { "getsid", 1 },
+    [SYS_SETSID]            = { "setsid", 0 },
+    [SYS_GETPGRP]           = { "getpgrp", 0 },
+    [SYS_SETPGRP]           = { "setpgrp", 0 },
+    [SYS_GETPGID]           = { "getpgid", 1 },
+    [SYS_SETPGID]           = { "setpgid", 2 },
+    [SYS_WAITPID]           = { "waitpid", 3 },
+    [SYS_FSTAT]             = { "fstat", 2 },
+    [SYS_STAT]              = { "stat", 2 },
+    [SYS_LSTAT]             = { "lstat", 2 },
+    [SYS_FSTATAT]           = { "fstatat", 4 },
+    [SYS_WAIT]              = { "wait", 1 },
+    [SYS_UNAME]             = { "uname", 1 },
+    [SYS_CHOWN]             = { "chown", 3 },
+    [SYS_FCHOWN]            = { "fchown", 3 },
+    [SYS_GETTIMEOFDAY]      = { "gettimeofday", 2 },
+    [SYS_UMASK]             = { "umask", 1 },
+    [SYS_ISATTY]            = { "isatty", 1 },
+    [SYS_GETCWD]            = { "getcwd", 2 },
+    [SYS_CHDIR]             = { "chdir", 1 },
+    [SYS_OPENAT]            = { "openat", 4 },
+    [SYS_EXECVE]            = { "execve", 3 },
+    [SYS_RAISE]             = { "raise", 1 },
+    [SYS_PIPE]              = { "pipe", 1 },
+    [SYS_MKDIR]             = { "mkdir", 2 },
+    [SYS_MKNOD]             = { "mknod", 3 },
+    [SYS_SCHED_SETSCHEDULER]= { "sched_setscheduler", 3 },
+    [SYS_SCHED_GETSCHEDULER]= { "sched_getscheduler", 1 },
+    [SYS_SCHED_GETTUNABLES] = { "sched_gettunables", 1 },
+    [SYS_SCHED_SETTUNABLES] = { "sched_settunables", 1 },
+    [SYS_SCHED_SETAFFINITY] = { "sched_setaffinity", 3 },
+    [SYS_SCHED_GETAFFINITY] = { "sched_getaffinity", 3 },
+    [SYS_FUTEX]             = { "futex", 6 },
+    [SYS_NANOSLEEP]         = { "nanosleep", 2 },
+    [SYS_CLOCK_NANOSLEEP]   = { "clock_nanosleep", 4 },
+    [SYS_TIMER_CREATE]      = { "timer_create", 3 },
+    [SYS_TIMER_SETTIME]     = { "timer_settime", 4 },
+    [SYS_TIMER_GETTIME]     = { "timer_gettime", 2 },
+    [SYS_TIMER_GETOVERRUN]  = { "timer_getoverrun", 1 },
+    [SYS_TIMER_DELETE]      = { "timer_delete", 1 },
+    [SYS_CLOCK_GETTIME]     = { "clock_gettime", 2 },
+    [SYS_CLOCK_GETRES]      = { "clock_getres", 2 },
+    [SYS_CLOCK_SETTIME]     = { "clock_settime", 2 },
+    [SYS_URING_SETUP]       = { "uring_setup", 2 },
+    [SYS_URING_ENTER]       = { "uring_enter", 4 },
+    [SYS_READV]             = { "readv", 3 },
+    [SYS_WRITEV]            = { "writev", 3 },
+    [SYS_PREAD]             = { "pread", 4 },
+    [SYS_PWRITE]            = { "pwrite", 4 },
+    [SYS_PREADV]            = { "preadv", 4 },
+    [SYS_PWRITEV]           = { "pwritev", 4 },
+    [SYS_SENDFILE]          = { "sendfile", 4 },
+    [SYS_SPLICE]            = { "splice", 6 },
+};
+
+#define NSYSCALL    NELEM(systrace_calls)
+
+typedef struct systrace_stat {
+    u64             st_count;
+    u64             st_errors;                      // returned a negated errno.
+    u64             st_ns;                          // total time spent.
+    u64             st_lat[SYSTRACE_LAT_NBUCKETS];  // latency histogram.
+} systrace_stat_t;
+
+/**
+ * Only its CPU, with interrupts off, writes sc_stat, sc_head and the ring
+ * records, readers only move sc_tail, under systrace_lock. Records are
+ * published by the store to sc_head and freed by the store to sc_tail.
+ */
+typedef struct systrace_cpu {
+    systrace_rec_t  *sc_ring;       // SYSTRACE_RING_SIZE records, from the first "on".
+    u64             sc_head;        // next record to write.
+    u64             sc_tail;        // next record to read.
+    u64             sc_dropped;     // records lost to a full ring.
+    systrace_stat_t sc_stat[NSYSCALL];
+} systrace_cpu_t;
+
+static systrace_cpu_t   *systrace_cpus[MAXNCPU];
+static int              systrace_on     = 0;
+static pid_t            systrace_pid    = 0;    // pid traced, all if 0.
+static spinlock_t       systrace_lock   = SPINLOCK_INIT();
+
+#define SYSTRACE_LAT_BUCKET(ns) ({                                  \
+    u64 __ns = (ns);                                                \
+    int __b  = __ns ? 64 - __builtin_clzl(__ns) : 0;                \
+    __b < SYSTRACE_LAT_NBUCKETS ? __b : SYSTRACE_LAT_NBUCKETS - 1;  \
+})
+
+int systrace_init(void) {
+    for (int id = 0; id < MAXNCPU; ++id) {
+        if (cpus[id] == NULL)
+            continue;
+
+        if ((systrace_cpus[id] = kcalloc(1, sizeof (systrace_cpu_t))) == NULL)
+            return -ENOMEM;
+    }
+    return 0;
+}
+
+void systrace_syscall(usize nr, const u64 args[SYSTRACE_NARGS], u64 ret, u64 entry) {
+    u64             exit    = tsc_read();
+    // the offsets are calibrated, not exact, so clamp a small backward step.
+    u64             ns      = exit > entry ? tsc_to_ns(exit - entry) : 0;
+    u64             head    = 0;
+    systrace_rec_t  *rec    = NULL;
+    systrace_cpu_t  *sc     = NULL;
+    systrace_stat_t *st     = NULL;
+
+    if (nr >= NSYSCALL)
+        return;
+
+    pushcli();
+    if ((sc = systrace_cpus[getcpuid()]) == NULL)
+        goto done;
+
+    st = &sc->sc_stat[nr];
+    st->st_count++;
+    st->st_ns += ns;
+    st->st_lat[SYSTRACE_LAT_BUCKET(ns)]++;
+    if ((i64)ret < 0 && (i64)ret >= -4095)
+        st->st_errors++;
+
+    if (!atomic_read(&systrace_on) || sc->sc_ring == NULL)
+        goto done;
+
+    if (systrace_pid && systrace_pid != getpid())
+        goto done;
+
+    head = sc->sc_head;
+    if (head - atomic_read(&sc->sc_tail) >= SYSTRACE_RING_SIZE) {
+        sc->sc_dropped++;
+        goto done;
+    }
+
+    rec             = &sc->sc_ring[head & (SYSTRACE_RING_SIZE - 1)];
+    rec->sr_entry   = entry;
+    rec->sr_exit    = exit;
+    rec->sr_ret     = ret;
+    rec->sr_pid     = getpid();
+    rec->sr_tid     = current ? current->t_tid : 0;
+    rec->sr_nr      = nr;
+    rec->sr_cpu     = getcpuid();
+    memcpy(rec->sr_args, args, sizeof rec->sr_args);
+    atomic_write(&sc->sc_head, head + 1);
+done:
+    popcli();
+}
+
+static size_t systrace_format(const systrace_rec_t *rec, char *buf, size_t size) {
+    size_t      len     = 0;
+    const char  *name   = systrace_calls[rec->sr_nr].name;
+
+    len += snprintf(buf + len, size - len, "%lu cpu%u %d/%d %s(",
+        rec->sr_entry, rec->sr_cpu, rec->sr_pid, rec->sr_tid, name ? name : "?"
+    );
+
+    for (int i = 0; i < systrace_calls[rec->sr_nr].nargs && len < size; ++i)
+        len += snprintf(buf + len, size - len, i ? ", 0x%lx" : "0x%lx", rec->sr_args[i]);
+
+    if (len < size)
+        len += snprintf(buf + len, size - len, ") = %ld <%lu ns>\n",
+            rec->sr_ret, rec->sr_exit > rec->sr_entry ?
+            tsc_to_ns(rec->sr_exit - rec->sr_entry) : 0);
+    return len;
+}
+
+ssize_t systrace_read(char *buf, size_t size) {
+    size_t          len     = 0;
+    size_t          n       = 0;
+    u64             tail    = 0;
+    systrace_cpu_t  *sc     = NULL;
+    char            line[256];
+
+    spin_lock(&systrace_lock);
+    for (int id = 0; id < MAXNCPU; ++id) {
+        if ((sc = systrace_cpus[id]) == NULL || sc->sc_ring == NULL)
+            continue;
+
+        for (tail = sc->sc_tail; tail != atomic_read(&sc->sc_head); ++tail) {
+            n = systrace_format(&sc->sc_ring[tail & (SYSTRACE_RING_SIZE - 1)], line, sizeof line);
+            n = MIN(n, sizeof line - 1);
+            if (n > size - len)
+                break;
+            memcpy(buf + len, line, n);
+            len += n;
+        }
+        atomic_write(&sc->sc_tail, tail);
+    }
+    spin_unlock(&systrace_lock);
+
+    return len;
+}
+
+ssize_t systrace_ctl(const char *buf, size_t size) {
+    ssize_t         err     = 0;
+    systrace_rec_t  *ring   = NULL;
+    char            cmd[32] = {0};
+
+    memcpy(cmd, buf, MIN(size, sizeof cmd - 1));
+    for (char *c = cmd; *c; ++c) {
+        if (*c == '\n')
+            *c = '\0';
+    }
+
+    spin_lock(&systrace_lock);
+    if (string_eq(cmd, "off")) {
+        atomic_write(&systrace_on, 0);
+    } else if (!strncmp(cmd, "pid ", 4)) {
+        atomic_write(&systrace_pid, atoi(cmd + 4));
+    } else if (string_eq(cmd, "on")) {
+        // rings are kept once allocated, so the producers never see them go.
+        for (int id = 0; id < MAXNCPU; ++id) {
+            if (systrace_cpus[id] == NULL || systrace_cpus[id]->sc_ring)
+                continue;
+
+            err = -ENOMEM;
+            if ((ring = kcalloc(SYSTRACE_RING_SIZE, sizeof *ring)) == NULL)
+                goto error;
+            atomic_write(&systrace_cpus[id]->sc_ring, ring);
+        }
+        atomic_write(&systrace_on, 1);
+    } else {
+        err = -EINVAL;
+        goto error;
+    }
+    spin_unlock(&systrace_lock);
+
+    return size;
+error:
+    spin_unlock(&systrace_lock);
+    return err;
+}
+
+ssize_t sysstat_show(char *buf, size_t size) {
+    size_t          len     = 0;
+    u64             dropped = 0;
+    systrace_stat_t st      = {0};
+    systrace_stat_t *cst    = NULL;
+    systrace_cpu_t  *sc     = NULL;
+
+    for (int id = 0; id < MAXNCPU; ++id) {
+        if ((sc = systrace_cpus[id]))
+            dropped += sc->sc_dropped;
+    }
+
+    len += snprintf(buf + len, size - len,
+        "# trace %s pid %d dropped %lu\n"
+        "# name calls errors total_ns, then lat: bucket b counts [2^(b-1), 2^b) ns\n",
+        atomic_read(&systrace_on) ? "on" : "off",
+        atomic_read(&systrace_pid), dropped
+    );
+
+    for (usize nr = 0; nr < NSYSCALL && len < size; ++nr) {
+        memset(&st, 0, sizeof st);
+        for (int id = 0; id < MAXNCPU; ++id) {
+            if ((sc = systrace_cpus[id]) == NULL)
+                continue;
+
+            cst = &sc->sc_stat[nr];
+            st.st_count     += cst->st_count;
+            st.st_errors    += cst->st_errors;
+            st.st_ns        += cst->st_ns;
+            for (size_t b = 0; b < SYSTRACE_LAT_NBUCKETS; ++b)
+                st.st_lat[b]+= cst->st_lat[b];
+        }
+
+        if (st.st_count == 0 || systrace_calls[nr].name == NULL)
+            continue;
+
+        len += snprintf(buf + len, size - len, "%s %lu %lu %lu lat",
+            systrace_calls[nr].name, st.st_count, st.st_errors, st.st_ns);
+
+        for (size_t b = 0; b < SYSTRACE_LAT_NBUCKETS && len < size; ++b)
+            len += snprintf(buf + len, size - len, " %lu", st.st_lat[b]);
+
+        if (len < size)
+            len += snprintf(buf + len, size - len, "\n");
+    }
+
+    return MIN(len, size);
+}
+
+void sysstat_reset(void) {
+    for (int id = 0; id < MAXNCPU; ++id) {
+        if (systrace_cpus[id] == NULL)
+            continue;
+
+        memset(systrace_cpus[id]->sc_stat, 0, sizeof systrace_cpus[id]->sc_stat);
+        systrace_cpus[id]->sc_dropped = 0;
+    }
+}
@@ -1,15 +1,107 @@
 #include <bits/errno.h>
+#include <ginger/clocksource.h>
+#include <ginger/jiffies.h>
 #include <sys/_time.h>
+#include <sys/sched.h>
+#include <sys/sysprot.h>
 #include <sys/system.h>
-#include <dev/rtc.h>
+#include <sys/thread.h>
 #include <lib/types.h>
-#include <dev/clocks.h>
 
+// CPU time used by all threads of the calling process.
+static u64 clock_proc_cputime(void) {
+    u64     ns      = 0;
+    queue_t *tgroup = current_tgroup();
 
+    tgroup_lock(tgroup);
+    queue_foreach(thread_t *, thread, tgroup) {
+        thread_lock(thread);
+        ns += sched_cputime(thread);
+        thread_unlock(thread);
+    }
+    tgroup_unlock(tgroup);
+    return ns;
+}
+
+static u64 clock_thread_cputime(void) {
+    u64 ns = 0;
+
+    current_lock();
+    ns = sched_cputime(current);
+    current_unlock();
+    return ns;
+}
+
+int clock_getres(clockid_t clock_id, struct timespec *res) {
+    switch (clock_id) {
+    case CLOCK_REALTIME:
+    case CLOCK_MONOTONIC:
+    case CLOCK_PROCESS_CPUTIME_ID:
+    case CLOCK_THREAD_CPUTIME_ID:
+        break;
+    default:
+        return -EINVAL;
+    }
+
+    // all of them are read off the clocksource.
+    if (res)
+        NS_TO_TIMESPEC(clocksource_res(), res);
+    return 0;
+}
+
+int clock_gettime(clockid_t clock_id, struct timespec *tp) {
+    u64 ns = 0;
+
+    if (tp == NULL)
+        return -EFAULT;
+
+    switch (clock_id) {
+    case CLOCK_REALTIME:
+        ns = clocksource_ns() + clocksource_realtime_offset();
+        break;
+    case CLOCK_MONOTONIC:
+        ns = clocksource_ns();
+        break;
+    case CLOCK_PROCESS_CPUTIME_ID:
+        ns = clock_proc_cputime();
+        break;
+    case CLOCK_THREAD_CPUTIME_ID:
+        ns = clock_thread_cputime();
+        break;
+    default:
+        return -EINVAL;
+    }
+
+    NS_TO_TIMESPEC(ns, tp);
+    return 0;
+}
+
+int clock_settime(clockid_t clock_id, const struct timespec *tp) {
+    if (tp == NULL)
+        return -EFAULT;
+
+    // only the wall clock can be set.
+    if (clock_id != CLOCK_REALTIME)
+        return -EINVAL;
+
+    if (tp->tv_sec < 0 || tp->tv_nsec < 0 || tp->tv_nsec >= NSEC_PER_SEC)
+        return -EINVAL;
+
+    if (geteuid() != 0)
+        return -EPERM;
+
+    clocksource_set_realtime(TIMESPEC_TO_NS(tp));
+    return 0;
+}
 
 int gettimeofday(struct timeval *restrict tp, void *restrict tzp __unused) {
-    time_t time = rtc_gettime();
-    tp->tv_usec = 0;
-    tp->tv_sec  = time;
+    u64 ns = 0;
+
+    if (tp == NULL)
+        return -EFAULT;
+
+    ns = clocksource_ns() + clocksource_realtime_offset();
+    tp->tv_sec  = ns / NSEC_PER_SEC;
+    tp->tv_usec = (ns % NSEC_PER_SEC) / NSEC_PER_USEC;
     return 0;
-}
\ No newline at end of file
+}
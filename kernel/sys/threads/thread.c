@@ -6,11 +6,13 @@
 #include <lib/string.h>
 #include <mm/kalloc.h>
 #include <mm/vmm.h>
+#include <sync/rcu.h>
 #include <sys/proc.h>
 #include <sys/sched.h>
 #include <sys/system.h>
 #include <sys/thread.h>
 
+// thread_get() walks it under rcu_read_lock(), changes are serialized by its queue lock.
 static QUEUE(threads_queue);
 
 const char *t_states[] = {
@@ -116,7 +118,10 @@ int thread_alloc(usize ksz /*kstacksz*/, int __flags, thread_t **ret) {
     affinity->cpu_set       = -1;
     affinity->type          = SOFT_AFFINITY;
     sched->ts_ctime         = jiffies_get();
-    sched->ts_priority      = SCHED_LOWEST_PRIORITY;
+    // new threads start at the top, SCHED_MLFQ feedback moves CPU hogs down.
+    sched->ts_priority      = SCHED_HIGHEST_PRIORITY;
+    sched->ts_base_priority = SCHED_HIGHEST_PRIORITY;
+    sched->ts_policy        = SCHED_MLFQ;
 
     // every thread begins as an embryo.
     thread_enter_state(thread, T_EMBRYO);
@@ -277,6 +282,11 @@ error:
     return err;
 }
 
+static void thread_free_rcu(rcu_head_t *head) {
+    thread_t *thread = container_of(head, thread_t, t_rcu);
+    thread_kstack_free((uintptr_t)thread->t_arch.t_kstack.ss_sp);
+}
+
 void thread_free(thread_t *thread) {
     queue_node_t    *next  = NULL;
     queue_t         *queue = NULL;
@@ -286,6 +296,15 @@ void thread_free(thread_t *thread) {
     thread_assert_locked(thread);
     assert(thread_iszombie(thread), "freeing a non zombie thread");
 
+    // leave threads_queue first, thread_get() may still reach us through it until a grace period ends.
+    thread_setflags(thread, THREAD_REAPED);
+    queue_lock(threads_queue);
+    queue_lock(&thread->t_queues);
+    queue_remove(&thread->t_queues, (void *)threads_queue);
+    queue_unlock(&thread->t_queues);
+    queue_remove_rcu(threads_queue, (void *)thread);
+    queue_unlock(threads_queue);
+
     /**
      * Get rid of all the queues with which this thread is associated.
     */
@@ -309,7 +328,7 @@ void thread_free(thread_t *thread) {
     assert(thread->t_arch.t_kstack.ss_sp, "??? No kernel stack ???");
 
     thread_unlock(thread);
-    thread_kstack_free((uintptr_t)thread->t_arch.t_kstack.ss_sp);
+    call_rcu(&thread->t_rcu, thread_free_rcu);
 }
 
 int thread_detach(thread_t *thread) {
@@ -755,10 +774,16 @@ int thread_fork(thread_t *dst, thread_t *src, mmap_t *mmap) {
     sp = mctx->rsp;
 
     dst->t_sched = (thread_sched_t) {
-        .ts_priority        = src->t_sched.ts_priority,
+        .ts_priority        = src->t_sched.ts_pi_boosted ?
+                              src->t_sched.ts_pi_priority : (long)src->t_sched.ts_priority,
+        .ts_base_priority   = src->t_sched.ts_base_priority,
+        .ts_boost           = src->t_sched.ts_boost,
         .ts_processor       = src->t_sched.ts_processor,
         .ts_timeslice       = src->t_sched.ts_timeslice,
         .ts_affinity.type   = src->t_sched.ts_affinity.type,
+        .ts_policy          = src->t_sched.ts_pi_boosted ?
+                              src->t_sched.ts_pi_policy : src->t_sched.ts_policy,
+        .ts_vruntime        = src->t_sched.ts_vruntime,
     };
 
     if ((ustack = mmap_find(mmap, sp)) == NULL) {
@@ -788,24 +813,29 @@ int thread_get(tid_t tid, tstate_t state, thread_t **ppthread) {
         return 0;
     }
 
-    if (!current_isuser()) {
-        queue_lock(threads_queue);
-        queue_foreach(thread_t *, thread, threads_queue) {
-            thread_lock(thread);
-            if (tid == 0 && thread_isstate(thread, state)) {
-                *ppthread = thread_getref(thread);
-                return 0;
-            }
+    if (current_isuser())
+        return -ESRCH;
 
-            if (thread_gettid(thread) == tid) {
-                *ppthread = thread_getref(thread);
-                queue_unlock(threads_queue);
-                return 0;
-            }
-            thread_unlock(thread);
+    /**
+     * Lookups walk threads_queue under rcu_read_lock() without taking any shared lock.
+     * Threads freed meanwhile keep their kstack until a grace period ends,
+     * so they can still be locked here and are told apart by THREAD_REAPED.
+     */
+    rcu_read_lock();
+    forlinked(node, rcu_dereference(threads_queue->head), rcu_dereference(node->next)) {
+        thread = node->data;
+        if (tid && thread_gettid(thread) != tid)
+            continue;
+
+        thread_lock(thread);
+        if (!thread_isreaped(thread) && (tid || thread_isstate(thread, state))) {
+            *ppthread = thread_getref(thread);
+            rcu_read_unlock();
+            return 0;
         }
-        queue_unlock(threads_queue);
+        thread_unlock(thread);
     }
+    rcu_read_unlock();
     return -ESRCH;
 }
 
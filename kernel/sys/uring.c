@@ -0,0 +1,588 @@
+#include <arch/paging.h>
+#include <arch/uaccess.h>
+#include <bits/errno.h>
+#include <fs/file.h>
+#include <fs/pipefs.h>
+#include <ginger/hrtimer.h>
+#include <lib/string.h>
+#include <mm/kalloc.h>
+#include <mm/page.h>
+#include <mm/pmm.h>
+#include <mm/vmm.h>
+#include <sync/atomic.h>
+#include <sync/spinlock.h>
+#include <sync/waitq.h>
+#include <sys/proc.h>
+#include <sys/sysproc.h>
+#include <sys/thread.h>
+#include <sys/uring.h>
+#include <sys/_signal.h>
+#include <sys/_time.h>
+
+_Static_assert(sizeof(uring_sqe_t) == 40, "uring_sqe_t layout");
+_Static_assert(sizeof(uring_cqe_t) == 16, "uring_cqe_t layout");
+_Static_assert(sizeof(uring_queue_t) == 64, "uring_queue_t layout");
+
+// an SQE taken off the SQ, waiting for or being run by a worker.
+typedef struct uring_req {
+    uring_sqe_t         rq_sqe;
+    struct uring_req    *rq_next;
+} uring_req_t;
+
+/**
+ * A ring, referenced by its file and each of its threads.
+ * ur_lock protects the request lists and the kernel's ring indices,
+ * and serializes posting CQEs. The waiters of all three wait queues
+ * hold it until they are queued, so wakers holding it can't miss them.
+ */
+typedef struct uring {
+    atomic_t        ur_refs;
+    spinlock_t      ur_lock;
+    int             ur_closed;      // the file is gone, threads exit.
+    pid_t           ur_pid;         // process the ring was set up by.
+    u32             ur_flags;       // URING_SETUP_*.
+    u64             ur_sq_idle;     // SQ poller idle time in ns.
+
+    uintptr_t       ur_ring;        // kernel mapping of the shared pages.
+    uintptr_t       *ur_pages;      // physical address of each shared page.
+    usize           ur_npages;
+    uring_queue_t   *ur_sq;
+    uring_queue_t   *ur_cq;
+    uring_sqe_t     *ur_sqes;
+    uring_cqe_t     *ur_cqes;
+    u32             ur_sqhead;      // our copy of sq.uq_head, userspace may scribble on the shared one.
+    u32             ur_cqtail;      // our copy of cq.uq_tail.
+
+    // at most cq.uq_entries requests are in flight, so a drained CQ has room for all of them.
+    uring_req_t     *ur_reqs;
+    uring_req_t     *ur_free;
+    uring_req_t     *ur_head;       // submitted, waiting for a worker.
+    uring_req_t     *ur_tail;
+
+    waitq_t         ur_workq;       // idle workers.
+    waitq_t         ur_sqwait;      // idle SQ poller.
+    waitq_t         ur_cqwait;      // uring_enter() waiting for CQEs.
+} uring_t;
+
+static fops_t uring_fops;
+
+static void uring_free(uring_t *ur) {
+    if (ur->ur_ring)
+        arch_pagefree(ur->ur_ring, ur->ur_npages * PGSZ);
+
+    // pages still mapped by userspace live on until unmapped, see uring_fmmap().
+    for (usize i = 0; ur->ur_pages && i < ur->ur_npages; ++i) {
+        if (ur->ur_pages[i])
+            pmman.free(ur->ur_pages[i]);
+    }
+
+    if (ur->ur_pages)
+        kfree(ur->ur_pages);
+    if (ur->ur_reqs)
+        kfree(ur->ur_reqs);
+    kfree(ur);
+}
+
+static void uring_put(uring_t *ur) {
+    if (atomic_dec_fetch(&ur->ur_refs) == 0)
+        uring_free(ur);
+}
+
+// tell the threads to exit, they drop their references on their way out.
+static void uring_close(uring_t *ur) {
+    spin_lock(&ur->ur_lock);
+    ur->ur_closed = 1;
+    waitq_wake(&ur->ur_workq, 0, 0);
+    waitq_wake(&ur->ur_sqwait, 0, 0);
+    waitq_wake(&ur->ur_cqwait, 0, 0);
+    spin_unlock(&ur->ur_lock);
+    uring_put(ur);
+}
+
+static int uring_alloc_ring(uring_t *ur, u32 entries) {
+    usize       size    = URING_SIZE(entries);
+    uintptr_t   p       = 0;
+
+    ur->ur_npages = NPAGE(size);
+    if (NULL == (ur->ur_pages = kcalloc(ur->ur_npages, sizeof (uintptr_t))))
+        return -ENOMEM;
+
+    if ((ur->ur_ring = vmman.alloc(ur->ur_npages * PGSZ)) == 0)
+        return -ENOMEM;
+
+    // the pages needn't be contiguous, userspace only sees them through mappings.
+    for (usize i = 0; i < ur->ur_npages; ++i) {
+        if ((p = pmman.alloc()) == 0)
+            return -ENOMEM;
+        ur->ur_pages[i] = p;
+
+        if (arch_map_i(ur->ur_ring + i * PGSZ, p, PGSZ, PTE_KRW))
+            return -ENOMEM;
+    }
+
+    memset((void *)ur->ur_ring, 0, ur->ur_npages * PGSZ);
+
+    ur->ur_sq   = (uring_queue_t *)(ur->ur_ring + URING_SQ_OFF);
+    ur->ur_cq   = (uring_queue_t *)(ur->ur_ring + URING_CQ_OFF);
+    ur->ur_sqes = (uring_sqe_t *)(ur->ur_ring + URING_SQES_OFF);
+    ur->ur_cqes = (uring_cqe_t *)(ur->ur_ring + URING_CQES_OFF(entries));
+
+    ur->ur_sq->uq_entries   = entries;
+    ur->ur_sq->uq_mask      = entries - 1;
+    ur->ur_cq->uq_entries   = 2 * entries;
+    ur->ur_cq->uq_mask      = 2 * entries - 1;
+
+    if (NULL == (ur->ur_reqs = kcalloc(2 * entries, sizeof (uring_req_t))))
+        return -ENOMEM;
+
+    for (u32 i = 0; i < 2 * entries; ++i) {
+        ur->ur_reqs[i].rq_next = ur->ur_free;
+        ur->ur_free = &ur->ur_reqs[i];
+    }
+    return 0;
+}
+
+/**
+ * @brief move up to 'n' SQEs to the workers.
+ * Called with ur_lock held.
+ * @return u32 number of SQEs moved.
+ */
+static u32 uring_submit(uring_t *ur, u32 n) {
+    u32         count   = 0;
+    u32         tail    = atomic_read(&ur->ur_sq->uq_tail);
+    uring_req_t *req    = NULL;
+
+    spin_assert_locked(&ur->ur_lock);
+
+    // a bogus tail only gets garbage SQEs submitted, each fails on its own.
+    for (; count < n && ur->ur_sqhead != tail && ur->ur_free; ++count) {
+        req = ur->ur_free;
+        ur->ur_free = req->rq_next;
+
+        req->rq_sqe  = ur->ur_sqes[ur->ur_sqhead++ & ur->ur_sq->uq_mask];
+        req->rq_next = NULL;
+        if (ur->ur_tail)
+            ur->ur_tail->rq_next = req;
+        else
+            ur->ur_head = req;
+        ur->ur_tail = req;
+    }
+
+    if (count == 0)
+        return 0;
+
+    atomic_write(&ur->ur_sq->uq_head, ur->ur_sqhead);
+    if (waitq_active(&ur->ur_workq))
+        waitq_wake(&ur->ur_workq, count, 0);
+    return count;
+}
+
+// called with ur_lock held.
+static void uring_post(uring_t *ur, u64 user_data, i64 res) {
+    uring_cqe_t *cqe = NULL;
+
+    spin_assert_locked(&ur->ur_lock);
+
+    // userspace moved its head past ours, or never moves it.
+    if (ur->ur_cqtail - atomic_read(&ur->ur_cq->uq_head) >= ur->ur_cq->uq_entries) {
+        atomic_inc(&ur->ur_cq->uq_dropped);
+        return;
+    }
+
+    cqe = &ur->ur_cqes[ur->ur_cqtail & ur->ur_cq->uq_mask];
+    cqe->cqe_user_data  = user_data;
+    cqe->cqe_res        = res;
+    atomic_write(&ur->ur_cq->uq_tail, ++ur->ur_cqtail);
+
+    if (waitq_active(&ur->ur_cqwait))
+        waitq_wake(&ur->ur_cqwait, 0, 0);
+}
+
+static i64 uring_poll(uring_sqe_t *sqe) {
+    int     err     = 0;
+    int     want    = 0;
+    file_t  *file   = NULL;
+    inode_t *ip     = NULL;
+    int     events  = sqe->sqe_flags & (URING_POLLIN | URING_POLLOUT);
+
+    if ((err = file_get(sqe->sqe_fd, &file)))
+        return err;
+
+    if (file->f_dentry) {
+        dlock(file->f_dentry);
+        if ((ip = file->f_dentry->d_inode)) {
+            ilock(ip);
+            idupcnt(ip);
+            iunlock(ip);
+        }
+        dunlock(file->f_dentry);
+    }
+    funlock(file);
+
+    // only pipes can keep a read or write waiting, anything else is always ready.
+    if (ip == NULL)
+        return events;
+
+    if (IISPIPE(ip)) {
+        want  = (events & URING_POLLIN ? PIPE_R : 0) | (events & URING_POLLOUT ? PIPE_W : 0);
+        err   = pipe_poll(ip, want);
+        if (err == -EPIPE)
+            events = URING_POLLHUP;
+        else if (err >= 0)
+            events = (err & PIPE_R ? URING_POLLIN : 0) | (err & PIPE_W ? URING_POLLOUT : 0);
+    }
+
+    ilock(ip);
+    irelease(ip);
+    return err < 0 && err != -EPIPE ? err : events;
+}
+
+/**
+ * @brief READ and WRITE.
+ * Workers move the data through a kernel buffer with copy_{to,from}_user(),
+ * so a bad 'sqe_addr' completes with -EFAULT instead of faulting in the worker.
+ */
+static i64 uring_rw(uring_sqe_t *sqe) {
+    i64     ret     = 0;
+    usize   len     = 0;
+    usize   total   = 0;
+    void    *buf    = NULL;
+    char    *uaddr  = (char *)sqe->sqe_addr;
+    int     write_op= sqe->sqe_op == URING_OP_WRITE;
+
+    if (!access_ok(uaddr, sqe->sqe_len))
+        return -EFAULT;
+
+    if (NULL == (buf = kmalloc(MAX(MIN(sqe->sqe_len, URING_BOUNCESZ), 1))))
+        return -ENOMEM;
+
+    do {
+        len = MIN(sqe->sqe_len - total, URING_BOUNCESZ);
+        if (write_op && copy_from_user(buf, uaddr + total, len)) {
+            ret = -EFAULT;
+            break;
+        }
+
+        if (sqe->sqe_off == URING_OFF_CURRENT)
+            ret = write_op ? write(sqe->sqe_fd, buf, len) : read(sqe->sqe_fd, buf, len);
+        else if (write_op)
+            ret = pwrite(sqe->sqe_fd, buf, len, sqe->sqe_off + total);
+        else
+            ret = pread(sqe->sqe_fd, buf, len, sqe->sqe_off + total);
+
+        if (ret <= 0)
+            break;
+
+        if (!write_op && copy_to_user(uaddr + total, buf, ret)) {
+            ret = -EFAULT;
+            break;
+        }
+        total += ret;
+    } while ((usize)ret == len && total < sqe->sqe_len);
+
+    kfree(buf);
+    return total ? (i64)total : ret;
+}
+
+static i64 uring_execute(uring_sqe_t *sqe) {
+    int             err     = 0;
+    char            *path   = NULL;
+    struct timespec ts      = {0};
+
+    switch (sqe->sqe_op) {
+    case URING_OP_NOP:
+        return 0;
+    case URING_OP_READ:
+        __fallthrough;
+    case URING_OP_WRITE:
+        return uring_rw(sqe);
+    case URING_OP_FSYNC:
+        return sync(sqe->sqe_fd);
+    case URING_OP_OPENAT:
+        if ((err = strndup_user((const char *)sqe->sqe_addr, PGSZ, &path)))
+            return err;
+        err = openat(sqe->sqe_fd, path, sqe->sqe_flags, sqe->sqe_len);
+        kfree(path);
+        return err;
+    case URING_OP_CLOSE:
+        return close(sqe->sqe_fd);
+    case URING_OP_POLL:
+        return uring_poll(sqe);
+    case URING_OP_TIMEOUT:
+        if (copy_from_user(&ts, (void *)sqe->sqe_addr, sizeof ts))
+            return -EFAULT;
+        if ((err = nanosleep(&ts, NULL)))
+            return err;
+        return -ETIME;
+    }
+    return -EINVAL;
+}
+
+static void *uring_worker(uring_t *ur) {
+    i64             res = 0;
+    uring_req_t     *req= NULL;
+    waitq_entry_t   we  = {0};
+
+    spin_lock(&ur->ur_lock);
+    while (!ur->ur_closed && !current_iskilled()) {
+        if ((req = ur->ur_head) == NULL) {
+            we = WAITQ_ENTRY(WAITQ_EXCLUSIVE, 0);
+            if (waitq_wait(&ur->ur_workq, &we, &ur->ur_lock))
+                break;
+            continue;
+        }
+
+        if ((ur->ur_head = req->rq_next) == NULL)
+            ur->ur_tail = NULL;
+        spin_unlock(&ur->ur_lock);
+
+        res = uring_execute(&req->rq_sqe);
+
+        spin_lock(&ur->ur_lock);
+        uring_post(ur, req->rq_sqe.sqe_user_data, res);
+        req->rq_next = ur->ur_free;
+        ur->ur_free  = req;
+
+        // the SQ poller may be waiting for a free request.
+        if (waitq_active(&ur->ur_sqwait))
+            waitq_wake(&ur->ur_sqwait, 0, 0);
+    }
+    spin_unlock(&ur->ur_lock);
+
+    uring_put(ur);
+    return NULL;
+}
+
+static void *uring_sqpoll(uring_t *ur) {
+    u64             idle    = hrtimer_now() + ur->ur_sq_idle;
+    waitq_entry_t   we      = {0};
+
+    spin_lock(&ur->ur_lock);
+    while (!ur->ur_closed && !current_iskilled()) {
+        if (uring_submit(ur, (u32)-1)) {
+            idle = hrtimer_now() + ur->ur_sq_idle;
+            continue;
+        }
+
+        if (hrtimer_now() < idle) {
+            spin_unlock(&ur->ur_lock);
+            thread_yield();
+            spin_lock(&ur->ur_lock);
+            continue;
+        }
+
+        /**
+         * Userspace bumps the tail before it tests the flag,
+         * and we test the tail after setting it, so one of us sees the other.
+         * It then wakes us with ur_lock held, which we hold until queued.
+         */
+        atomic_or_fetch(&ur->ur_sq->uq_flags, URING_SQ_NEED_WAKEUP);
+        if (ur->ur_free == NULL || atomic_read(&ur->ur_sq->uq_tail) == ur->ur_sqhead) {
+            we = WAITQ_ENTRY(0, 0);
+            if (waitq_wait(&ur->ur_sqwait, &we, &ur->ur_lock))
+                break;
+        }
+        atomic_and_fetch(&ur->ur_sq->uq_flags, ~URING_SQ_NEED_WAKEUP);
+        idle = hrtimer_now() + ur->ur_sq_idle;
+    }
+    spin_unlock(&ur->ur_lock);
+
+    uring_put(ur);
+    return NULL;
+}
+
+// start a thread of the ring in the caller's process.
+static int uring_spawn(uring_t *ur, thread_entry_t entry) {
+    int         err     = 0;
+    thread_t    *thread = NULL;
+
+    atomic_inc(&ur->ur_refs);
+    if ((err = kthread_create(NULL, entry, ur, THREAD_CREATE_DETACHED, &thread))) {
+        atomic_dec(&ur->ur_refs);
+        return err;
+    }
+
+    proc_lock(curproc);
+    thread->t_mmap = proc_mmap(curproc);
+    proc_unlock(curproc);
+
+    // signals are for the process' own threads.
+    sigfillset(&thread->t_sigmask);
+
+    err = thread_schedule(thread);
+    thread_release(thread);
+    return err;
+}
+
+static int uring_fclose(file_t *file) {
+    int     err = 0;
+    uring_t *ur = file->f_priv;
+
+    if ((err = fput(file)))
+        return err;
+
+    if (file->f_refcnt > 0) {
+        funlock(file);
+        return 0;
+    }
+
+    fdestroy(file);
+    uring_close(ur);
+    return 0;
+}
+
+/**
+ * Every page is mapped right away, with a reference of its own,
+ * so the mapping outlives the ring and never faults into a freed one.
+ */
+static int uring_fmmap(file_t *file, vmr_t *region) {
+    int         err     = 0;
+    usize       first   = 0;
+    uring_t     *ur     = file->f_priv;
+
+    if (PGOFF(region->file_pos))
+        return -EINVAL;
+
+    first = region->file_pos / PGSZ;
+    if (first + NPAGE(__vmr_size(region)) > ur->ur_npages)
+        return -EINVAL;
+
+    for (usize i = 0; i < NPAGE(__vmr_size(region)); ++i) {
+        __page_getref(ur->ur_pages[first + i]);
+        if ((err = arch_map_i(region->start + i * PGSZ,
+            ur->ur_pages[first + i], PGSZ, region->vflags | PTE_ALLOC))) {
+            pmman.free(ur->ur_pages[first + i]);
+            // unmapping the PTE_ALLOC pages drops the references taken so far.
+            arch_unmap_n(region->start, i * PGSZ);
+            return err;
+        }
+    }
+    return 0;
+}
+
+static fops_t uring_fops = {
+    .fclose = uring_fclose,
+    .fmmap  = uring_fmmap,
+};
+
+int uring_setup(u32 entries, uring_params_t *params) {
+    int         err     = 0;
+    int         fd      = 0;
+    u32         nworker = 0;
+    file_t      *file   = NULL;
+    uring_t     *ur     = NULL;
+
+    if (params == NULL)
+        return -EFAULT;
+
+    if (entries == 0 || entries > URING_ENTRIES_MAX || (entries & (entries - 1)))
+        return -EINVAL;
+
+    if ((params->up_flags & ~URING_SETUP_SQPOLL) || params->up_workers > URING_WORKERS_MAX)
+        return -EINVAL;
+
+    if (curproc == NULL)
+        return -EINVAL;
+
+    if (NULL == (ur = kcalloc(1, sizeof *ur)))
+        return -ENOMEM;
+
+    ur->ur_refs     = 1;
+    ur->ur_lock     = SPINLOCK_INIT();
+    ur->ur_pid      = getpid();
+    ur->ur_flags    = params->up_flags;
+    ur->ur_sq_idle  = (u64)(params->up_sq_idle ? params->up_sq_idle : URING_SQ_IDLE_MS) * 1000000ul;
+    ur->ur_workq    = WAITQ_INIT();
+    ur->ur_sqwait   = WAITQ_INIT();
+    ur->ur_cqwait   = WAITQ_INIT();
+
+    if ((err = uring_alloc_ring(ur, entries))) {
+        uring_free(ur);
+        return err;
+    }
+
+    nworker = params->up_workers ? params->up_workers : URING_WORKERS;
+    for (u32 i = 0; i < nworker; ++i) {
+        if ((err = uring_spawn(ur, (thread_entry_t)uring_worker)))
+            goto error;
+    }
+
+    if (ur->ur_flags & URING_SETUP_SQPOLL) {
+        if ((err = uring_spawn(ur, (thread_entry_t)uring_sqpoll)))
+            goto error;
+    }
+
+    if ((err = file_alloc(&fd, &file)))
+        goto error;
+
+    file->f_oflags  = O_RDWR;
+    file->f_priv    = ur;
+    file->fops      = &uring_fops;
+    funlock(file);
+
+    params->up_entries  = entries;
+    params->up_workers  = nworker;
+    params->up_size     = URING_SIZE(entries);
+    return fd;
+error:
+    uring_close(ur);
+    return err;
+}
+
+int uring_enter(int fd, u32 to_submit, u32 min_complete, u32 flags) {
+    int             err     = 0;
+    int             count   = 0;
+    file_t          *file   = NULL;
+    uring_t         *ur     = NULL;
+    waitq_entry_t   we      = {0};
+
+    if (flags & ~(URING_ENTER_GETEVENTS | URING_ENTER_SQ_WAKEUP))
+        return -EINVAL;
+
+    if ((err = file_get(fd, &file)))
+        return err;
+
+    if (file->fops != &uring_fops) {
+        funlock(file);
+        return -EBADFD;
+    }
+
+    // keep the ring around should 'fd' be closed meanwhile.
+    ur = file->f_priv;
+    atomic_inc(&ur->ur_refs);
+    funlock(file);
+
+    // the workers run in the address space the ring was set up in.
+    if (ur->ur_pid != getpid()) {
+        err = -EBADFD;
+        goto done;
+    }
+
+    spin_lock(&ur->ur_lock);
+
+    if (ur->ur_flags & URING_SETUP_SQPOLL) {
+        if ((flags & URING_ENTER_SQ_WAKEUP) && waitq_active(&ur->ur_sqwait))
+            waitq_wake(&ur->ur_sqwait, 0, 0);
+    } else if (to_submit)
+        count = uring_submit(ur, to_submit);
+
+    if (flags & URING_ENTER_GETEVENTS) {
+        min_complete = MIN(min_complete, ur->ur_cq->uq_entries);
+        while (!ur->ur_closed &&
+            ur->ur_cqtail - atomic_read(&ur->ur_cq->uq_head) < min_complete) {
+            we = WAITQ_ENTRY(0, 0);
+            if ((err = waitq_wait(&ur->ur_cqwait, &we, &ur->ur_lock)))
+                break;
+            // not woken by a CQE, a signal is pending.
+            if (!we.we_woken) {
+                err = -EINTR;
+                break;
+            }
+        }
+    }
+
+    spin_unlock(&ur->ur_lock);
+done:
+    uring_put(ur);
+    return count ? count : err;
+}
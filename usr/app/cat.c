@@ -0,0 +1,40 @@
+#include <api.h>
+#include <ginger/unistd.h>
+
+/**
+ * cat [file...]: copies each file, or stdin without any, to stdout.
+ * The data moves with sendfile(), so it never passes through this process.
+ */
+
+#define CHUNK   (1024 * 1024)
+
+static int cat(int fd, const char *name) {
+    ssize_t n = 0;
+
+    while ((n = sendfile(1, fd, NULL, CHUNK)) > 0);
+
+    if (n < 0) {
+        printf("cat: %s: error %ld\n", name, n);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, const char *argv[]) {
+    int fd  = 0;
+    int err = 0;
+
+    if (argc < 2)
+        return cat(0, "stdin");
+
+    for (int i = 1; i < argc; ++i) {
+        if ((fd = open(argv[i], O_RDONLY, 0)) < 0) {
+            printf("cat: %s: error %d\n", argv[i], fd);
+            err = 1;
+            continue;
+        }
+        err |= cat(fd, argv[i]);
+        close(fd);
+    }
+    return err;
+}
@@ -0,0 +1,124 @@
+#include <ginger/unistd.h>
+#include <api.h>
+
+/**
+ * strace [-c] -p pid | command [args...]
+ * Prints the system calls of 'pid', or of 'command' run under it, from
+ * /proc/systrace as they are made. With -c, runs 'command' and prints the
+ * per-syscall counts and latency histograms of /proc/sysstat instead.
+ */
+
+static char buf[4096];
+
+static void usage(void) {
+    printf("usage: strace [-c] -p pid | command [args...]\n");
+    exit(1);
+}
+
+static void ctl(const char *file, const char *cmd) {
+    int fd = 0;
+
+    if ((fd = open(file, O_WRONLY, 0)) < 0)
+        panic("strace: %s: error %d\n", file, fd);
+    if (write(fd, (void *)cmd, strlen(cmd)) < 0)
+        panic("strace: %s: '%s' failed\n", file, cmd);
+    close(fd);
+}
+
+// copy what 'fd' has so far to stdout.
+static void drain(int fd) {
+    ssize_t n = 0;
+
+    while ((n = read(fd, buf, sizeof buf)) > 0)
+        write(1, buf, n);
+}
+
+// fork 'argv', held back until something is written to *'go'.
+static pid_t spawn(char *const argv[], int *go) {
+    int     fds[2];
+    pid_t   pid = 0;
+    char    c   = 0;
+
+    if (pipe(fds))
+        panic("strace: pipe failed\n");
+
+    if ((pid = fork()) < 0)
+        panic("strace: fork failed\n");
+
+    if (pid == 0) {
+        close(fds[1]);
+        read(fds[0], &c, 1);
+        close(fds[0]);
+        execve(argv[0], argv, (char *const[]){ NULL });
+        printf("strace: %s: exec failed\n", argv[0]);
+        exit(127);
+    }
+
+    close(fds[0]);
+    *go = fds[1];
+    return pid;
+}
+
+int main(int argc, char *const argv[]) {
+    int     i       = 1;
+    int     go      = -1;
+    int     fd      = 0;
+    int     summary = 0;
+    int     staloc  = 0;
+    pid_t   pid     = 0;
+    pid_t   child   = 0;
+    char    cmd[32];
+
+    for (; i < argc && argv[i][0] == '-'; ++i) {
+        if (!strcmp(argv[i], "-c"))
+            summary = 1;
+        else if (!strcmp(argv[i], "-p") && i + 1 < argc)
+            pid = atoi(argv[++i]);
+        else
+            usage();
+    }
+
+    if (i < argc)
+        pid = child = spawn(&argv[i], &go);
+
+    if (pid <= 0 || (summary && child == 0))
+        usage();
+
+    if (summary) {
+        ctl("/proc/sysstat", "reset");
+        write(go, "", 1);
+        close(go);
+        waitpid(child, &staloc, 0);
+
+        if ((fd = open("/proc/sysstat", O_RDONLY, 0)) < 0)
+            panic("strace: /proc/sysstat: error %d\n", fd);
+        drain(fd);
+        close(fd);
+        return 0;
+    }
+
+    snprintf(cmd, sizeof cmd, "pid %d", pid);
+    ctl("/proc/systrace", cmd);
+    ctl("/proc/systrace", "on");
+
+    if ((fd = open("/proc/systrace", O_RDONLY, 0)) < 0)
+        panic("strace: /proc/systrace: error %d\n", fd);
+
+    if (child) {
+        write(go, "", 1);
+        close(go);
+    }
+
+    // with -p, until killed.
+    for (;;) {
+        drain(fd);
+        if (child && waitpid(child, &staloc, WNOHANG) == child)
+            break;
+        nanosleep(&(struct timespec){ .tv_nsec = 10000000 }, NULL);
+    }
+
+    ctl("/proc/systrace", "off");
+    drain(fd);
+    close(fd);
+    return 0;
+}
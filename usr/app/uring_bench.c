@@ -0,0 +1,105 @@
+#include <ginger/unistd.h>
+#include <api.h>
+#include <sys/uring.h>
+
+/**
+ * Moves NMSG small messages through a pipe, BATCH writes then BATCH reads
+ * at a time, once with a system call per message and once with a batch
+ * per uring_enter(), with and without an SQ poller.
+ */
+
+#define NMSG        4096
+#define BATCH       32      // BATCH * MSGSZ must fit the pipe.
+#define MSGSZ       64
+
+static char msg[MSGSZ];
+static char buf[BATCH][MSGSZ];
+
+static u64 now_ns(void) {
+    struct timespec ts = {0};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ul + ts.tv_nsec;
+}
+
+static void report(const char *name, u64 ns) {
+    printf("%-16s %8lu us, %6lu ns/msg\n", name, ns / 1000, ns / NMSG);
+}
+
+static u64 bench_syscalls(int fds[2]) {
+    u64 start = now_ns();
+
+    for (int i = 0; i < NMSG; i += BATCH) {
+        for (int j = 0; j < BATCH; ++j) {
+            if (write(fds[1], msg, MSGSZ) != MSGSZ)
+                panic("write failed\n");
+        }
+        for (int j = 0; j < BATCH; ++j) {
+            if (read(fds[0], buf[j], MSGSZ) != MSGSZ)
+                panic("read failed\n");
+        }
+    }
+    return now_ns() - start;
+}
+
+// queue BATCH reads or writes, submit them at once and reap their CQEs.
+static void ring_batch(uring_t *ring, int op, int fd) {
+    int         err = 0;
+    uring_sqe_t *sqe= NULL;
+    uring_cqe_t *cqe= NULL;
+
+    for (int j = 0; j < BATCH; ++j) {
+        if ((sqe = uring_get_sqe(ring)) == NULL)
+            panic("SQ full\n");
+        uring_prep_rw(sqe, op, fd, op == URING_OP_READ ? buf[j] : msg, MSGSZ, URING_OFF_CURRENT);
+        uring_sqe_set_data(sqe, j);
+    }
+
+    if ((err = uring_submit_and_wait(ring, BATCH)) < 0)
+        panic("uring_submit_and_wait: %d\n", err);
+
+    for (int j = 0; j < BATCH; ++j) {
+        if ((err = uring_wait_cqe(ring, &cqe)))
+            panic("uring_wait_cqe: %d\n", err);
+        if (cqe->cqe_res != MSGSZ)
+            panic("op %d failed: %ld\n", op, cqe->cqe_res);
+        uring_cqe_seen(ring, cqe);
+    }
+}
+
+static u64 bench_ring(int fds[2], u32 flags) {
+    int             err     = 0;
+    u64             start   = 0;
+    uring_t         ring    = {0};
+    uring_params_t  params  = { .up_flags = flags };
+
+    if ((err = uring_init(BATCH, &ring, &params)))
+        panic("uring_init: %d\n", err);
+
+    start = now_ns();
+    for (int i = 0; i < NMSG; i += BATCH) {
+        ring_batch(&ring, URING_OP_WRITE, fds[1]);
+        ring_batch(&ring, URING_OP_READ, fds[0]);
+    }
+    start = now_ns() - start;
+
+    uring_exit(&ring);
+    return start;
+}
+
+void main(void) {
+    int fds[2];
+
+    memset(msg, 'x', sizeof msg);
+
+    if (pipe(fds))
+        panic("pipe failed\n");
+
+    printf("%d messages of %d bytes, %d per batch:\n", NMSG, MSGSZ, BATCH);
+    report("syscalls", bench_syscalls(fds));
+    report("uring", bench_ring(fds, 0));
+    report("uring+sqpoll", bench_ring(fds, URING_SETUP_SQPOLL));
+
+    close(fds[0]);
+    close(fds[1]);
+    exit(0);
+}
@@ -10,6 +10,7 @@
 #include <ginger/spinlock.h>
 #include <ginger/syscall.h>
 #include <ginger/rtc.h>
+#include <ginger/vdso.h>
 
 #include <sys/signal.h>
 #include <sys/time.h>
@@ -9,6 +9,10 @@
 #include <sys/time.h>
 #include <sys/utsname.h>
 #include <sys/mman.h>
+#include <sched.h>
+#include <sys/futex.h>
+#include <sys/uring.h>
+#include <sys/uio.h>
 
 
 extern void     sys_putc(int c);
@@ -22,6 +26,14 @@ extern int      sys_ioctl(int fd, int req, void *argp);
 extern off_t    sys_lseek(int fd, off_t off, int whence);
 extern ssize_t  sys_read(int fd, void *buf, size_t size);
 extern ssize_t  sys_write(int fd, void *buf, size_t size);
+extern ssize_t  sys_readv(int fd, const struct iovec *iov, int iovcnt);
+extern ssize_t  sys_writev(int fd, const struct iovec *iov, int iovcnt);
+extern ssize_t  sys_pread(int fd, void *buf, size_t size, off_t off);
+extern ssize_t  sys_pwrite(int fd, void *buf, size_t size, off_t off);
+extern ssize_t  sys_preadv(int fd, const struct iovec *iov, int iovcnt, off_t off);
+extern ssize_t  sys_pwritev(int fd, const struct iovec *iov, int iovcnt, off_t off);
+extern ssize_t  sys_sendfile(int out_fd, int in_fd, off_t *offset, size_t count);
+extern ssize_t  sys_splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, unsigned flags);
 extern int      sys_open(const char *pathname, int oflags, mode_t mode);
 extern int      sys_openat(int fd, const char *pathname, int oflags, mode_t mode);
 extern int      sys_create(const char *filename, mode_t mode);
@@ -79,6 +91,37 @@ extern void     sys_thread_exit(int exit_code);
 extern int      sys_thread_join(tid_t tid, void **retval);
 extern int      sys_thread_create(tid_t *ptidp, void *attr, void *(*entry)(void *arg), void *arg);
 
+/** @brief SCHEDULING */
+
+extern int      sys_sched_setscheduler(tid_t tid, int policy, const struct sched_param *param);
+extern int      sys_sched_getscheduler(tid_t tid);
+extern int      sys_sched_gettunables(struct sched_tunables *tunables);
+extern int      sys_sched_settunables(const struct sched_tunables *tunables);
+extern int      sys_sched_setaffinity(tid_t tid, size_t setsize, const cpu_set_t *mask);
+extern int      sys_sched_getaffinity(tid_t tid, size_t setsize, cpu_set_t *mask);
+
+/** @brief SYNCHRONIZATION */
+
+extern long     sys_futex(uint32_t *uaddr, int op, uint32_t val, const struct timespec *timeout, uint32_t *uaddr2, uint32_t val3);
+
+/** @brief TIMERS */
+
+extern int      sys_nanosleep(const struct timespec *req, struct timespec *rem);
+extern int      sys_clock_nanosleep(clockid_t clock_id, int flags, const struct timespec *req, struct timespec *rem);
+extern int      sys_timer_create(clockid_t clock_id, struct sigevent *restrict sevp, timer_t *restrict timerid);
+extern int      sys_timer_settime(timer_t timerid, int flags, const struct itimerspec *restrict value, struct itimerspec *restrict ovalue);
+extern int      sys_timer_gettime(timer_t timerid, struct itimerspec *value);
+extern int      sys_timer_getoverrun(timer_t timerid);
+extern int      sys_timer_delete(timer_t timerid);
+extern int      sys_clock_gettime(clockid_t clock_id, struct timespec *tp);
+extern int      sys_clock_getres(clockid_t clock_id, struct timespec *res);
+extern int      sys_clock_settime(clockid_t clock_id, const struct timespec *tp);
+
+/** @brief ASYNCHRONOUS I/O */
+
+extern int      sys_uring_setup(u32 entries, uring_params_t *params);
+extern int      sys_uring_enter(int fd, u32 to_submit, u32 min_complete, u32 flags);
+
 /** @brief SIGNALS */
 
 extern int      sys_pause(void);
@@ -13,6 +13,10 @@ int ioctl(int fd, int req, void *argp);
 off_t lseek(int fd, off_t off, int whence);
 ssize_t read(int fd, void *buf, size_t size);
 ssize_t write(int fd, void *buf, size_t size);
+ssize_t pread(int fd, void *buf, size_t size, off_t off);
+ssize_t pwrite(int fd, void *buf, size_t size, off_t off);
+ssize_t sendfile(int out_fd, int in_fd, off_t *offset, size_t count);
+ssize_t splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, unsigned flags);
 int open(const char *pathname, int oflags, mode_t mode);
 int openat(int fd, const char *pathname, int oflags, mode_t mode);
 int create(const char *filename, mode_t mode);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <types.h>
+#include <sys/time.h>
+
+/**
+ * @brief vDSO entry points, mirrors the kernel's ginger/vdso.h.
+ * The kernel maps the text page into every process, each entry
+ * returns -1 if it can't answer and the system call must be made instead.
+ */
+
+#define VDSO_DATA               0x3FFE000ul
+#define VDSO_TEXT               (VDSO_DATA + 0x1000ul)
+
+#define VDSO_ENTRY_SIZE         8
+#define VDSO_CLOCK_GETTIME      0
+#define VDSO_GETTIMEOFDAY       1
+#define VDSO_GETPID             2
+#define VDSO_GETTID             3
+
+#define VDSO_ENTRY(type, n)     ((type)(VDSO_TEXT + (n) * VDSO_ENTRY_SIZE))
+
+#define vdso_clock_gettime(clock_id, tp) \
+    VDSO_ENTRY(int (*)(clockid_t, struct timespec *), VDSO_CLOCK_GETTIME)(clock_id, tp)
+
+#define vdso_gettimeofday(tp, tzp) \
+    VDSO_ENTRY(int (*)(struct timeval *, void *), VDSO_GETTIMEOFDAY)(tp, tzp)
+
+#define vdso_getpid()   VDSO_ENTRY(pid_t (*)(void), VDSO_GETPID)()
+#define vdso_gettid()   VDSO_ENTRY(tid_t (*)(void), VDSO_GETTID)()
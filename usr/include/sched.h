@@ -0,0 +1,57 @@
+#pragma once
+
+#include <sys/types.h>
+
+// real-time priorities, a higher value is more urgent.
+#define SCHED_RT_MINPRIO    1
+#define SCHED_RT_MAXPRIO    31
+
+// scheduling policies.
+#define SCHED_RR    0   // real-time, round-robin among equal priorities.
+#define SCHED_MLFQ  1   // multi-level feedback queue(default).
+#define SCHED_FIFO  2   // real-time, runs until it blocks or yields.
+#define SCHED_FAIR  4   // fair share by virtual runtime.
+
+#define SCHED_OTHER SCHED_MLFQ
+
+struct sched_param {
+    int sched_priority; // SCHED_RT_MINPRIO..SCHED_RT_MAXPRIO for SCHED_RR/SCHED_FIFO,
+                        // 0(highest)..255(lowest) for SCHED_MLFQ, 0 for SCHED_FAIR.
+};
+
+/**
+ * SCHED_MLFQ tunables, all times are in ms.
+ * quantum(level) = mlfq_quantum + level * mlfq_quantum_step.
+ * Shorter quanta and a shorter boost interval favour latency,
+ * longer ones favour throughput.
+ */
+struct sched_tunables {
+    long    mlfq_quantum;           // quantum of the top level.
+    long    mlfq_quantum_step;      // quantum added per level down.
+    long    mlfq_boost_interval;    // period of the global priority boost, 0 disables it.
+};
+
+/**
+ * CPU affinity mask, bit 'n' selects CPU 'n'.
+ * Pinning a thread keeps it, and its cache, on the selected CPUs.
+ */
+#define CPU_SETSIZE     64
+
+typedef struct cpu_set {
+    unsigned long __bits[CPU_SETSIZE / (8 * sizeof (unsigned long))];
+} cpu_set_t;
+
+#define __CPU_WORD(c)       ((c) / (8 * sizeof (unsigned long)))
+#define __CPU_MASK(c)       (1ul << ((c) % (8 * sizeof (unsigned long))))
+
+#define CPU_ZERO(set)       ({ for (size_t __i = 0; __i < sizeof (set)->__bits / sizeof (set)->__bits[0]; ++__i) (set)->__bits[__i] = 0; })
+#define CPU_SET(c, set)     ({ if ((size_t)(c) < CPU_SETSIZE) (set)->__bits[__CPU_WORD(c)] |= __CPU_MASK(c); })
+#define CPU_CLR(c, set)     ({ if ((size_t)(c) < CPU_SETSIZE) (set)->__bits[__CPU_WORD(c)] &= ~__CPU_MASK(c); })
+#define CPU_ISSET(c, set)   ((size_t)(c) < CPU_SETSIZE && ((set)->__bits[__CPU_WORD(c)] & __CPU_MASK(c)) != 0)
+
+int sched_gettunables(struct sched_tunables *tunables);
+int sched_settunables(const struct sched_tunables *tunables);
+int sched_setscheduler(tid_t tid, int policy, const struct sched_param *param);
+int sched_getscheduler(tid_t tid);
+int sched_setaffinity(tid_t tid, size_t setsize, const cpu_set_t *mask);
+int sched_getaffinity(tid_t tid, size_t setsize, cpu_set_t *mask);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdint.h>
+#include <sys/time.h>
+
+#define FUTEX_WAIT              0   // sleep if *uaddr == val.
+#define FUTEX_WAKE              1   // wake up to val waiters on uaddr.
+#define FUTEX_REQUEUE           3   // wake up to val waiters, move up to val2 others to uaddr2.
+#define FUTEX_WAIT_BITSET       9   // FUTEX_WAIT, only woken by wakes whose bitset intersects val3.
+#define FUTEX_WAKE_BITSET       10  // FUTEX_WAKE, only waking waiters whose bitset intersects val3.
+
+// the futex word is not shared with other processes.
+#define FUTEX_PRIVATE_FLAG      128
+
+#define FUTEX_WAIT_PRIVATE      (FUTEX_WAIT | FUTEX_PRIVATE_FLAG)
+#define FUTEX_WAKE_PRIVATE      (FUTEX_WAKE | FUTEX_PRIVATE_FLAG)
+
+#define FUTEX_BITSET_MATCH_ANY  0xffffffff
+
+/**
+ * @brief block on or wake waiters of a 32-bit word.
+ * 'timeout' is relative and only used by waits, FUTEX_REQUEUE passes
+ * the number of waiters to move in its place.
+ * @return long number of waiters woken(plus requeued), 0 for waits,
+ * or a negated errno: -EAGAIN if *uaddr != val, -ETIMEDOUT, -EINTR.
+ */
+long futex(uint32_t *uaddr, int op, uint32_t val, const struct timespec *timeout, uint32_t *uaddr2, uint32_t val3);
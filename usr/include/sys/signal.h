@@ -203,6 +203,15 @@ typedef struct {
     union sigval si_value; /* Signal value */
 } siginfo_t;
 
+#define SIGEV_NONE      0   // nothing is delivered on expiry.
+#define SIGEV_SIGNAL    1   // sigev_signo is sent to the process.
+
+struct sigevent {
+    int             sigev_notify;   /* Notification type */
+    int             sigev_signo;    /* Signal number */
+    union sigval    sigev_value;    /* Signal value */
+};
+
 typedef struct {
     void        (*sa_handler)(int); /* addr of signal handler, */
                                     /* or SIG_IGN, or SIG_DFL */
@@ -21,6 +21,19 @@ struct tm {
     int tm_isdst;
 };
 
+struct itimerspec {
+    struct timespec it_interval;    // period of the timer, 0 for one-shot timers.
+    struct timespec it_value;       // time until the next expiry, 0 if disarmed.
+};
+
+#define CLOCK_REALTIME  0
+#define CLOCK_MONOTONIC 1
+#define CLOCK_PROCESS_CPUTIME_ID 2   // CPU time used by all threads of the process.
+#define CLOCK_THREAD_CPUTIME_ID  3   // CPU time used by the calling thread.
+
+// the time passed to clock_nanosleep() or timer_settime() is absolute.
+#define TIMER_ABSTIME   1
+
 typedef struct timeval {
     time_t          tv_sec;  // Seconds.
     susseconds_t    tv_usec; // Microseconds.
@@ -46,4 +59,14 @@ time_t mktime(struct tm *timeptr);
 
 int clock_getres(clockid_t clock_id, struct timespec *res);
 int clock_gettime(clockid_t clock_id, struct timespec *tp);
-int clock_settime(clockid_t clock_id, const struct timespec *tp);
\ No newline at end of file
+int clock_settime(clockid_t clock_id, const struct timespec *tp);
+
+int nanosleep(const struct timespec *req, struct timespec *rem);
+int clock_nanosleep(clockid_t clock_id, int flags, const struct timespec *req, struct timespec *rem);
+
+struct sigevent;
+int timer_create(clockid_t clock_id, struct sigevent *restrict sevp, timer_t *restrict timerid);
+int timer_settime(timer_t timerid, int flags, const struct itimerspec *restrict value, struct itimerspec *restrict ovalue);
+int timer_gettime(timer_t timerid, struct itimerspec *value);
+int timer_getoverrun(timer_t timerid);
+int timer_delete(timer_t timerid);
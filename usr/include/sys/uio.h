@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stddef.h>
+#include <types.h>
+
+#define IOV_MAX 1024    // most buffers one readv()/writev() takes.
+
+struct iovec {                    /* Scatter/gather array items */
+	void  *iov_base;              /* Starting address */
+	size_t iov_len;               /* Number of bytes to transfer */
+};
+
+ssize_t readv(int fd, const struct iovec *iov, int iovcnt);
+ssize_t writev(int fd, const struct iovec *iov, int iovcnt);
+ssize_t preadv(int fd, const struct iovec *iov, int iovcnt, off_t off);
+ssize_t pwritev(int fd, const struct iovec *iov, int iovcnt, off_t off);
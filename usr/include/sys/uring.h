@@ -0,0 +1,160 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <types.h>
+#include <sys/system.h>
+#include <sys/time.h>
+
+/**
+ * @brief Submission/completion rings, mirrors the kernel's sys/uring.h.
+ * Queue operations as SQEs in a ring shared with the kernel, submit a batch
+ * of them with one uring_enter() and collect their results as CQEs, posted
+ * by kernel worker threads as the operations complete.
+ */
+
+#define URING_ENTRIES_MAX       4096
+#define URING_WORKERS_MAX       8
+
+// uring_params_t.up_flags.
+#define URING_SETUP_SQPOLL      BS(0)   // a kernel thread polls the SQ.
+
+// uring_enter() flags.
+#define URING_ENTER_GETEVENTS   BS(0)   // wait for 'min_complete' CQEs.
+#define URING_ENTER_SQ_WAKEUP   BS(1)   // wake the SQ poller.
+
+// sq.uq_flags.
+#define URING_SQ_NEED_WAKEUP    BS(0)   // the SQ poller sleeps, see URING_ENTER_SQ_WAKEUP.
+
+// uring_sqe_t.sqe_op.
+#define URING_OP_NOP            0
+#define URING_OP_READ           1   // read(fd, addr, len), or pread() at off.
+#define URING_OP_WRITE          2   // write(fd, addr, len), or pwrite() at off.
+#define URING_OP_FSYNC          3   // sync(fd).
+#define URING_OP_OPENAT         4   // openat(fd, addr, flags, len).
+#define URING_OP_CLOSE          5   // close(fd).
+#define URING_OP_POLL           6   // wait for URING_POLL* 'flags' on fd.
+#define URING_OP_TIMEOUT        7   // sleep for the struct timespec at addr, completes with -ETIME.
+
+// read and write at and past the file offset.
+#define URING_OFF_CURRENT       ((u64)-1)
+
+// URING_OP_POLL events.
+#define URING_POLLIN            0x001
+#define URING_POLLOUT           0x004
+#define URING_POLLERR           0x008
+#define URING_POLLHUP           0x010
+
+typedef struct uring_sqe {
+    u8      sqe_op;
+    u8      sqe_rsvd[3];
+    i32     sqe_fd;
+    u64     sqe_off;
+    u64     sqe_addr;
+    u32     sqe_len;
+    u32     sqe_flags;
+    u64     sqe_user_data;
+} uring_sqe_t;
+
+typedef struct uring_cqe {
+    u64     cqe_user_data;
+    i64     cqe_res;        // what the call returned, negated errno on failure.
+} uring_cqe_t;
+
+typedef struct uring_queue {
+    u32     uq_head;
+    u32     uq_tail;
+    u32     uq_mask;
+    u32     uq_entries;
+    u32     uq_flags;
+    u32     uq_dropped;     // CQEs lost to a full CQ.
+} __aligned(64) uring_queue_t;
+
+typedef struct uring_params {
+    u32     up_entries;     // out: SQ entries, the CQ has twice as many.
+    u32     up_flags;       // URING_SETUP_*.
+    u32     up_workers;     // worker threads, 0 for the default.
+    u32     up_sq_idle;     // SQ poller idle time in ms, 0 for the default.
+    u64     up_size;        // out: bytes to mmap() at offset 0.
+} uring_params_t;
+
+#define URING_SQ_OFF            0
+#define URING_CQ_OFF            (sizeof (uring_queue_t))
+#define URING_SQES_OFF          (2 * sizeof (uring_queue_t))
+#define URING_CQES_OFF(n)       (URING_SQES_OFF + (n) * sizeof (uring_sqe_t))
+
+int uring_setup(u32 entries, uring_params_t *params);
+int uring_enter(int fd, u32 to_submit, u32 min_complete, u32 flags);
+
+// a mapped ring.
+typedef struct uring {
+    int             u_fd;
+    u32             u_flags;    // URING_SETUP_*.
+    void            *u_mem;
+    size_t          u_size;
+    uring_queue_t   *u_sq;
+    uring_queue_t   *u_cq;
+    uring_sqe_t     *u_sqes;
+    uring_cqe_t     *u_cqes;
+    u32             u_sqtail;   // SQEs handed out by uring_get_sqe(), published by uring_submit().
+} uring_t;
+
+/**
+ * @brief set up and map a ring of 'entries' SQEs.
+ * @param params NULL for the defaults.
+ * @return int 0 on success, or a negated errno.
+ */
+int uring_init(u32 entries, uring_t *ring, uring_params_t *params);
+void uring_exit(uring_t *ring);
+
+/**
+ * @brief next free SQE, zeroed, NULL if the SQ is full.
+ */
+uring_sqe_t *uring_get_sqe(uring_t *ring);
+
+/**
+ * @brief submit the SQEs gotten so far and wait for 'wait_nr' CQEs.
+ * @return int number of SQEs submitted, or a negated errno.
+ */
+int uring_submit_and_wait(uring_t *ring, u32 wait_nr);
+#define uring_submit(ring)      uring_submit_and_wait((ring), 0)
+
+/**
+ * @brief next CQE, without(peek) or after waiting for one.
+ * @return int 0 with *'cqe' set, -EAGAIN(peek) or a negated errno.
+ */
+int uring_peek_cqe(uring_t *ring, uring_cqe_t **cqe);
+int uring_wait_cqe(uring_t *ring, uring_cqe_t **cqe);
+
+// done with the 'n' oldest CQEs.
+void uring_cq_advance(uring_t *ring, u32 n);
+#define uring_cqe_seen(ring, cqe)   uring_cq_advance((ring), 1)
+
+static inline void uring_prep_rw(uring_sqe_t *sqe, int op, int fd, const void *addr, u32 len, u64 off) {
+    sqe->sqe_op     = op;
+    sqe->sqe_fd     = fd;
+    sqe->sqe_addr   = (u64)addr;
+    sqe->sqe_len    = len;
+    sqe->sqe_off    = off;
+}
+
+#define uring_prep_nop(sqe)                 uring_prep_rw((sqe), URING_OP_NOP, -1, NULL, 0, 0)
+#define uring_prep_read(sqe, fd, buf, n)    uring_prep_rw((sqe), URING_OP_READ, (fd), (buf), (n), URING_OFF_CURRENT)
+#define uring_prep_write(sqe, fd, buf, n)   uring_prep_rw((sqe), URING_OP_WRITE, (fd), (buf), (n), URING_OFF_CURRENT)
+#define uring_prep_pread(sqe, fd, buf, n, off)  uring_prep_rw((sqe), URING_OP_READ, (fd), (buf), (n), (off))
+#define uring_prep_pwrite(sqe, fd, buf, n, off) uring_prep_rw((sqe), URING_OP_WRITE, (fd), (buf), (n), (off))
+#define uring_prep_fsync(sqe, fd)           uring_prep_rw((sqe), URING_OP_FSYNC, (fd), NULL, 0, 0)
+#define uring_prep_close(sqe, fd)           uring_prep_rw((sqe), URING_OP_CLOSE, (fd), NULL, 0, 0)
+#define uring_prep_timeout(sqe, ts)         uring_prep_rw((sqe), URING_OP_TIMEOUT, -1, (ts), 0, 0)
+
+#define uring_prep_openat(sqe, dfd, path, oflags, mode) ({          \
+    uring_prep_rw((sqe), URING_OP_OPENAT, (dfd), (path), (mode), 0);\
+    (sqe)->sqe_flags = (oflags);                                    \
+})
+
+#define uring_prep_poll(sqe, fd, events) ({                         \
+    uring_prep_rw((sqe), URING_OP_POLL, (fd), NULL, 0, 0);          \
+    (sqe)->sqe_flags = (events);                                    \
+})
+
+#define uring_sqe_set_data(sqe, data)       ({ (sqe)->sqe_user_data = (u64)(data); })
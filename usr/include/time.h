@@ -47,8 +47,11 @@ typedef int clockid_t;
 
 #define CLOCK_REALTIME  0
 #define CLOCK_MONOTONIC 1
+#define CLOCK_PROCESS_CPUTIME_ID 2
+#define CLOCK_THREAD_CPUTIME_ID  3
 
 extern int clock_gettime(clockid_t clk_id, struct timespec *tp);
 extern int clock_getres(clockid_t clk_id, struct timespec *res);
+extern int clock_settime(clockid_t clk_id, const struct timespec *tp);
 
 _End_C_Header
@@ -44,6 +44,38 @@ ssize_t write(int fd, void *buf, size_t size) {
     return sys_write(fd, buf, size);
 }
 
+ssize_t readv(int fd, const struct iovec *iov, int iovcnt) {
+    return sys_readv(fd, iov, iovcnt);
+}
+
+ssize_t writev(int fd, const struct iovec *iov, int iovcnt) {
+    return sys_writev(fd, iov, iovcnt);
+}
+
+ssize_t pread(int fd, void *buf, size_t size, off_t off) {
+    return sys_pread(fd, buf, size, off);
+}
+
+ssize_t pwrite(int fd, void *buf, size_t size, off_t off) {
+    return sys_pwrite(fd, buf, size, off);
+}
+
+ssize_t preadv(int fd, const struct iovec *iov, int iovcnt, off_t off) {
+    return sys_preadv(fd, iov, iovcnt, off);
+}
+
+ssize_t pwritev(int fd, const struct iovec *iov, int iovcnt, off_t off) {
+    return sys_pwritev(fd, iov, iovcnt, off);
+}
+
+ssize_t sendfile(int out_fd, int in_fd, off_t *offset, size_t count) {
+    return sys_sendfile(out_fd, in_fd, offset, count);
+}
+
+ssize_t splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, unsigned flags) {
+    return sys_splice(fd_in, off_in, fd_out, off_out, len, flags);
+}
+
 int open(const char *pathname, int oflags, mode_t mode) {
     return sys_open(pathname, oflags, mode);
 }
@@ -134,6 +166,8 @@ int fchown(int fd, uid_t uid, gid_t gid) {
 }
 
 int gettimeofday(struct timeval *restrict tp, void *restrict tzp) {
+    if (vdso_gettimeofday(tp, tzp) == 0)
+        return 0;
     return sys_gettimeofday(tp, tzp);
 }
 
@@ -203,7 +237,8 @@ void exit(int exit_code) {
 }
 
 pid_t getpid(void) {
-    return sys_getpid();
+    pid_t pid = vdso_getpid();
+    return pid >= 0 ? pid : sys_getpid();
 }
 
 pid_t getppid(void) {
@@ -219,8 +254,14 @@ long sleep(long seconds) {
     return sys_sleep(seconds);
 }
 
+int usleep(useconds_t usec) {
+    struct timespec req = { .tv_sec = usec / 1000000, .tv_nsec = (usec % 1000000) * 1000 };
+    return sys_nanosleep(&req, NULL);
+}
+
 tid_t gettid(void) {
-    return sys_gettid();
+    tid_t tid = vdso_gettid();
+    return tid >= 0 ? tid : sys_gettid();
 }
 
 void thread_exit(int exit_code) {
@@ -243,6 +284,92 @@ void thread_yield(void) {
     sys_thread_yield();
 }
 
+/** @brief SCHEDULING */
+
+int sched_setscheduler(tid_t tid, int policy, const struct sched_param *param) {
+    return sys_sched_setscheduler(tid, policy, param);
+}
+
+int sched_getscheduler(tid_t tid) {
+    return sys_sched_getscheduler(tid);
+}
+
+int sched_gettunables(struct sched_tunables *tunables) {
+    return sys_sched_gettunables(tunables);
+}
+
+int sched_settunables(const struct sched_tunables *tunables) {
+    return sys_sched_settunables(tunables);
+}
+
+int sched_setaffinity(tid_t tid, size_t setsize, const cpu_set_t *mask) {
+    return sys_sched_setaffinity(tid, setsize, mask);
+}
+
+int sched_getaffinity(tid_t tid, size_t setsize, cpu_set_t *mask) {
+    return sys_sched_getaffinity(tid, setsize, mask);
+}
+
+/** @brief SYNCHRONIZATION */
+
+long futex(uint32_t *uaddr, int op, uint32_t val, const struct timespec *timeout, uint32_t *uaddr2, uint32_t val3) {
+    return sys_futex(uaddr, op, val, timeout, uaddr2, val3);
+}
+
+/** @brief TIMERS */
+
+int nanosleep(const struct timespec *req, struct timespec *rem) {
+    return sys_nanosleep(req, rem);
+}
+
+int clock_nanosleep(clockid_t clock_id, int flags, const struct timespec *req, struct timespec *rem) {
+    return sys_clock_nanosleep(clock_id, flags, req, rem);
+}
+
+int timer_create(clockid_t clock_id, struct sigevent *restrict sevp, timer_t *restrict timerid) {
+    return sys_timer_create(clock_id, sevp, timerid);
+}
+
+int timer_settime(timer_t timerid, int flags, const struct itimerspec *restrict value, struct itimerspec *restrict ovalue) {
+    return sys_timer_settime(timerid, flags, value, ovalue);
+}
+
+int timer_gettime(timer_t timerid, struct itimerspec *value) {
+    return sys_timer_gettime(timerid, value);
+}
+
+int timer_getoverrun(timer_t timerid) {
+    return sys_timer_getoverrun(timerid);
+}
+
+int timer_delete(timer_t timerid) {
+    return sys_timer_delete(timerid);
+}
+
+int clock_gettime(clockid_t clock_id, struct timespec *tp) {
+    if (vdso_clock_gettime(clock_id, tp) == 0)
+        return 0;
+    return sys_clock_gettime(clock_id, tp);
+}
+
+int clock_getres(clockid_t clock_id, struct timespec *res) {
+    return sys_clock_getres(clock_id, res);
+}
+
+int clock_settime(clockid_t clock_id, const struct timespec *tp) {
+    return sys_clock_settime(clock_id, tp);
+}
+
+/** @brief ASYNCHRONOUS I/O */
+
+int uring_setup(u32 entries, uring_params_t *params) {
+    return sys_uring_setup(entries, params);
+}
+
+int uring_enter(int fd, u32 to_submit, u32 min_complete, u32 flags) {
+    return sys_uring_enter(fd, to_submit, min_complete, flags);
+}
+
 /** @brief SIGNALS */
 
 int pause(void) {
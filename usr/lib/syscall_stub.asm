@@ -2,11 +2,13 @@ bits 64
 
 section .text
 
+; SYSCALL returns to rcx, so the 4th argument goes in r10.
 %macro stub 2
 global sys_%2
 sys_%2:
+    mov r10, rcx
     mov rax, %1
-    int 0x80
+    syscall
     ret
 %endmacro
 
@@ -105,6 +107,38 @@ sys_%2:
 %define SYS_MKDIR           80
 %define SYS_MKNOD           81
 
+%define SYS_SCHED_SETSCHEDULER  82
+%define SYS_SCHED_GETSCHEDULER  83
+%define SYS_SCHED_GETTUNABLES   84
+%define SYS_SCHED_SETTUNABLES   85
+%define SYS_SCHED_SETAFFINITY   86
+%define SYS_SCHED_GETAFFINITY   87
+
+%define SYS_FUTEX               88
+
+%define SYS_NANOSLEEP           89
+%define SYS_CLOCK_NANOSLEEP     90
+%define SYS_TIMER_CREATE        91
+%define SYS_TIMER_SETTIME       92
+%define SYS_TIMER_GETTIME       93
+%define SYS_TIMER_GETOVERRUN    94
+%define SYS_TIMER_DELETE        95
+%define SYS_CLOCK_GETTIME       96
+%define SYS_CLOCK_GETRES        97
+%define SYS_CLOCK_SETTIME       98
+
+%define SYS_URING_SETUP         99
+%define SYS_URING_ENTER         100
+
+%define SYS_READV               101
+%define SYS_WRITEV              102
+%define SYS_PREAD               103
+%define SYS_PWRITE              104
+%define SYS_PREADV              105
+%define SYS_PWRITEV             106
+%define SYS_SENDFILE            107
+%define SYS_SPLICE              108
+
 stub SYS_PUTC, putc
 stub SYS_CLOSE, close
 stub SYS_UNLINK, unlink
@@ -162,6 +196,38 @@ stub SYS_THREAD_JOIN, thread_join
 stub SYS_THREAD_SELF, thread_self
 stub SYS_THREAD_YIELD, thread_yield
 
+stub SYS_SCHED_SETSCHEDULER, sched_setscheduler
+stub SYS_SCHED_GETSCHEDULER, sched_getscheduler
+stub SYS_SCHED_GETTUNABLES, sched_gettunables
+stub SYS_SCHED_SETTUNABLES, sched_settunables
+stub SYS_SCHED_SETAFFINITY, sched_setaffinity
+stub SYS_SCHED_GETAFFINITY, sched_getaffinity
+
+stub SYS_FUTEX, futex
+
+stub SYS_NANOSLEEP, nanosleep
+stub SYS_CLOCK_NANOSLEEP, clock_nanosleep
+stub SYS_TIMER_CREATE, timer_create
+stub SYS_TIMER_SETTIME, timer_settime
+stub SYS_TIMER_GETTIME, timer_gettime
+stub SYS_TIMER_GETOVERRUN, timer_getoverrun
+stub SYS_TIMER_DELETE, timer_delete
+stub SYS_CLOCK_GETTIME, clock_gettime
+stub SYS_CLOCK_GETRES, clock_getres
+stub SYS_CLOCK_SETTIME, clock_settime
+
+stub SYS_URING_SETUP, uring_setup
+stub SYS_URING_ENTER, uring_enter
+
+stub SYS_READV, readv
+stub SYS_WRITEV, writev
+stub SYS_PREAD, pread
+stub SYS_PWRITE, pwrite
+stub SYS_PREADV, preadv
+stub SYS_PWRITEV, pwritev
+stub SYS_SENDFILE, sendfile
+stub SYS_SPLICE, splice
+
 stub SYS_PAUSE, pause
 stub SYS_RAISE, raise
 stub SYS_KILL, kill
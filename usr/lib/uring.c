@@ -0,0 +1,105 @@
+#include <api.h>
+#include <ginger/unistd.h>
+#include <sys/mman.h>
+#include <sys/uring.h>
+
+int uring_init(u32 entries, uring_t *ring, uring_params_t *params) {
+    int             fd  = 0;
+    void            *mem= NULL;
+    uring_params_t  p   = {0};
+
+    if (ring == NULL)
+        return -EINVAL;
+
+    if (params)
+        p = *params;
+
+    if ((fd = uring_setup(entries, &p)) < 0)
+        return fd;
+
+    mem = mmap(NULL, p.up_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if ((long)mem < 0 && (long)mem > -4096) {
+        close(fd);
+        return (long)mem;
+    }
+
+    memset(ring, 0, sizeof *ring);
+    ring->u_fd      = fd;
+    ring->u_flags   = p.up_flags;
+    ring->u_mem     = mem;
+    ring->u_size    = p.up_size;
+    ring->u_sq      = (uring_queue_t *)(mem + URING_SQ_OFF);
+    ring->u_cq      = (uring_queue_t *)(mem + URING_CQ_OFF);
+    ring->u_sqes    = (uring_sqe_t *)(mem + URING_SQES_OFF);
+    ring->u_cqes    = (uring_cqe_t *)(mem + URING_CQES_OFF(p.up_entries));
+    ring->u_sqtail  = ring->u_sq->uq_tail;
+
+    if (params)
+        *params = p;
+    return 0;
+}
+
+void uring_exit(uring_t *ring) {
+    munmap(ring->u_mem, ring->u_size);
+    close(ring->u_fd);
+}
+
+uring_sqe_t *uring_get_sqe(uring_t *ring) {
+    uring_sqe_t *sqe = NULL;
+
+    if (ring->u_sqtail - atomic_read(&ring->u_sq->uq_head) >= ring->u_sq->uq_entries)
+        return NULL;
+
+    sqe = &ring->u_sqes[ring->u_sqtail++ & ring->u_sq->uq_mask];
+    memset(sqe, 0, sizeof *sqe);
+    return sqe;
+}
+
+int uring_submit_and_wait(uring_t *ring, u32 wait_nr) {
+    int err     = 0;
+    u32 flags   = wait_nr ? URING_ENTER_GETEVENTS : 0;
+    u32 count   = ring->u_sqtail - atomic_read(&ring->u_sq->uq_tail);
+
+    // the SQEs are filled in before the kernel can see the tail move.
+    atomic_write(&ring->u_sq->uq_tail, ring->u_sqtail);
+
+    if (ring->u_flags & URING_SETUP_SQPOLL) {
+        // the poller tests the tail after setting the flag, see the kernel's uring_sqpoll().
+        if (atomic_read(&ring->u_sq->uq_flags) & URING_SQ_NEED_WAKEUP)
+            flags |= URING_ENTER_SQ_WAKEUP;
+        if (flags && (err = uring_enter(ring->u_fd, 0, wait_nr, flags)) < 0)
+            return err;
+        return count;
+    }
+
+    // also resubmit what the kernel left behind, e.g. with too many in flight.
+    count = ring->u_sqtail - atomic_read(&ring->u_sq->uq_head);
+    if (count == 0 && flags == 0)
+        return 0;
+    return uring_enter(ring->u_fd, count, wait_nr, flags);
+}
+
+int uring_peek_cqe(uring_t *ring, uring_cqe_t **cqe) {
+    u32 head = ring->u_cq->uq_head;
+
+    if (head == atomic_read(&ring->u_cq->uq_tail))
+        return -EAGAIN;
+
+    *cqe = &ring->u_cqes[head & ring->u_cq->uq_mask];
+    return 0;
+}
+
+int uring_wait_cqe(uring_t *ring, uring_cqe_t **cqe) {
+    int err = 0;
+
+    while ((err = uring_peek_cqe(ring, cqe)) == -EAGAIN) {
+        if ((err = uring_enter(ring->u_fd, 0, 1, URING_ENTER_GETEVENTS)) < 0)
+            return err;
+    }
+    return err;
+}
+
+void uring_cq_advance(uring_t *ring, u32 n) {
+    // the kernel may reuse the CQEs once it sees the head move.
+    atomic_write(&ring->u_cq->uq_head, ring->u_cq->uq_head + n);
+}